@@ -0,0 +1,882 @@
+#include "bvh.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include "math3dmorton.h"
+#include "math3dsort.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace math3d;
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 arrays are treated as tightly packed floats");
+
+static const uint_t BVH_BIN_COUNT = 16;
+static const uint_t BVH_STACK_SIZE = 256;
+/* Nodes at this depth become leaves whatever their size, traversal never holds more than depth + 1 entries */
+static const uint_t BVH_MAX_DEPTH = BVH_STACK_SIZE - 2;
+static const uint_t BVH_PARALLEL_THRESHOLD = 4096;
+static const uint_t BVH_QUERY_GRAIN = 256;
+static const float BVH_EPSILON = 1e-7f;
+
+namespace
+{
+	struct BVHBuildContext
+	{
+		BVHNode* nodes;
+		uint_t* indices;
+		const float* centroids;
+		const float* bounds;
+		std::atomic<uint_t> nodesUsed;
+		uint_t maxLeafSize;
+		uint_t spawnDepth;
+	};
+
+	struct LinearBuildContext
+	{
+		BVHNode* nodes;
+		const uint_t* indices;
+		const uintc_t* codes;
+		const float* bounds;
+		std::atomic<uint_t> nodesUsed;
+		uint_t maxLeafSize;
+		uint_t spawnDepth;
+	};
+
+	struct BVHBin
+	{
+		float boundsMin[3];
+		float boundsMax[3];
+		uint_t count;
+	};
+}
+
+static inline void ResetBounds(float* boundsMin, float* boundsMax)
+{
+	for (uint_t i = 0; i < 3; i++)
+	{
+		boundsMin[i] = FLT_MAX;
+		boundsMax[i] = -FLT_MAX;
+	}
+}
+
+static inline void GrowBounds(float* boundsMin, float* boundsMax, const float* otherMin, const float* otherMax)
+{
+	for (uint_t i = 0; i < 3; i++)
+	{
+		boundsMin[i] = Min(boundsMin[i], otherMin[i]);
+		boundsMax[i] = Max(boundsMax[i], otherMax[i]);
+	}
+}
+
+static inline float HalfArea(const float* boundsMin, const float* boundsMax)
+{
+	float dx = boundsMax[0] - boundsMin[0];
+	float dy = boundsMax[1] - boundsMin[1];
+	float dz = boundsMax[2] - boundsMin[2];
+
+	return dx < 0.0f ? 0.0f : dx * dy + dy * dz + dz * dx;
+}
+
+static void SubdivideNode(BVHBuildContext& context, uint_t nodeIndex, uint_t depth)
+{
+	BVHNode& node = context.nodes[nodeIndex];
+
+	uint_t first = node.leftFirst;
+	uint_t count = node.count;
+
+	ResetBounds(node.boundsMin, node.boundsMax);
+
+	float centroidMin[3];
+	float centroidMax[3];
+	ResetBounds(centroidMin, centroidMax);
+
+	for (uint_t i = first; i < first + count; i++)
+	{
+		uint_t triangle = context.indices[i];
+		const float* c = context.centroids + triangle * 3;
+
+		GrowBounds(node.boundsMin, node.boundsMax, context.bounds + triangle * 6, context.bounds + triangle * 6 + 3);
+		GrowBounds(centroidMin, centroidMax, c, c);
+	}
+
+	if (count <= 1 || depth >= BVH_MAX_DEPTH)
+	{
+		return;
+	}
+
+	// Binned SAH, evaluate BVH_BIN_COUNT - 1 candidate planes per axis
+	int bestAxis = -1;
+	uint_t bestSplit = 0;
+	float bestCost = FLT_MAX;
+
+	for (uint_t axis = 0; axis < 3; axis++)
+	{
+		float extent = centroidMax[axis] - centroidMin[axis];
+
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		BVHBin bins[BVH_BIN_COUNT];
+		for (uint_t b = 0; b < BVH_BIN_COUNT; b++)
+		{
+			ResetBounds(bins[b].boundsMin, bins[b].boundsMax);
+			bins[b].count = 0;
+		}
+
+		float scale = (float)BVH_BIN_COUNT / extent;
+
+		for (uint_t i = first; i < first + count; i++)
+		{
+			uint_t triangle = context.indices[i];
+			uint_t b = (uint_t)((context.centroids[triangle * 3 + axis] - centroidMin[axis]) * scale);
+			b = b < BVH_BIN_COUNT - 1 ? b : BVH_BIN_COUNT - 1;
+
+			bins[b].count++;
+			GrowBounds(bins[b].boundsMin, bins[b].boundsMax, context.bounds + triangle * 6, context.bounds + triangle * 6 + 3);
+		}
+
+		float leftArea[BVH_BIN_COUNT - 1];
+		uint_t leftCount[BVH_BIN_COUNT - 1];
+		float sweepMin[3];
+		float sweepMax[3];
+		uint_t sweepCount = 0;
+
+		ResetBounds(sweepMin, sweepMax);
+		for (uint_t b = 0; b < BVH_BIN_COUNT - 1; b++)
+		{
+			sweepCount += bins[b].count;
+			GrowBounds(sweepMin, sweepMax, bins[b].boundsMin, bins[b].boundsMax);
+			leftCount[b] = sweepCount;
+			leftArea[b] = HalfArea(sweepMin, sweepMax);
+		}
+
+		sweepCount = 0;
+		ResetBounds(sweepMin, sweepMax);
+		for (uint_t b = BVH_BIN_COUNT - 1; b > 0; b--)
+		{
+			sweepCount += bins[b].count;
+			GrowBounds(sweepMin, sweepMax, bins[b].boundsMin, bins[b].boundsMax);
+
+			float cost = leftCount[b - 1] * leftArea[b - 1] + sweepCount * HalfArea(sweepMin, sweepMax);
+			if (leftCount[b - 1] != 0 && sweepCount != 0 && cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = (int)axis;
+				bestSplit = b;
+			}
+		}
+	}
+
+	float leafCost = count * HalfArea(node.boundsMin, node.boundsMax);
+	uint_t leftCount = 0;
+
+	// When all centroids coincide leftCount stays 0 and the range is only halved to honor the leaf size
+	if (bestAxis >= 0)
+	{
+		if (bestCost >= leafCost && count <= context.maxLeafSize)
+		{
+			return;
+		}
+
+		float scale = (float)BVH_BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+		float splitMin = centroidMin[bestAxis];
+		const float* centroids = context.centroids;
+
+		uint_t* middle = std::partition(context.indices + first, context.indices + first + count, [=](uint_t triangle)
+		{
+			uint_t b = (uint_t)((centroids[triangle * 3 + bestAxis] - splitMin) * scale);
+			b = b < BVH_BIN_COUNT - 1 ? b : BVH_BIN_COUNT - 1;
+
+			return b < bestSplit;
+		});
+
+		leftCount = (uint_t)(middle - (context.indices + first));
+	}
+
+	if (leftCount == 0 || leftCount == count)
+	{
+		if (count <= context.maxLeafSize)
+		{
+			return;
+		}
+
+		leftCount = count / 2;
+	}
+
+	uint_t leftIndex = context.nodesUsed.fetch_add(2);
+
+	BVHNode& left = context.nodes[leftIndex];
+	BVHNode& right = context.nodes[leftIndex + 1];
+
+	left.leftFirst = first;
+	left.count = leftCount;
+	right.leftFirst = first + leftCount;
+	right.count = count - leftCount;
+
+	node.leftFirst = leftIndex;
+	node.count = 0;
+
+	if (depth < context.spawnDepth && count > BVH_PARALLEL_THRESHOLD)
+	{
+		std::thread leftThread(SubdivideNode, std::ref(context), leftIndex, depth + 1);
+		SubdivideNode(context, leftIndex + 1, depth + 1);
+		leftThread.join();
+	}
+	else
+	{
+		SubdivideNode(context, leftIndex, depth + 1);
+		SubdivideNode(context, leftIndex + 1, depth + 1);
+	}
+}
+
+//
+// Slab test with the planes picked by the inverse direction sign. NaN from an origin on a plane
+// with a zero direction component fails every comparison, so it leaves the interval unchanged.
+//
+static inline float IntersectNode(const BVHNode& node, const float* origin, const float* inverseDirection, float maxDistance)
+{
+	float tNear = 0.0f;
+	float tFar = maxDistance;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		bool negative = inverseDirection[i] < 0.0f;
+		float t0 = ((negative ? node.boundsMax[i] : node.boundsMin[i]) - origin[i]) * inverseDirection[i];
+		float t1 = ((negative ? node.boundsMin[i] : node.boundsMax[i]) - origin[i]) * inverseDirection[i];
+
+		tNear = t0 > tNear ? t0 : tNear;
+		tFar = t1 < tFar ? t1 : tFar;
+	}
+
+	return tNear <= tFar ? tNear : FLT_MAX;
+}
+
+static inline bool IntersectTriangle(const float* vertices, const float* origin, const float* direction, float& t, float& u, float& v)
+{
+	const float* v0 = vertices;
+	const float* v1 = vertices + 3;
+	const float* v2 = vertices + 6;
+
+	float e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+	float e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+	float p[3] = { direction[1] * e2[2] - direction[2] * e2[1], direction[2] * e2[0] - direction[0] * e2[2], direction[0] * e2[1] - direction[1] * e2[0] };
+	float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+
+	if (Abs(det) < BVH_EPSILON)
+	{
+		return false;
+	}
+
+	float invDet = 1.0f / det;
+	float s[3] = { origin[0] - v0[0], origin[1] - v0[1], origin[2] - v0[2] };
+
+	u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+
+	v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+
+	return t > BVH_EPSILON;
+}
+
+static inline float Dot3(const float* a, const float* b)
+{
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/* Closest point on triangle by Voronoi region classification (Ericson, RTCD 5.1.5) */
+static void ClosestPointOnTriangle(const float* vertices, const float* p, float* closest)
+{
+	const float* a = vertices;
+	const float* b = vertices + 3;
+	const float* c = vertices + 6;
+
+	float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+
+	float d1 = Dot3(ab, ap);
+	float d2 = Dot3(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+		closest[0] = a[0]; closest[1] = a[1]; closest[2] = a[2];
+		return;
+	}
+
+	float bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+	float d3 = Dot3(ab, bp);
+	float d4 = Dot3(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		closest[0] = b[0]; closest[1] = b[1]; closest[2] = b[2];
+		return;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		float w = d1 / (d1 - d3);
+		for (uint_t i = 0; i < 3; i++)
+		{
+			closest[i] = a[i] + w * ab[i];
+		}
+		return;
+	}
+
+	float cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+	float d5 = Dot3(ab, cp);
+	float d6 = Dot3(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		closest[0] = c[0]; closest[1] = c[1]; closest[2] = c[2];
+		return;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		float w = d2 / (d2 - d6);
+		for (uint_t i = 0; i < 3; i++)
+		{
+			closest[i] = a[i] + w * ac[i];
+		}
+		return;
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		for (uint_t i = 0; i < 3; i++)
+		{
+			closest[i] = b[i] + w * (c[i] - b[i]);
+		}
+		return;
+	}
+
+	float denominator = 1.0f / (va + vb + vc);
+	float v = vb * denominator;
+	float w = vc * denominator;
+	for (uint_t i = 0; i < 3; i++)
+	{
+		closest[i] = a[i] + ab[i] * v + ac[i] * w;
+	}
+}
+
+static inline float NodeDistanceSquared(const BVHNode& node, const float* p)
+{
+	float distance = 0.0f;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		float d = Max(Max(node.boundsMin[i] - p[i], p[i] - node.boundsMax[i]), 0.0f);
+		distance += d * d;
+	}
+
+	return distance;
+}
+
+BVH::BVH() : nodeCount(0) {}
+
+BVH::BVH(const Vector3* vertices, uint_t vertexCount, const uint_t* indices, uint_t triangleCount, uint_t maxLeafSize, BVHBuildMethod method) : nodeCount(0)
+{
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	for (uint_t i = 0; i < triangleCount * 3; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			throw MeshInvalidIndex();
+		}
+	}
+
+	std::vector<float> centroids(triangleCount * 3);
+	std::vector<float> bounds(triangleCount * 6);
+
+	ParallelFor(0, triangleCount, BVH_PARALLEL_THRESHOLD, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			const float* v0 = vertices[indices[i * 3]].GetData();
+			const float* v1 = vertices[indices[i * 3 + 1]].GetData();
+			const float* v2 = vertices[indices[i * 3 + 2]].GetData();
+
+			for (uint_t axis = 0; axis < 3; axis++)
+			{
+				bounds[i * 6 + axis] = Min(Min(v0[axis], v1[axis]), v2[axis]);
+				bounds[i * 6 + 3 + axis] = Max(Max(v0[axis], v1[axis]), v2[axis]);
+				centroids[i * 3 + axis] = (v0[axis] + v1[axis] + v2[axis]) * (1.0f / 3.0f);
+			}
+		}
+	});
+
+	if (method == BVH_BUILD_LINEAR)
+	{
+		this->BuildLinear(centroids, bounds, maxLeafSize == 0 ? 1 : maxLeafSize);
+	}
+	else
+	{
+		this->Build(centroids, bounds, maxLeafSize == 0 ? 1 : maxLeafSize);
+	}
+
+	// Store triangles in leaf order so leaf tests walk memory linearly
+	this->triangleVertices.resize(triangleCount * 9);
+
+	ParallelFor(0, triangleCount, BVH_PARALLEL_THRESHOLD, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t slot = begin; slot < end; slot++)
+		{
+			uint_t triangle = this->triangleIndices[slot];
+
+			for (uint_t corner = 0; corner < 3; corner++)
+			{
+				const float* vertex = vertices[indices[triangle * 3 + corner]].GetData();
+
+				this->triangleVertices[slot * 9 + corner * 3] = vertex[0];
+				this->triangleVertices[slot * 9 + corner * 3 + 1] = vertex[1];
+				this->triangleVertices[slot * 9 + corner * 3 + 2] = vertex[2];
+			}
+		}
+	});
+}
+
+void BVH::Build(const std::vector<float>& centroids, const std::vector<float>& bounds, uint_t maxLeafSize)
+{
+	uint_t triangleCount = (uint_t)centroids.size() / 3;
+
+	this->triangleIndices.resize(triangleCount);
+	for (uint_t i = 0; i < triangleCount; i++)
+	{
+		this->triangleIndices[i] = i;
+	}
+
+	// A binary tree over N leaves never exceeds 2N - 1 nodes, slot 1 stays unused to keep siblings paired
+	this->nodes.resize(triangleCount * 2 + 1);
+
+	BVHBuildContext context;
+	context.nodes = this->nodes.data();
+	context.indices = this->triangleIndices.data();
+	context.centroids = centroids.data();
+	context.bounds = bounds.data();
+	context.nodesUsed = 2;
+	context.maxLeafSize = maxLeafSize;
+	context.spawnDepth = 0;
+
+	for (uint_t workers = GetWorkerCount(); workers > 1; workers >>= 1)
+	{
+		context.spawnDepth++;
+	}
+
+	this->nodes[0].leftFirst = 0;
+	this->nodes[0].count = triangleCount;
+
+	SubdivideNode(context, 0, 0);
+
+	this->nodeCount = context.nodesUsed.load();
+	this->nodes.resize(this->nodeCount);
+	this->nodes.shrink_to_fit();
+}
+
+//
+// Codes in [first, last] share every bit above the highest bit where codes[first] and
+// codes[last] differ, the split is the last code with that bit clear. Ranges of equal codes
+// are halved.
+//
+static uint_t FindMortonSplit(const uintc_t* codes, uint_t first, uint_t last)
+{
+	uintc_t difference = codes[first] ^ codes[last];
+
+	if (difference == 0)
+	{
+		return (first + last) >> 1;
+	}
+
+	for (uint_t shift = 1; shift < 64; shift <<= 1)
+	{
+		difference |= difference >> shift;
+	}
+
+	uintc_t threshold = codes[last] & ~(difference >> 1);
+
+	return (uint_t)(std::lower_bound(codes + first, codes + last + 1, threshold) - codes) - 1;
+}
+
+static void BuildLinearNode(LinearBuildContext& context, uint_t nodeIndex, uint_t first, uint_t count, uint_t depth)
+{
+	BVHNode& node = context.nodes[nodeIndex];
+
+	if (count <= context.maxLeafSize || depth >= BVH_MAX_DEPTH)
+	{
+		node.leftFirst = first;
+		node.count = count;
+		ResetBounds(node.boundsMin, node.boundsMax);
+
+		for (uint_t i = first; i < first + count; i++)
+		{
+			const float* bounds = context.bounds + context.indices[i] * 6;
+
+			GrowBounds(node.boundsMin, node.boundsMax, bounds, bounds + 3);
+		}
+
+		return;
+	}
+
+	uint_t leftCount = FindMortonSplit(context.codes, first, first + count - 1) - first + 1;
+	uint_t leftIndex = context.nodesUsed.fetch_add(2);
+
+	node.leftFirst = leftIndex;
+	node.count = 0;
+
+	if (depth < context.spawnDepth && count > BVH_PARALLEL_THRESHOLD)
+	{
+		std::thread leftThread(BuildLinearNode, std::ref(context), leftIndex, first, leftCount, depth + 1);
+		BuildLinearNode(context, leftIndex + 1, first + leftCount, count - leftCount, depth + 1);
+		leftThread.join();
+	}
+	else
+	{
+		BuildLinearNode(context, leftIndex, first, leftCount, depth + 1);
+		BuildLinearNode(context, leftIndex + 1, first + leftCount, count - leftCount, depth + 1);
+	}
+
+	const BVHNode& left = context.nodes[leftIndex];
+	const BVHNode& right = context.nodes[leftIndex + 1];
+
+	for (uint_t axis = 0; axis < 3; axis++)
+	{
+		node.boundsMin[axis] = Min(left.boundsMin[axis], right.boundsMin[axis]);
+		node.boundsMax[axis] = Max(left.boundsMax[axis], right.boundsMax[axis]);
+	}
+}
+
+void BVH::BuildLinear(const std::vector<float>& centroids, const std::vector<float>& bounds, uint_t maxLeafSize)
+{
+	uint_t triangleCount = (uint_t)centroids.size() / 3;
+	uint_t chunkCount = GetWorkerCount();
+	std::vector<float> chunkBounds(chunkCount * 6);
+
+	for (uint_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		ResetBounds(chunkBounds.data() + chunk * 6, chunkBounds.data() + chunk * 6 + 3);
+	}
+
+	// Centroid bounds span the Morton grid
+	ParallelFor(0, chunkCount, 1, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t chunk = begin; chunk < end; chunk++)
+		{
+			float* chunkMin = chunkBounds.data() + chunk * 6;
+			float* chunkMax = chunkMin + 3;
+			uint_t first = (uint_t)((uintc_t)chunk * triangleCount / chunkCount);
+			uint_t last = (uint_t)((uintc_t)(chunk + 1) * triangleCount / chunkCount);
+
+			for (uint_t i = first; i < last; i++)
+			{
+				GrowBounds(chunkMin, chunkMax, centroids.data() + i * 3, centroids.data() + i * 3);
+			}
+		}
+	});
+
+	float centroidMin[3];
+	float centroidMax[3];
+
+	ResetBounds(centroidMin, centroidMax);
+
+	for (uint_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		GrowBounds(centroidMin, centroidMax, chunkBounds.data() + chunk * 6, chunkBounds.data() + chunk * 6 + 3);
+	}
+
+	std::vector<uintc_t> codes(triangleCount);
+	std::vector<uintc_t> scratchCodes(triangleCount);
+	std::vector<uint_t> scratchIndices(triangleCount);
+
+	this->triangleIndices.resize(triangleCount);
+
+	EncodeMorton63(centroids.data(), 3, triangleCount, Vector3(centroidMin), Vector3(centroidMax), codes.data());
+
+	ParallelFor(0, triangleCount, BVH_PARALLEL_THRESHOLD, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			this->triangleIndices[i] = i;
+		}
+	});
+
+	RadixSortPairs(codes.data(), this->triangleIndices.data(), scratchCodes.data(), scratchIndices.data(), triangleCount);
+
+	this->nodes.resize(triangleCount * 2 + 1);
+
+	LinearBuildContext context;
+	context.nodes = this->nodes.data();
+	context.indices = this->triangleIndices.data();
+	context.codes = codes.data();
+	context.bounds = bounds.data();
+	context.nodesUsed = 2;
+	context.maxLeafSize = maxLeafSize;
+	context.spawnDepth = 0;
+
+	for (uint_t workers = GetWorkerCount(); workers > 1; workers >>= 1)
+	{
+		context.spawnDepth++;
+	}
+
+	BuildLinearNode(context, 0, 0, triangleCount, 0);
+
+	this->nodeCount = context.nodesUsed.load();
+	this->nodes.resize(this->nodeCount);
+	this->nodes.shrink_to_fit();
+}
+
+bool BVH::Intersect(const Ray& ray, BVHHit& hit, float maxDistance) const
+{
+	if (this->nodeCount == 0)
+	{
+		return false;
+	}
+
+	const float* origin = ray.GetOrigin().GetData();
+	const float* direction = ray.GetDirection().GetData();
+	const float* inverseDirection = ray.GetInverseDirection().GetData();
+
+	float closest = maxDistance;
+	bool found = false;
+
+	uint_t stack[BVH_STACK_SIZE];
+	uint_t stackSize = 0;
+	uint_t current = 0;
+
+	if (IntersectNode(this->nodes[0], origin, inverseDirection, closest) == FLT_MAX)
+	{
+		return false;
+	}
+
+	while (true)
+	{
+		const BVHNode& node = this->nodes[current];
+
+		if (node.IsLeaf())
+		{
+			for (uint_t slot = node.leftFirst; slot < node.leftFirst + node.count; slot++)
+			{
+				float t, u, v;
+
+				if (IntersectTriangle(this->triangleVertices.data() + slot * 9, origin, direction, t, u, v) && t < closest)
+				{
+					closest = t;
+					hit.t = t;
+					hit.u = u;
+					hit.v = v;
+					hit.triangle = this->triangleIndices[slot];
+					found = true;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			current = stack[--stackSize];
+			continue;
+		}
+
+		uint_t nearChild = node.leftFirst;
+		uint_t farChild = node.leftFirst + 1;
+		float nearDistance = IntersectNode(this->nodes[nearChild], origin, inverseDirection, closest);
+		float farDistance = IntersectNode(this->nodes[farChild], origin, inverseDirection, closest);
+
+		if (farDistance < nearDistance)
+		{
+			std::swap(nearChild, farChild);
+			std::swap(nearDistance, farDistance);
+		}
+
+		if (nearDistance == FLT_MAX)
+		{
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			current = stack[--stackSize];
+			continue;
+		}
+
+		current = nearChild;
+
+		if (farDistance != FLT_MAX)
+		{
+			stack[stackSize++] = farChild;
+		}
+	}
+
+	return found;
+}
+
+bool BVH::IntersectAny(const Ray& ray, float maxDistance) const
+{
+	if (this->nodeCount == 0)
+	{
+		return false;
+	}
+
+	const float* origin = ray.GetOrigin().GetData();
+	const float* direction = ray.GetDirection().GetData();
+	const float* inverseDirection = ray.GetInverseDirection().GetData();
+
+	uint_t stack[BVH_STACK_SIZE];
+	uint_t stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVHNode& node = this->nodes[stack[--stackSize]];
+
+		if (IntersectNode(node, origin, inverseDirection, maxDistance) == FLT_MAX)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (uint_t slot = node.leftFirst; slot < node.leftFirst + node.count; slot++)
+			{
+				float t, u, v;
+
+				if (IntersectTriangle(this->triangleVertices.data() + slot * 9, origin, direction, t, u, v) && t < maxDistance)
+				{
+					return true;
+				}
+			}
+
+			continue;
+		}
+
+		stack[stackSize++] = node.leftFirst + 1;
+		stack[stackSize++] = node.leftFirst;
+	}
+
+	return false;
+}
+
+bool BVH::FindNearestPoint(const Vector3& point, BVHNearest& nearest, float maxDistance) const
+{
+	if (this->nodeCount == 0)
+	{
+		return false;
+	}
+
+	const float* p = point.GetData();
+
+	float best = maxDistance == FLT_MAX ? FLT_MAX : maxDistance * maxDistance;
+	bool found = false;
+
+	uint_t stack[BVH_STACK_SIZE];
+	uint_t stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVHNode& node = this->nodes[stack[--stackSize]];
+
+		if (NodeDistanceSquared(node, p) >= best)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (uint_t slot = node.leftFirst; slot < node.leftFirst + node.count; slot++)
+			{
+				float closest[3];
+				ClosestPointOnTriangle(this->triangleVertices.data() + slot * 9, p, closest);
+
+				float d[3] = { closest[0] - p[0], closest[1] - p[1], closest[2] - p[2] };
+				float distance = Dot3(d, d);
+
+				if (distance < best)
+				{
+					best = distance;
+					nearest.point[0] = closest[0];
+					nearest.point[1] = closest[1];
+					nearest.point[2] = closest[2];
+					nearest.distanceSquared = distance;
+					nearest.triangle = this->triangleIndices[slot];
+					found = true;
+				}
+			}
+
+			continue;
+		}
+
+		// Visit the closer child first so the search radius shrinks early
+		uint_t nearChild = node.leftFirst;
+		uint_t farChild = node.leftFirst + 1;
+
+		if (NodeDistanceSquared(this->nodes[farChild], p) < NodeDistanceSquared(this->nodes[nearChild], p))
+		{
+			std::swap(nearChild, farChild);
+		}
+
+		stack[stackSize++] = farChild;
+		stack[stackSize++] = nearChild;
+	}
+
+	return found;
+}
+
+void BVH::Intersect(const Ray* rays, uint_t count, BVHHit* hits, bool* hitMask) const
+{
+	ParallelFor(0, count, BVH_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			hitMask[i] = this->Intersect(rays[i], hits[i]);
+		}
+	});
+}
+
+void BVH::IntersectAny(const Ray* rays, uint_t count, bool* hitMask) const
+{
+	ParallelFor(0, count, BVH_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			hitMask[i] = this->IntersectAny(rays[i]);
+		}
+	});
+}
+
+void BVH::FindNearestPoint(const Vector3* points, uint_t count, BVHNearest* nearest) const
+{
+	ParallelFor(0, count, BVH_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			if (!this->FindNearestPoint(points[i], nearest[i]))
+			{
+				nearest[i].distanceSquared = FLT_MAX;
+				nearest[i].triangle = (uint_t)-1;
+			}
+		}
+	});
+}
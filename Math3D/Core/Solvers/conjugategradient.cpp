@@ -0,0 +1,201 @@
+#include "conjugategradient.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using namespace math3d;
+
+static const uint_t CG_VECTOR_GRAIN = 16384;
+
+template <typename T>
+static T ParallelDot(const T* vectorA, const T* vectorB, uint_t size)
+{
+	return ParallelSum<T>(0, size, CG_VECTOR_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		T sum = (T)0;
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			sum += vectorA[i] * vectorB[i];
+		}
+
+		return sum;
+	});
+}
+
+/* result = vectorA + scalar * vectorB, result may alias either input */
+template <typename T>
+static void ParallelAxpy(T* result, const T* vectorA, T scalar, const T* vectorB, uint_t size)
+{
+	ParallelFor(0, size, CG_VECTOR_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			result[i] = vectorA[i] + scalar * vectorB[i];
+		}
+	});
+}
+
+//
+// Shared PCG loop, applyMatrix(in, out) computes out = A * in and
+// applyPreconditioner(in, out) computes out = M^-1 * in
+//
+template <typename T, typename MatrixOp, typename PreconditionerOp>
+static SolverResult<T> PreconditionedConjugateGradient(uint_t size, MatrixOp applyMatrix, PreconditionerOp applyPreconditioner, const T* rhs, T* solution, T tolerance, uint_t maxIterations)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	SolverResult<T> result;
+	result.iterations = 0;
+	result.converged = false;
+
+	std::vector<T> residual(size);
+	std::vector<T> preconditioned(size);
+	std::vector<T> direction(size);
+	std::vector<T> product(size);
+
+	T* r = residual.data();
+	T* z = preconditioned.data();
+	T* p = direction.data();
+	T* ap = product.data();
+
+	applyMatrix(solution, ap);
+	ParallelAxpy(r, rhs, (T)-1, ap, size);
+
+	T rhsNorm = std::sqrt(ParallelDot(rhs, rhs, size));
+	T threshold = tolerance * (rhsNorm > (T)0 ? rhsNorm : (T)1);
+	T residualNorm = std::sqrt(ParallelDot(r, r, size));
+
+	if (residualNorm > threshold)
+	{
+		applyPreconditioner(r, z);
+
+		for (uint_t i = 0; i < size; i++)
+		{
+			p[i] = z[i];
+		}
+
+		T rz = ParallelDot(r, z, size);
+
+		while (result.iterations < maxIterations)
+		{
+			applyMatrix(p, ap);
+
+			T pap = ParallelDot(p, ap, size);
+			if (pap <= (T)0)
+			{
+				// Not positive definite along p (or exact breakdown), no further progress possible
+				break;
+			}
+
+			T alpha = rz / pap;
+
+			ParallelAxpy(solution, solution, alpha, p, size);
+			ParallelAxpy(r, r, -alpha, ap, size);
+
+			result.iterations++;
+			residualNorm = std::sqrt(ParallelDot(r, r, size));
+
+			if (residualNorm <= threshold)
+			{
+				break;
+			}
+
+			applyPreconditioner(r, z);
+
+			T rzNext = ParallelDot(r, z, size);
+			T beta = rzNext / rz;
+			rz = rzNext;
+
+			ParallelAxpy(p, z, beta, p, size);
+		}
+	}
+
+	result.residualNorm = residualNorm;
+	result.converged = residualNorm <= threshold;
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return result;
+}
+
+template <typename T>
+SolverResult<T> math3d::SolveConjugateGradient(const SparseMatrix<T>& matrix, const T* rhs, T* solution, T tolerance, uint_t maxIterations)
+{
+	if (matrix.GetNumberOfRows() != matrix.GetNumberOfColumns())
+	{
+		throw MatrixNoSquare();
+	}
+
+	uint_t size = matrix.GetNumberOfRows();
+	std::vector<T> inverseDiagonal(size);
+
+	matrix.GetDiagonal(inverseDiagonal.data());
+	for (uint_t i = 0; i < size; i++)
+	{
+		inverseDiagonal[i] = inverseDiagonal[i] != (T)0 ? (T)1 / inverseDiagonal[i] : (T)1;
+	}
+
+	const T* invDiag = inverseDiagonal.data();
+
+	auto applyMatrix = [&](const T* in, T* out)
+	{
+		matrix.Multiply(in, out);
+	};
+
+	auto applyPreconditioner = [=](const T* in, T* out)
+	{
+		ParallelFor(0, size, CG_VECTOR_GRAIN, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t i = begin; i < end; i++)
+			{
+				out[i] = invDiag[i] * in[i];
+			}
+		});
+	};
+
+	return PreconditionedConjugateGradient<T>(size, applyMatrix, applyPreconditioner, rhs, solution, tolerance, maxIterations);
+}
+
+SolverResult<float> math3d::SolveConjugateGradient(const BlockSparseMatrix3x3& matrix, const float* rhs, float* solution, float tolerance, uint_t maxIterations)
+{
+	if (matrix.GetNumberOfBlockRows() != matrix.GetNumberOfBlockColumns())
+	{
+		throw MatrixNoSquare();
+	}
+
+	uint_t blockCount = matrix.GetNumberOfBlockRows();
+	std::vector<float> inverseBlocks(blockCount * 9);
+
+	matrix.GetInverseDiagonalBlocks(inverseBlocks.data());
+
+	const float* invBlocks = inverseBlocks.data();
+
+	auto applyMatrix = [&](const float* in, float* out)
+	{
+		matrix.Multiply(in, out);
+	};
+
+	auto applyPreconditioner = [=](const float* in, float* out)
+	{
+		ParallelFor(0, blockCount, CG_VECTOR_GRAIN / 3, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t i = begin; i < end; i++)
+			{
+				const float* b = invBlocks + i * 9;
+				const float* v = in + i * 3;
+
+				out[i * 3] = b[0] * v[0] + b[1] * v[1] + b[2] * v[2];
+				out[i * 3 + 1] = b[3] * v[0] + b[4] * v[1] + b[5] * v[2];
+				out[i * 3 + 2] = b[6] * v[0] + b[7] * v[1] + b[8] * v[2];
+			}
+		});
+	};
+
+	return PreconditionedConjugateGradient<float>(blockCount * 3, applyMatrix, applyPreconditioner, rhs, solution, tolerance, maxIterations);
+}
+
+/* Enforce numeric types */
+template SolverResult<float> math3d::SolveConjugateGradient<float>(const SparseMatrix<float>&, const float*, float*, float, uint_t);
+template SolverResult<double> math3d::SolveConjugateGradient<double>(const SparseMatrix<double>&, const double*, double*, double, uint_t);
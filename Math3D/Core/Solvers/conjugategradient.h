@@ -0,0 +1,27 @@
+#pragma once
+#include "sparsematrix.h"
+
+namespace math3d
+{
+	template <typename T>
+	struct SolverResult
+	{
+		uint_t iterations;
+		T residualNorm;
+		double seconds;
+		bool converged;
+	};
+
+	//
+	// Preconditioned conjugate gradient for symmetric positive definite systems.
+	// solution is read as the initial guess (warm start) and overwritten with the result.
+	// Stops once ||b - Ax|| <= tolerance * ||b|| or after maxIterations.
+	//
+
+	/* Jacobi (inverse diagonal) preconditioner */
+	template <typename T>
+	SolverResult<T> SolveConjugateGradient(const SparseMatrix<T>& matrix, const T* rhs, T* solution, T tolerance, uint_t maxIterations);
+
+	/* Block Jacobi (inverse 3x3 diagonal blocks) preconditioner */
+	SolverResult<float> SolveConjugateGradient(const BlockSparseMatrix3x3& matrix, const float* rhs, float* solution, float tolerance, uint_t maxIterations);
+}
@@ -0,0 +1,800 @@
+#include "convexhull.h"
+#include "predicates.h"
+#include "math3dparallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX__) || defined(__AVX2__)
+#include <immintrin.h>
+#define MATH3D_AVX
+#endif
+
+using namespace math3d;
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 arrays are treated as tightly packed floats");
+
+static const uint_t HULL_DIRECTION_COUNT = 13;
+static const uint_t HULL_LANES = 64;
+static const uint_t HULL_PREFILTER_GRAIN = 65536;
+static const uint_t HULL_ASSIGN_GRAIN = 4096;
+static const uint_t HULL_NONE = 0xFFFFFFFFu;
+
+/* Axes, face diagonals and cube diagonals, each one used in both senses */
+static const float HULL_DIRECTIONS[HULL_DIRECTION_COUNT][3] =
+{
+	{ 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+	{ 1.0f, 1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 1.0f }, { 0.0f, 1.0f, -1.0f },
+	{ 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, -1.0f }
+};
+
+namespace
+{
+	struct HullFace
+	{
+		uint_t vertices[3];
+		/* Face across the edge vertices[k] -> vertices[k + 1] */
+		uint_t neighbors[3];
+		/* Points strictly outside the face and the farthest of them, the most negative Orient3D */
+		std::vector<uint_t> outside;
+		uint_t farthest;
+		double farthestOrientation;
+		/* Iteration in which visible was last set */
+		uint_t stamp;
+		bool visible;
+		bool alive;
+	};
+
+	/* Horizon edge a -> b as seen in the visible face it bounds, neighbor is the face kept on the other side */
+	struct HorizonEdge
+	{
+		uint_t a;
+		uint_t b;
+		uint_t neighbor;
+	};
+
+	struct ExtremePoints
+	{
+		float maxValues[HULL_DIRECTION_COUNT];
+		float minValues[HULL_DIRECTION_COUNT];
+		uint_t maxIndices[HULL_DIRECTION_COUNT];
+		uint_t minIndices[HULL_DIRECTION_COUNT];
+	};
+
+	/* Unit outward plane n . p = d of a face, points more than tolerance below it are inside */
+	struct HullPlane
+	{
+		float nx;
+		float ny;
+		float nz;
+		float d;
+		float tolerance;
+	};
+
+	class HullBuilder
+	{
+	private:
+		const Vector3* points;
+		std::vector<HullFace> faces;
+		/* Faces that had a non empty outside set when created, possibly dead by now */
+		std::vector<uint_t> pending;
+		std::vector<uint_t> visibleFaces;
+		std::vector<uint_t> stack;
+		std::vector<HorizonEdge> horizon;
+		std::vector<uint_t> gathered;
+		std::vector<uint_t> assignments;
+		std::vector<double> orientations;
+		uint_t stamp;
+
+		uint_t AddFace(uint_t a, uint_t b, uint_t c);
+		void AssignPoints(const uint_t* candidates, uint_t count, uint_t firstFace);
+		void AddPoint(uint_t faceIndex);
+
+		/* Negative when the point is strictly outside the face */
+		inline double GetOrientation(const HullFace& face, uint_t point) const
+		{
+			return Orient3D(this->points[face.vertices[0]], this->points[face.vertices[1]], this->points[face.vertices[2]], this->points[point]);
+		}
+
+	public:
+		HullBuilder(const Vector3* points) : points(points), stamp(0) {}
+
+		void Build(const uint_t* simplex, const uint_t* candidates, uint_t count);
+
+		inline const std::vector<HullFace>& GetFaces() const
+		{
+			return this->faces;
+		}
+	};
+}
+
+uint_t HullBuilder::AddFace(uint_t a, uint_t b, uint_t c)
+{
+	HullFace face;
+
+	face.vertices[0] = a;
+	face.vertices[1] = b;
+	face.vertices[2] = c;
+	face.neighbors[0] = HULL_NONE;
+	face.neighbors[1] = HULL_NONE;
+	face.neighbors[2] = HULL_NONE;
+	face.farthest = HULL_NONE;
+	face.farthestOrientation = 0.0;
+	face.stamp = 0;
+	face.visible = false;
+	face.alive = true;
+	this->faces.push_back(std::move(face));
+
+	return (uint_t)this->faces.size() - 1;
+}
+
+//
+// Each candidate goes to the first face in [firstFace, end) it is strictly outside of, the
+// others are inside the hull and dropped for good (Barber et al., a point above a deleted face
+// and below every new face is inside the new hull). The tests run in parallel, the outside sets
+// are then filled in candidate order so the build does not depend on the thread count.
+//
+void HullBuilder::AssignPoints(const uint_t* candidates, uint_t count, uint_t firstFace)
+{
+	uint_t faceEnd = (uint_t)this->faces.size();
+
+	this->assignments.resize(count);
+	this->orientations.resize(count);
+
+	ParallelFor(0, count, HULL_ASSIGN_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			this->assignments[i] = HULL_NONE;
+
+			for (uint_t f = firstFace; f < faceEnd; f++)
+			{
+				double orientation = this->GetOrientation(this->faces[f], candidates[i]);
+
+				if (orientation < 0.0)
+				{
+					this->assignments[i] = f;
+					this->orientations[i] = orientation;
+					break;
+				}
+			}
+		}
+	});
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		if (this->assignments[i] == HULL_NONE)
+		{
+			continue;
+		}
+
+		HullFace& face = this->faces[this->assignments[i]];
+
+		if (face.outside.empty() || this->orientations[i] < face.farthestOrientation)
+		{
+			face.farthest = candidates[i];
+			face.farthestOrientation = this->orientations[i];
+		}
+
+		face.outside.push_back(candidates[i]);
+	}
+
+	for (uint_t f = firstFace; f < faceEnd; f++)
+	{
+		if (!this->faces[f].outside.empty())
+		{
+			this->pending.push_back(f);
+		}
+	}
+}
+
+//
+// Adds the farthest outside point of a face: the faces it sees are found by a flood fill from
+// that face, they are replaced by a cone of new faces from the point to the horizon, and their
+// outside points are handed to the cone. The horizon is a single cycle, so sorting its edges
+// by start vertex finds the cone neighbor across each new edge.
+//
+void HullBuilder::AddPoint(uint_t faceIndex)
+{
+	uint_t eye = this->faces[faceIndex].farthest;
+
+	this->stamp++;
+	this->visibleFaces.clear();
+	this->horizon.clear();
+	this->stack.assign(1, faceIndex);
+	this->faces[faceIndex].stamp = this->stamp;
+	this->faces[faceIndex].visible = true;
+
+	while (!this->stack.empty())
+	{
+		uint_t f = this->stack.back();
+
+		this->stack.pop_back();
+		this->visibleFaces.push_back(f);
+
+		for (uint_t k = 0; k < 3; k++)
+		{
+			uint_t n = this->faces[f].neighbors[k];
+			HullFace& neighbor = this->faces[n];
+
+			if (neighbor.stamp != this->stamp)
+			{
+				neighbor.stamp = this->stamp;
+				neighbor.visible = this->GetOrientation(neighbor, eye) < 0.0;
+
+				if (neighbor.visible)
+				{
+					this->stack.push_back(n);
+				}
+			}
+
+			if (!neighbor.visible)
+			{
+				this->horizon.push_back({ this->faces[f].vertices[k], this->faces[f].vertices[k == 2 ? 0 : k + 1], n });
+			}
+		}
+	}
+
+	this->gathered.clear();
+
+	for (uint_t f : this->visibleFaces)
+	{
+		HullFace& face = this->faces[f];
+
+		face.alive = false;
+
+		for (uint_t point : face.outside)
+		{
+			if (point != eye)
+			{
+				this->gathered.push_back(point);
+			}
+		}
+
+		std::vector<uint_t>().swap(face.outside);
+	}
+
+	std::sort(this->horizon.begin(), this->horizon.end(), [](const HorizonEdge& a, const HorizonEdge& b) { return a.a < b.a; });
+
+	uint_t firstFace = (uint_t)this->faces.size();
+	uint_t horizonCount = (uint_t)this->horizon.size();
+
+	for (const HorizonEdge& edge : this->horizon)
+	{
+		uint_t f = this->AddFace(edge.a, edge.b, eye);
+		HullFace& neighbor = this->faces[edge.neighbor];
+
+		this->faces[f].neighbors[0] = edge.neighbor;
+
+		for (uint_t k = 0; k < 3; k++)
+		{
+			if (neighbor.vertices[k] == edge.b && neighbor.vertices[k == 2 ? 0 : k + 1] == edge.a)
+			{
+				neighbor.neighbors[k] = f;
+			}
+		}
+	}
+
+	// Face (a, b, eye) meets the face starting at b across b -> eye
+	for (uint_t i = 0; i < horizonCount; i++)
+	{
+		uint_t b = this->horizon[i].b;
+		uint_t next = (uint_t)(std::lower_bound(this->horizon.begin(), this->horizon.end(), b,
+			[](const HorizonEdge& edge, uint_t vertex) { return edge.a < vertex; }) - this->horizon.begin());
+
+		this->faces[firstFace + i].neighbors[1] = firstFace + next;
+		this->faces[firstFace + next].neighbors[2] = firstFace + i;
+	}
+
+	this->AssignPoints(this->gathered.data(), (uint_t)this->gathered.size(), firstFace);
+}
+
+void HullBuilder::Build(const uint_t* simplex, const uint_t* candidates, uint_t count)
+{
+	uint_t p0 = simplex[0];
+	uint_t p1 = simplex[1];
+	uint_t p2 = simplex[2];
+	uint_t p3 = simplex[3];
+
+	// With Orient3D(p0, p1, p2, p3) > 0 the apex is below the base, every face below lists its vertices counterclockwise from outside
+	if (Orient3D(this->points[p0], this->points[p1], this->points[p2], this->points[p3]) < 0.0)
+	{
+		std::swap(p1, p2);
+	}
+
+	this->faces.clear();
+	this->pending.clear();
+	this->AddFace(p0, p1, p2);
+	this->AddFace(p1, p0, p3);
+	this->AddFace(p2, p1, p3);
+	this->AddFace(p0, p2, p3);
+
+	for (uint_t f = 0; f < 4; f++)
+	{
+		for (uint_t k = 0; k < 3; k++)
+		{
+			uint_t a = this->faces[f].vertices[k];
+			uint_t b = this->faces[f].vertices[k == 2 ? 0 : k + 1];
+
+			for (uint_t g = 0; g < 4; g++)
+			{
+				for (uint_t l = 0; l < 3; l++)
+				{
+					if (this->faces[g].vertices[l] == b && this->faces[g].vertices[l == 2 ? 0 : l + 1] == a)
+					{
+						this->faces[f].neighbors[k] = g;
+					}
+				}
+			}
+		}
+	}
+
+	this->AssignPoints(candidates, count, 0);
+
+	while (!this->pending.empty())
+	{
+		uint_t f = this->pending.back();
+
+		this->pending.pop_back();
+
+		if (this->faces[f].alive && !this->faces[f].outside.empty())
+		{
+			this->AddPoint(f);
+		}
+	}
+}
+
+/* Points [begin, begin + lanes) as SoA lanes, the tail repeats lane 0 so full width loops stay valid */
+static void LoadLanes(const Vector3* points, uint_t begin, uint_t lanes, float* x, float* y, float* z)
+{
+	const float* p = points[begin].GetData();
+
+	for (uint_t i = 0; i < lanes; i++)
+	{
+		x[i] = p[i * 3];
+		y[i] = p[i * 3 + 1];
+		z[i] = p[i * 3 + 2];
+	}
+
+	for (uint_t i = lanes; i < HULL_LANES; i++)
+	{
+		x[i] = x[0];
+		y[i] = y[0];
+		z[i] = z[0];
+	}
+}
+
+//
+// Projections of a block on every direction. The block maximum and minimum are vector
+// reductions, the lanes are only searched for the index when the running extreme improves.
+// Padded lanes copy lane 0, so the first lane holding the extreme is always a real point.
+//
+static void UpdateExtremes(const float* x, const float* y, const float* z, uint_t begin, ExtremePoints& extremes)
+{
+	alignas(32) float dots[HULL_LANES];
+
+	for (uint_t d = 0; d < HULL_DIRECTION_COUNT; d++)
+	{
+		float high;
+		float low;
+
+#ifdef MATH3D_AVX
+		__m256 dx = _mm256_set1_ps(HULL_DIRECTIONS[d][0]);
+		__m256 dy = _mm256_set1_ps(HULL_DIRECTIONS[d][1]);
+		__m256 dz = _mm256_set1_ps(HULL_DIRECTIONS[d][2]);
+		__m256 highs = _mm256_set1_ps(-FLT_MAX);
+		__m256 lows = _mm256_set1_ps(FLT_MAX);
+
+		for (uint_t i = 0; i < HULL_LANES; i += 8)
+		{
+			__m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, _mm256_load_ps(x + i)), _mm256_mul_ps(dy, _mm256_load_ps(y + i))),
+				_mm256_mul_ps(dz, _mm256_load_ps(z + i)));
+
+			_mm256_store_ps(dots + i, dot);
+			highs = _mm256_max_ps(highs, dot);
+			lows = _mm256_min_ps(lows, dot);
+		}
+
+		alignas(32) float highLanes[8];
+		alignas(32) float lowLanes[8];
+
+		_mm256_store_ps(highLanes, highs);
+		_mm256_store_ps(lowLanes, lows);
+		high = highLanes[0];
+		low = lowLanes[0];
+
+		for (uint_t i = 1; i < 8; i++)
+		{
+			high = highLanes[i] > high ? highLanes[i] : high;
+			low = lowLanes[i] < low ? lowLanes[i] : low;
+		}
+#else
+		high = -FLT_MAX;
+		low = FLT_MAX;
+
+		for (uint_t i = 0; i < HULL_LANES; i++)
+		{
+			dots[i] = HULL_DIRECTIONS[d][0] * x[i] + HULL_DIRECTIONS[d][1] * y[i] + HULL_DIRECTIONS[d][2] * z[i];
+			high = dots[i] > high ? dots[i] : high;
+			low = dots[i] < low ? dots[i] : low;
+		}
+#endif
+
+		if (high > extremes.maxValues[d])
+		{
+			uint_t i = 0;
+
+			while (dots[i] != high)
+			{
+				i++;
+			}
+
+			extremes.maxValues[d] = high;
+			extremes.maxIndices[d] = begin + i;
+		}
+
+		if (low < extremes.minValues[d])
+		{
+			uint_t i = 0;
+
+			while (dots[i] != low)
+			{
+				i++;
+			}
+
+			extremes.minValues[d] = low;
+			extremes.minIndices[d] = begin + i;
+		}
+	}
+}
+
+/* Distinct extreme points over all directions, sorted by index, and the largest absolute coordinate */
+static void FindExtremePoints(const Vector3* points, uint_t count, std::vector<uint_t>& indices, float& bound)
+{
+	uint_t chunkCount = (count + HULL_PREFILTER_GRAIN - 1) / HULL_PREFILTER_GRAIN;
+	std::vector<ExtremePoints> chunks(chunkCount);
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t chunkBegin, uint_t chunkEnd)
+	{
+		alignas(32) float x[HULL_LANES];
+		alignas(32) float y[HULL_LANES];
+		alignas(32) float z[HULL_LANES];
+
+		for (uint_t c = chunkBegin; c < chunkEnd; c++)
+		{
+			ExtremePoints& extremes = chunks[c];
+			uint_t begin = c * HULL_PREFILTER_GRAIN;
+			uint_t end = count - begin > HULL_PREFILTER_GRAIN ? begin + HULL_PREFILTER_GRAIN : count;
+
+			for (uint_t d = 0; d < HULL_DIRECTION_COUNT; d++)
+			{
+				extremes.maxValues[d] = -FLT_MAX;
+				extremes.minValues[d] = FLT_MAX;
+				extremes.maxIndices[d] = begin;
+				extremes.minIndices[d] = begin;
+			}
+
+			for (uint_t block = begin; block < end; block += HULL_LANES)
+			{
+				LoadLanes(points, block, end - block < HULL_LANES ? end - block : HULL_LANES, x, y, z);
+				UpdateExtremes(x, y, z, block, extremes);
+			}
+		}
+	});
+
+	ExtremePoints extremes = chunks[0];
+
+	for (uint_t c = 1; c < chunkCount; c++)
+	{
+		for (uint_t d = 0; d < HULL_DIRECTION_COUNT; d++)
+		{
+			if (chunks[c].maxValues[d] > extremes.maxValues[d])
+			{
+				extremes.maxValues[d] = chunks[c].maxValues[d];
+				extremes.maxIndices[d] = chunks[c].maxIndices[d];
+			}
+
+			if (chunks[c].minValues[d] < extremes.minValues[d])
+			{
+				extremes.minValues[d] = chunks[c].minValues[d];
+				extremes.minIndices[d] = chunks[c].minIndices[d];
+			}
+		}
+	}
+
+	indices.clear();
+	bound = 0.0f;
+
+	for (uint_t d = 0; d < HULL_DIRECTION_COUNT; d++)
+	{
+		indices.push_back(extremes.maxIndices[d]);
+		indices.push_back(extremes.minIndices[d]);
+	}
+
+	for (uint_t d = 0; d < 3; d++)
+	{
+		bound = std::fabs(extremes.maxValues[d]) > bound ? std::fabs(extremes.maxValues[d]) : bound;
+		bound = std::fabs(extremes.minValues[d]) > bound ? std::fabs(extremes.minValues[d]) : bound;
+	}
+
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
+//
+// Initial tetrahedron from the candidates: the extreme pair along the axis of largest spread,
+// the point farthest from their line, then the point with the largest Orient3D magnitude.
+// Returns false when the candidates are coplanar.
+//
+static bool FindSimplex(const Vector3* points, const std::vector<uint_t>& candidates, uint_t* simplex)
+{
+	double bestSpread = 0.0;
+
+	for (uint_t axis = 0; axis < 3; axis++)
+	{
+		uint_t low = candidates[0];
+		uint_t high = candidates[0];
+
+		for (uint_t i : candidates)
+		{
+			low = points[i].GetData()[axis] < points[low].GetData()[axis] ? i : low;
+			high = points[i].GetData()[axis] > points[high].GetData()[axis] ? i : high;
+		}
+
+		double spread = (double)points[high].GetData()[axis] - (double)points[low].GetData()[axis];
+
+		if (spread > bestSpread)
+		{
+			bestSpread = spread;
+			simplex[0] = low;
+			simplex[1] = high;
+		}
+	}
+
+	if (!(bestSpread > 0.0))
+	{
+		return false;
+	}
+
+	const float* a = points[simplex[0]].GetData();
+	const float* b = points[simplex[1]].GetData();
+	double ab[3] = { (double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2] };
+	double bestArea = 0.0;
+
+	for (uint_t i : candidates)
+	{
+		const float* p = points[i].GetData();
+		double ap[3] = { (double)p[0] - a[0], (double)p[1] - a[1], (double)p[2] - a[2] };
+		double cx = ab[1] * ap[2] - ab[2] * ap[1];
+		double cy = ab[2] * ap[0] - ab[0] * ap[2];
+		double cz = ab[0] * ap[1] - ab[1] * ap[0];
+		double area = cx * cx + cy * cy + cz * cz;
+
+		if (area > bestArea)
+		{
+			bestArea = area;
+			simplex[2] = i;
+		}
+	}
+
+	if (!(bestArea > 0.0))
+	{
+		return false;
+	}
+
+	double bestVolume = 0.0;
+
+	for (uint_t i : candidates)
+	{
+		double volume = std::fabs(Orient3D(points[simplex[0]], points[simplex[1]], points[simplex[2]], points[i]));
+
+		if (volume > bestVolume)
+		{
+			bestVolume = volume;
+			simplex[3] = i;
+		}
+	}
+
+	return bestVolume > 0.0;
+}
+
+//
+// Keeps the points that are not provably inside the hull of the extreme points. The plane test
+// runs in float with a margin covering its rounding, eight points per AVX step with an early
+// out once every lane is outside some plane. Points within the margin are kept, the exact build
+// sorts them out.
+//
+static void FilterInteriorPoints(const Vector3* points, uint_t count, const std::vector<HullFace>& faces, float bound, std::vector<uint_t>& survivors)
+{
+	std::vector<HullPlane> planes;
+
+	for (const HullFace& face : faces)
+	{
+		if (!face.alive)
+		{
+			continue;
+		}
+
+		const float* a = points[face.vertices[0]].GetData();
+		const float* b = points[face.vertices[1]].GetData();
+		const float* c = points[face.vertices[2]].GetData();
+		double ab[3] = { (double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2] };
+		double ac[3] = { (double)c[0] - a[0], (double)c[1] - a[1], (double)c[2] - a[2] };
+		double nx = ab[1] * ac[2] - ab[2] * ac[1];
+		double ny = ab[2] * ac[0] - ab[0] * ac[2];
+		double nz = ab[0] * ac[1] - ab[1] * ac[0];
+		double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+
+		if (!(length > 0.0))
+		{
+			survivors.resize(count);
+
+			for (uint_t i = 0; i < count; i++)
+			{
+				survivors[i] = i;
+			}
+
+			return;
+		}
+
+		nx /= length;
+		ny /= length;
+		nz /= length;
+
+		double d = nx * a[0] + ny * a[1] + nz * a[2];
+
+		planes.push_back({ (float)nx, (float)ny, (float)nz, (float)d, 8.0f * FLT_EPSILON * (2.0f * bound + (float)std::fabs(d)) });
+	}
+
+	uint_t planeCount = (uint_t)planes.size();
+	uint_t chunkCount = (count + HULL_PREFILTER_GRAIN - 1) / HULL_PREFILTER_GRAIN;
+	std::vector<std::vector<uint_t>> chunks(chunkCount);
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t chunkBegin, uint_t chunkEnd)
+	{
+		alignas(32) float x[HULL_LANES];
+		alignas(32) float y[HULL_LANES];
+		alignas(32) float z[HULL_LANES];
+
+		for (uint_t c = chunkBegin; c < chunkEnd; c++)
+		{
+			uint_t begin = c * HULL_PREFILTER_GRAIN;
+			uint_t end = count - begin > HULL_PREFILTER_GRAIN ? begin + HULL_PREFILTER_GRAIN : count;
+			std::vector<uint_t>& kept = chunks[c];
+
+			for (uint_t block = begin; block < end; block += HULL_LANES)
+			{
+				uint_t lanes = end - block < HULL_LANES ? end - block : HULL_LANES;
+
+				LoadLanes(points, block, lanes, x, y, z);
+
+				for (uint_t i = 0; i < lanes; i += 8)
+				{
+#ifdef MATH3D_AVX
+					__m256 px = _mm256_load_ps(x + i);
+					__m256 py = _mm256_load_ps(y + i);
+					__m256 pz = _mm256_load_ps(z + i);
+					__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+					for (uint_t p = 0; p < planeCount && !_mm256_testz_ps(inside, inside); p++)
+					{
+						const HullPlane& plane = planes[p];
+						__m256 distance = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.nx), px),
+							_mm256_mul_ps(_mm256_set1_ps(plane.ny), py)), _mm256_mul_ps(_mm256_set1_ps(plane.nz), pz)), _mm256_set1_ps(plane.d));
+
+						inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_set1_ps(-plane.tolerance), _CMP_LT_OQ));
+					}
+
+					int mask = _mm256_movemask_ps(inside);
+#else
+					int mask = 0;
+
+					for (uint_t j = 0; j < 8; j++)
+					{
+						bool inside = true;
+
+						for (uint_t p = 0; p < planeCount && inside; p++)
+						{
+							const HullPlane& plane = planes[p];
+
+							inside = plane.nx * x[i + j] + plane.ny * y[i + j] + plane.nz * z[i + j] - plane.d < -plane.tolerance;
+						}
+
+						mask |= inside ? 1 << j : 0;
+					}
+#endif
+
+					for (uint_t j = 0; j < 8 && i + j < lanes; j++)
+					{
+						if ((mask & (1 << j)) == 0)
+						{
+							kept.push_back(block + i + j);
+						}
+					}
+				}
+			}
+		}
+	});
+
+	survivors.clear();
+
+	for (const std::vector<uint_t>& kept : chunks)
+	{
+		survivors.insert(survivors.end(), kept.begin(), kept.end());
+	}
+}
+
+ConvexHull::ConvexHull() : prefilteredCount(0) {}
+
+ConvexHull::ConvexHull(const Vector3* points, uint_t count) : prefilteredCount(0)
+{
+	if (count < 4)
+	{
+		throw ConvexHullDegenerate();
+	}
+
+	std::vector<uint_t> extremes;
+	std::vector<uint_t> candidates;
+	uint_t simplex[4];
+	float bound;
+	HullBuilder builder(points);
+
+	FindExtremePoints(points, count, extremes, bound);
+
+	if (FindSimplex(points, extremes, simplex))
+	{
+		builder.Build(simplex, extremes.data(), (uint_t)extremes.size());
+		FilterInteriorPoints(points, count, builder.GetFaces(), bound, candidates);
+	}
+	else
+	{
+		// The extreme points are coplanar, which a thin tilted slab can do, search them all
+		candidates.resize(count);
+
+		for (uint_t i = 0; i < count; i++)
+		{
+			candidates[i] = i;
+		}
+
+		if (!FindSimplex(points, candidates, simplex))
+		{
+			throw ConvexHullDegenerate();
+		}
+	}
+
+	this->prefilteredCount = (uint_t)candidates.size();
+	builder.Build(simplex, candidates.data(), this->prefilteredCount);
+
+	const std::vector<HullFace>& faces = builder.GetFaces();
+
+	for (const HullFace& face : faces)
+	{
+		if (face.alive)
+		{
+			this->pointIndices.insert(this->pointIndices.end(), face.vertices, face.vertices + 3);
+		}
+	}
+
+	std::sort(this->pointIndices.begin(), this->pointIndices.end());
+	this->pointIndices.erase(std::unique(this->pointIndices.begin(), this->pointIndices.end()), this->pointIndices.end());
+	this->vertices.reserve(this->pointIndices.size());
+
+	for (uint_t i : this->pointIndices)
+	{
+		this->vertices.push_back(points[i]);
+	}
+
+	for (const HullFace& face : faces)
+	{
+		if (!face.alive)
+		{
+			continue;
+		}
+
+		for (uint_t k = 0; k < 3; k++)
+		{
+			this->indices.push_back((uint_t)(std::lower_bound(this->pointIndices.begin(), this->pointIndices.end(), face.vertices[k]) -
+				this->pointIndices.begin()));
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <vector>
+
+namespace math3d
+{
+	//
+	// 3D convex hull of a point set (quickhull) as an indexed triangle mesh, faces counterclockwise
+	// seen from outside. Before the hull proper, a SIMD pass finds the extreme points along 13
+	// directions and drops every point strictly inside their hull, usually the bulk of a dense
+	// cloud. Visibility and outside set tests use the exact Orient3D predicate, so the result is a
+	// valid closed convex mesh for any float input. Coplanar hull faces stay triangulated and a
+	// point added before the corners of its face may stay on as a vertex there. Point sets are
+	// redistributed to new faces in parallel once they are large enough to pay for it. Throws
+	// ConvexHullDegenerate when the points are coplanar. BenchmarkConvexHull times cube, ball and
+	// sphere point sets.
+	//
+	class ConvexHull
+	{
+	private:
+		/* Hull vertices and the input index each one came from */
+		std::vector<Vector3> vertices;
+		std::vector<uint_t> pointIndices;
+		/* Three hull vertex indices per triangle */
+		std::vector<uint_t> indices;
+		uint_t prefilteredCount;
+
+	public:
+		ConvexHull();
+		ConvexHull(const Vector3* points, uint_t count);
+		ConvexHull(const ConvexHull& hull) = default;
+		~ConvexHull() = default;
+
+		ConvexHull& operator=(const ConvexHull& hull) = default;
+
+		/* Contiguous hull vertices, usable as is by ConvexShape::CreateHull */
+		inline const Vector3* GetVertices() const
+		{
+			return this->vertices.data();
+		}
+
+		inline uint_t GetVertexCount() const
+		{
+			return (uint_t)this->vertices.size();
+		}
+
+		inline const uint_t* GetPointIndices() const
+		{
+			return this->pointIndices.data();
+		}
+
+		inline const uint_t* GetIndices() const
+		{
+			return this->indices.data();
+		}
+
+		inline uint_t GetTriangleCount() const
+		{
+			return (uint_t)(this->indices.size() / 3);
+		}
+
+		/* Input points left after the extreme point prefilter */
+		inline uint_t GetPrefilteredCount() const
+		{
+			return this->prefilteredCount;
+		}
+	};
+}
@@ -0,0 +1,384 @@
+#include "eigen.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace math3d;
+
+static const uint_t JACOBI_SWEEPS = 5;
+static const uint_t JACOBI_LANES = 8;
+static const uint_t EIGEN_BATCH_GRAIN = 1024;
+static const uint_t OBB_CLUSTER_GRAIN = 256;
+
+namespace
+{
+	/* Symmetric matrix and accumulated rotation for N independent problems, SoA so every step vectorizes over lanes */
+	struct JacobiLanes
+	{
+		alignas(32) float a00[JACOBI_LANES];
+		alignas(32) float a01[JACOBI_LANES];
+		alignas(32) float a02[JACOBI_LANES];
+		alignas(32) float a11[JACOBI_LANES];
+		alignas(32) float a12[JACOBI_LANES];
+		alignas(32) float a22[JACOBI_LANES];
+		alignas(32) float v[9][JACOBI_LANES];
+	};
+}
+
+//
+// Annihilates a_pq with a plane rotation (Golub & Van Loan 8.5.2), r is the remaining index.
+// app, aqq, apq, arp, arq are the matrix elements, vp and vq the eigenvector columns p and q.
+//
+static inline void JacobiRotate(float* app, float* aqq, float* apq, float* arp, float* arq, float* const vp[3], float* const vq[3])
+{
+	for (uint_t i = 0; i < JACOBI_LANES; i++)
+	{
+		float offDiagonal = apq[i];
+		bool negligible = Abs(offDiagonal) < FLT_MIN;
+		float safe = negligible ? 1.0f : offDiagonal;
+
+		float theta = (aqq[i] - app[i]) / (2.0f * safe);
+		float t = (theta >= 0.0f ? 1.0f : -1.0f) / (Abs(theta) + std::sqrt(theta * theta + 1.0f));
+		t = negligible ? 0.0f : t;
+
+		float c = 1.0f / std::sqrt(t * t + 1.0f);
+		float s = t * c;
+
+		app[i] -= t * offDiagonal;
+		aqq[i] += t * offDiagonal;
+		apq[i] = negligible ? offDiagonal : 0.0f;
+
+		float rp = arp[i];
+		float rq = arq[i];
+		arp[i] = c * rp - s * rq;
+		arq[i] = s * rp + c * rq;
+
+		for (uint_t k = 0; k < 3; k++)
+		{
+			float kp = vp[k][i];
+			float kq = vq[k][i];
+			vp[k][i] = c * kp - s * kq;
+			vq[k][i] = s * kp + c * kq;
+		}
+	}
+}
+
+static void SolveJacobiLanes(JacobiLanes& lanes)
+{
+	for (uint_t k = 0; k < 9; k++)
+	{
+		for (uint_t i = 0; i < JACOBI_LANES; i++)
+		{
+			lanes.v[k][i] = (k % 4 == 0) ? 1.0f : 0.0f;
+		}
+	}
+
+	float* column0[3] = { lanes.v[0], lanes.v[3], lanes.v[6] };
+	float* column1[3] = { lanes.v[1], lanes.v[4], lanes.v[7] };
+	float* column2[3] = { lanes.v[2], lanes.v[5], lanes.v[8] };
+
+	for (uint_t sweep = 0; sweep < JACOBI_SWEEPS; sweep++)
+	{
+		JacobiRotate(lanes.a00, lanes.a11, lanes.a01, lanes.a02, lanes.a12, column0, column1);
+		JacobiRotate(lanes.a00, lanes.a22, lanes.a02, lanes.a01, lanes.a12, column0, column2);
+		JacobiRotate(lanes.a11, lanes.a22, lanes.a12, lanes.a01, lanes.a02, column1, column2);
+	}
+}
+
+/* Sorts eigenpairs of one lane in descending order and flips the last axis if needed so the basis is right handed */
+static void ExtractLane(const JacobiLanes& lanes, uint_t lane, float* eigenvalues, float* eigenvectors)
+{
+	float values[3] = { lanes.a00[lane], lanes.a11[lane], lanes.a22[lane] };
+	uint_t order[3] = { 0, 1, 2 };
+
+	if (values[order[0]] < values[order[1]]) std::swap(order[0], order[1]);
+	if (values[order[1]] < values[order[2]]) std::swap(order[1], order[2]);
+	if (values[order[0]] < values[order[1]]) std::swap(order[0], order[1]);
+
+	for (uint_t c = 0; c < 3; c++)
+	{
+		eigenvalues[c] = values[order[c]];
+
+		for (uint_t r = 0; r < 3; r++)
+		{
+			eigenvectors[r * 3 + c] = lanes.v[r * 3 + order[c]][lane];
+		}
+	}
+
+	const float* m = eigenvectors;
+	float det = m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+
+	if (det < 0.0f)
+	{
+		eigenvectors[2] = -eigenvectors[2];
+		eigenvectors[5] = -eigenvectors[5];
+		eigenvectors[8] = -eigenvectors[8];
+	}
+}
+
+static void LoadLane(JacobiLanes& lanes, uint_t lane, const Matrix3x3& matrix)
+{
+	const float* m = matrix.GetData();
+
+	lanes.a00[lane] = m[0];
+	lanes.a01[lane] = m[1];
+	lanes.a02[lane] = m[2];
+	lanes.a11[lane] = m[4];
+	lanes.a12[lane] = m[5];
+	lanes.a22[lane] = m[8];
+}
+
+static void ClearLanes(JacobiLanes& lanes)
+{
+	for (uint_t i = 0; i < JACOBI_LANES; i++)
+	{
+		lanes.a00[i] = lanes.a01[i] = lanes.a02[i] = 0.0f;
+		lanes.a11[i] = lanes.a12[i] = lanes.a22[i] = 0.0f;
+	}
+}
+
+void math3d::DecomposeSymmetric3x3(const Matrix3x3& matrix, Vector3& eigenvalues, Matrix3x3& eigenvectors)
+{
+	JacobiLanes lanes;
+
+	ClearLanes(lanes);
+	LoadLane(lanes, 0, matrix);
+	SolveJacobiLanes(lanes);
+
+	float values[3];
+	ExtractLane(lanes, 0, values, eigenvectors.GetData());
+
+	eigenvalues = Vector3(values);
+}
+
+void math3d::DecomposeSymmetric3x3(const Matrix3x3& matrix, Vector3& eigenvalues, Quaternion& rotation)
+{
+	Matrix3x3 eigenvectors;
+
+	DecomposeSymmetric3x3(matrix, eigenvalues, eigenvectors);
+	rotation = Quaternion::CreateFromRotationMatrix(eigenvectors);
+}
+
+void math3d::DecomposeSymmetric3x3(const SymmetricMatrix3Batch& matrices, uint_t count, EigenDecomposition3Batch& decompositions)
+{
+	uint_t blockCount = (count + JACOBI_LANES - 1) / JACOBI_LANES;
+
+	ParallelFor(0, blockCount, EIGEN_BATCH_GRAIN / JACOBI_LANES, [&](uint_t blockBegin, uint_t blockEnd)
+	{
+		JacobiLanes lanes;
+
+		for (uint_t block = blockBegin; block < blockEnd; block++)
+		{
+			uint_t first = block * JACOBI_LANES;
+			uint_t active = count - first < JACOBI_LANES ? count - first : JACOBI_LANES;
+
+			ClearLanes(lanes);
+
+			for (uint_t i = 0; i < active; i++)
+			{
+				lanes.a00[i] = matrices.xx[first + i];
+				lanes.a01[i] = matrices.xy[first + i];
+				lanes.a02[i] = matrices.xz[first + i];
+				lanes.a11[i] = matrices.yy[first + i];
+				lanes.a12[i] = matrices.yz[first + i];
+				lanes.a22[i] = matrices.zz[first + i];
+			}
+
+			SolveJacobiLanes(lanes);
+
+			for (uint_t i = 0; i < active; i++)
+			{
+				float values[3];
+				Matrix3x3 eigenvectors;
+
+				ExtractLane(lanes, i, values, eigenvectors.GetData());
+
+				Quaternion rotation = Quaternion::CreateFromRotationMatrix(eigenvectors);
+
+				decompositions.eigenvalue0[first + i] = values[0];
+				decompositions.eigenvalue1[first + i] = values[1];
+				decompositions.eigenvalue2[first + i] = values[2];
+				decompositions.rotationW[first + i] = (float)rotation.GetW();
+				decompositions.rotationX[first + i] = (float)rotation.GetX();
+				decompositions.rotationY[first + i] = (float)rotation.GetY();
+				decompositions.rotationZ[first + i] = (float)rotation.GetZ();
+			}
+		}
+	});
+}
+
+/* Mean and covariance upper triangle (xx, xy, xz, yy, yz, zz), accumulated in double around the first point */
+static void ComputeCovariance(const Vector3* points, uint_t count, float* mean, float* covariance)
+{
+	const float* origin = points[0].GetData();
+	double sum[3] = { 0.0, 0.0, 0.0 };
+	double products[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		const float* p = points[i].GetData();
+		double x = (double)p[0] - origin[0];
+		double y = (double)p[1] - origin[1];
+		double z = (double)p[2] - origin[2];
+
+		sum[0] += x;
+		sum[1] += y;
+		sum[2] += z;
+		products[0] += x * x;
+		products[1] += x * y;
+		products[2] += x * z;
+		products[3] += y * y;
+		products[4] += y * z;
+		products[5] += z * z;
+	}
+
+	double invCount = 1.0 / count;
+	double m[3] = { sum[0] * invCount, sum[1] * invCount, sum[2] * invCount };
+
+	mean[0] = (float)(m[0] + origin[0]);
+	mean[1] = (float)(m[1] + origin[1]);
+	mean[2] = (float)(m[2] + origin[2]);
+
+	covariance[0] = (float)(products[0] * invCount - m[0] * m[0]);
+	covariance[1] = (float)(products[1] * invCount - m[0] * m[1]);
+	covariance[2] = (float)(products[2] * invCount - m[0] * m[2]);
+	covariance[3] = (float)(products[3] * invCount - m[1] * m[1]);
+	covariance[4] = (float)(products[4] * invCount - m[1] * m[2]);
+	covariance[5] = (float)(products[5] * invCount - m[2] * m[2]);
+}
+
+/* Projects the points on the columns of axes and builds the tight box around the projections */
+static OBB FitOBBToAxes(const Vector3* points, uint_t count, const Quaternion& rotation)
+{
+	Matrix3x3 axes = rotation.GetRotationMatrix();
+	const float* m = axes.GetData();
+
+	float localMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float localMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		const float* p = points[i].GetData();
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			float projection = p[0] * m[axis] + p[1] * m[3 + axis] + p[2] * m[6 + axis];
+
+			localMin[axis] = Min(localMin[axis], projection);
+			localMax[axis] = Max(localMax[axis], projection);
+		}
+	}
+
+	float localCenter[3];
+	float halfExtents[3];
+
+	for (uint_t axis = 0; axis < 3; axis++)
+	{
+		localCenter[axis] = (localMin[axis] + localMax[axis]) * 0.5f;
+		halfExtents[axis] = (localMax[axis] - localMin[axis]) * 0.5f;
+	}
+
+	Vector3 center = CreateVector3(
+		m[0] * localCenter[0] + m[1] * localCenter[1] + m[2] * localCenter[2],
+		m[3] * localCenter[0] + m[4] * localCenter[1] + m[5] * localCenter[2],
+		m[6] * localCenter[0] + m[7] * localCenter[1] + m[8] * localCenter[2]);
+
+	return OBB(center, Vector3(halfExtents), rotation);
+}
+
+OBB math3d::FitOBB(const Vector3* points, uint_t count)
+{
+	if (count == 0)
+	{
+		return OBB();
+	}
+
+	float mean[3];
+	float covariance[6];
+
+	ComputeCovariance(points, count, mean, covariance);
+
+	float values[9] = {
+		covariance[0], covariance[1], covariance[2],
+		covariance[1], covariance[3], covariance[4],
+		covariance[2], covariance[4], covariance[5]
+	};
+
+	Vector3 eigenvalues;
+	Quaternion rotation;
+
+	DecomposeSymmetric3x3(Matrix3x3(values), eigenvalues, rotation);
+
+	return FitOBBToAxes(points, count, rotation);
+}
+
+void math3d::FitOBBs(const Vector3* points, const uint_t* clusterOffsets, uint_t clusterCount, OBB* boxes)
+{
+	std::vector<float> covariances(clusterCount * 6, 0.0f);
+	std::vector<float> rotations(clusterCount * 4);
+	std::vector<float> eigenvalues(clusterCount * 3);
+
+	uint_t n = clusterCount;
+
+	ParallelFor(0, clusterCount, OBB_CLUSTER_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t count = clusterOffsets[i + 1] - clusterOffsets[i];
+			float mean[3];
+			float covariance[6];
+
+			if (count == 0)
+			{
+				continue;
+			}
+
+			ComputeCovariance(points + clusterOffsets[i], count, mean, covariance);
+
+			for (uint_t k = 0; k < 6; k++)
+			{
+				covariances[k * n + i] = covariance[k];
+			}
+		}
+	});
+
+	SymmetricMatrix3Batch matrices;
+	matrices.xx = covariances.data();
+	matrices.xy = covariances.data() + n;
+	matrices.xz = covariances.data() + n * 2;
+	matrices.yy = covariances.data() + n * 3;
+	matrices.yz = covariances.data() + n * 4;
+	matrices.zz = covariances.data() + n * 5;
+
+	EigenDecomposition3Batch decompositions;
+	decompositions.eigenvalue0 = eigenvalues.data();
+	decompositions.eigenvalue1 = eigenvalues.data() + n;
+	decompositions.eigenvalue2 = eigenvalues.data() + n * 2;
+	decompositions.rotationW = rotations.data();
+	decompositions.rotationX = rotations.data() + n;
+	decompositions.rotationY = rotations.data() + n * 2;
+	decompositions.rotationZ = rotations.data() + n * 3;
+
+	DecomposeSymmetric3x3(matrices, clusterCount, decompositions);
+
+	ParallelFor(0, clusterCount, OBB_CLUSTER_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t count = clusterOffsets[i + 1] - clusterOffsets[i];
+
+			if (count == 0)
+			{
+				boxes[i] = OBB();
+				continue;
+			}
+
+			Quaternion rotation(rotations[i], rotations[n + i], rotations[n * 2 + i], rotations[n * 3 + i]);
+
+			boxes[i] = FitOBBToAxes(points + clusterOffsets[i], count, rotation);
+		}
+	});
+}
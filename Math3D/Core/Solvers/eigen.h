@@ -0,0 +1,45 @@
+#pragma once
+#include "geometry.h"
+#include "quaternion.h"
+
+namespace math3d
+{
+	/* Upper triangle of many symmetric 3x3 matrices, one array per element */
+	struct SymmetricMatrix3Batch
+	{
+		const float* xx;
+		const float* xy;
+		const float* xz;
+		const float* yy;
+		const float* yz;
+		const float* zz;
+	};
+
+	/* Eigenvalues (descending) and the eigenvector rotation as a unit quaternion, one array per component */
+	struct EigenDecomposition3Batch
+	{
+		float* eigenvalue0;
+		float* eigenvalue1;
+		float* eigenvalue2;
+		float* rotationW;
+		float* rotationX;
+		float* rotationY;
+		float* rotationZ;
+	};
+
+	//
+	// Cyclic Jacobi with a fixed number of sweeps, no data dependent branches.
+	// Eigenvalues are sorted in descending order, eigenvectors are the columns of
+	// the returned rotation which is always proper (determinant +1).
+	// Only the upper triangle of the input is read.
+	//
+	void DecomposeSymmetric3x3(const Matrix3x3& matrix, Vector3& eigenvalues, Matrix3x3& eigenvectors);
+	void DecomposeSymmetric3x3(const Matrix3x3& matrix, Vector3& eigenvalues, Quaternion& rotation);
+	void DecomposeSymmetric3x3(const SymmetricMatrix3Batch& matrices, uint_t count, EigenDecomposition3Batch& decompositions);
+
+	/* Box aligned with the principal axes of the point covariance */
+	OBB FitOBB(const Vector3* points, uint_t count);
+
+	/* Cluster i spans points [clusterOffsets[i], clusterOffsets[i + 1]), clusters are fitted in parallel */
+	void FitOBBs(const Vector3* points, const uint_t* clusterOffsets, uint_t clusterCount, OBB* boxes);
+}
@@ -0,0 +1,1025 @@
+#include "gjk.h"
+#include "math3dparallel.h"
+#include "math3dutil.h"
+#include <cfloat>
+#include <cmath>
+
+using namespace math3d;
+
+static const uint_t GJK_MAX_ITERATIONS = 64;
+static const float GJK_RELATIVE_TOLERANCE = 1e-6f;
+static const float GJK_OVERLAP_TOLERANCE = 1e-12f;
+static const float GJK_FLAT_TOLERANCE = 1e-10f;
+static const uint_t EPA_MAX_ITERATIONS = 64;
+static const uint_t EPA_MAX_VERTICES = EPA_MAX_ITERATIONS + 4;
+static const uint_t EPA_MAX_FACES = 256;
+static const float EPA_TOLERANCE = 1e-4f;
+static const uint_t CONTACT_PAIR_GRAIN = 64;
+
+namespace
+{
+	/* Minkowski difference vertex w = a - b with the support points that produced it */
+	struct SimplexVertex
+	{
+		float w[3];
+		float a[3];
+		float b[3];
+	};
+
+	struct Simplex
+	{
+		SimplexVertex vertices[4];
+		float weights[4];
+		uint_t count;
+	};
+
+	struct EPAFace
+	{
+		uint_t vertices[3];
+		float normal[3];
+		float distance;
+	};
+}
+
+static inline float Dot3(const float* a, const float* b)
+{
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline void Cross3(const float* a, const float* b, float* result)
+{
+	result[0] = a[1] * b[2] - a[2] * b[1];
+	result[1] = a[2] * b[0] - a[0] * b[2];
+	result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline void Subtract3(const float* a, const float* b, float* result)
+{
+	result[0] = a[0] - b[0];
+	result[1] = a[1] - b[1];
+	result[2] = a[2] - b[2];
+}
+
+static void SupportShape(const ConvexShape& shape, const float* direction, bool margin, float* point)
+{
+	shape.SupportCore(direction, point);
+
+	float lengthSquared = Dot3(direction, direction);
+
+	if (margin && shape.GetRadius() > 0.0f && lengthSquared > 0.0f)
+	{
+		float scale = shape.GetRadius() / std::sqrt(lengthSquared);
+
+		point[0] += direction[0] * scale;
+		point[1] += direction[1] * scale;
+		point[2] += direction[2] * scale;
+	}
+}
+
+/* Support of A - B along direction */
+static void SupportPair(const ConvexShape& shapeA, const ConvexShape& shapeB, const float* direction, bool margins, SimplexVertex& vertex)
+{
+	float opposite[3] = { -direction[0], -direction[1], -direction[2] };
+
+	SupportShape(shapeA, direction, margins, vertex.a);
+	SupportShape(shapeB, opposite, margins, vertex.b);
+	Subtract3(vertex.a, vertex.b, vertex.w);
+}
+
+static void SetSimplex1(Simplex& simplex, const SimplexVertex& a)
+{
+	simplex.vertices[0] = a;
+	simplex.weights[0] = 1.0f;
+	simplex.count = 1;
+}
+
+static void SetSimplex2(Simplex& simplex, const SimplexVertex& a, const SimplexVertex& b, float t)
+{
+	simplex.vertices[0] = a;
+	simplex.vertices[1] = b;
+	simplex.weights[0] = 1.0f - t;
+	simplex.weights[1] = t;
+	simplex.count = 2;
+}
+
+//
+// Closest point of a triangle to the origin by Voronoi regions (Ericson, Real-Time Collision
+// Detection 5.1.5), the simplex is reduced to the feature that contains it.
+//
+static void SolveTriangle(Simplex& simplex, const SimplexVertex& a, const SimplexVertex& b, const SimplexVertex& c)
+{
+	float ab[3];
+	float ac[3];
+	float ap[3] = { -a.w[0], -a.w[1], -a.w[2] };
+
+	Subtract3(b.w, a.w, ab);
+	Subtract3(c.w, a.w, ac);
+
+	float d1 = Dot3(ab, ap);
+	float d2 = Dot3(ac, ap);
+
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+		SetSimplex1(simplex, a);
+
+		return;
+	}
+
+	float bp[3] = { -b.w[0], -b.w[1], -b.w[2] };
+	float d3 = Dot3(ab, bp);
+	float d4 = Dot3(ac, bp);
+
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		SetSimplex1(simplex, b);
+
+		return;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		SetSimplex2(simplex, a, b, d1 / (d1 - d3));
+
+		return;
+	}
+
+	float cp[3] = { -c.w[0], -c.w[1], -c.w[2] };
+	float d5 = Dot3(ab, cp);
+	float d6 = Dot3(ac, cp);
+
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		SetSimplex1(simplex, c);
+
+		return;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		SetSimplex2(simplex, a, c, d2 / (d2 - d6));
+
+		return;
+	}
+
+	float va = d3 * d6 - d5 * d4;
+
+	if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+	{
+		SetSimplex2(simplex, b, c, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		return;
+	}
+
+	float denominator = 1.0f / (va + vb + vc);
+	float v = vb * denominator;
+	float w = vc * denominator;
+
+	simplex.vertices[0] = a;
+	simplex.vertices[1] = b;
+	simplex.vertices[2] = c;
+	simplex.weights[0] = 1.0f - v - w;
+	simplex.weights[1] = v;
+	simplex.weights[2] = w;
+	simplex.count = 3;
+}
+
+static void GetSimplexPoint(const Simplex& simplex, float* point)
+{
+	//
+	// Near the origin the barycentric sum cancels and its direction turns into noise, the
+	// plane distance along the face normal keeps the search direction exact.
+	//
+	if (simplex.count == 3)
+	{
+		const float* a = simplex.vertices[0].w;
+		float ab[3];
+		float ac[3];
+		float normal[3];
+
+		Subtract3(simplex.vertices[1].w, a, ab);
+		Subtract3(simplex.vertices[2].w, a, ac);
+		Cross3(ab, ac, normal);
+
+		float lengthSquared = Dot3(normal, normal);
+
+		if (lengthSquared > FLT_MIN)
+		{
+			float scale = Dot3(normal, a) / lengthSquared;
+
+			point[0] = normal[0] * scale;
+			point[1] = normal[1] * scale;
+			point[2] = normal[2] * scale;
+
+			return;
+		}
+	}
+
+	point[0] = 0.0f;
+	point[1] = 0.0f;
+	point[2] = 0.0f;
+
+	for (uint_t i = 0; i < simplex.count; i++)
+	{
+		point[0] += simplex.weights[i] * simplex.vertices[i].w[0];
+		point[1] += simplex.weights[i] * simplex.vertices[i].w[1];
+		point[2] += simplex.weights[i] * simplex.vertices[i].w[2];
+	}
+}
+
+/* Reduces the simplex to the feature closest to the origin, returns true when the origin is inside the tetrahedron */
+static bool SolveSimplex(Simplex& simplex)
+{
+	const Simplex source = simplex;
+	const SimplexVertex* v = source.vertices;
+
+	if (source.count == 2)
+	{
+		float ab[3];
+
+		Subtract3(v[1].w, v[0].w, ab);
+
+		float lengthSquared = Dot3(ab, ab);
+		float t = lengthSquared > 0.0f ? -Dot3(v[0].w, ab) / lengthSquared : 0.0f;
+
+		if (t <= 0.0f)
+		{
+			SetSimplex1(simplex, v[0]);
+		}
+		else if (t >= 1.0f)
+		{
+			SetSimplex1(simplex, v[1]);
+		}
+		else
+		{
+			SetSimplex2(simplex, v[0], v[1], t);
+		}
+
+		return false;
+	}
+
+	if (source.count == 3)
+	{
+		SolveTriangle(simplex, v[0], v[1], v[2]);
+
+		return false;
+	}
+
+	// Tetrahedron, only faces with the origin on the side opposite to the fourth vertex can hold the closest point
+	static const uint_t faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+	float bestDistanceSquared = FLT_MAX;
+	bool outside = false;
+
+	for (uint_t f = 0; f < 4; f++)
+	{
+		const SimplexVertex& a = v[faces[f][0]];
+		const SimplexVertex& b = v[faces[f][1]];
+		const SimplexVertex& c = v[faces[f][2]];
+		const SimplexVertex& d = v[faces[f][3]];
+		float ab[3];
+		float ac[3];
+		float ad[3];
+		float normal[3];
+
+		Subtract3(b.w, a.w, ab);
+		Subtract3(c.w, a.w, ac);
+		Subtract3(d.w, a.w, ad);
+		Cross3(ab, ac, normal);
+
+		float originSide = -Dot3(normal, a.w);
+		float vertexSide = Dot3(normal, ad);
+
+		// A flat tetrahedron cannot enclose the origin, all its faces stay candidates
+		if (originSide * vertexSide > 0.0f && vertexSide * vertexSide > GJK_FLAT_TOLERANCE * Dot3(normal, normal) * Dot3(ad, ad))
+		{
+			continue;
+		}
+
+		Simplex candidate;
+		float point[3];
+
+		outside = true;
+		SolveTriangle(candidate, a, b, c);
+		GetSimplexPoint(candidate, point);
+
+		float distanceSquared = Dot3(point, point);
+
+		if (distanceSquared < bestDistanceSquared)
+		{
+			bestDistanceSquared = distanceSquared;
+			simplex = candidate;
+		}
+	}
+
+	return !outside;
+}
+
+//
+// GJK on the cores. With earlyOutDistance >= 0 the search stops as soon as a separating
+// plane proves the cores further apart than that, returns false in that case.
+//
+static bool RunGJK(const ConvexShape& shapeA, const ConvexShape& shapeB, const GJKCache* cache, float earlyOutDistance, Simplex& simplex, float* v, bool& overlap, uint_t& iterations)
+{
+	float direction[3];
+
+	if (cache != nullptr && cache->valid)
+	{
+		direction[0] = cache->direction[0];
+		direction[1] = cache->direction[1];
+		direction[2] = cache->direction[2];
+	}
+	else
+	{
+		Vector3 offset = shapeB.GetPosition() - shapeA.GetPosition();
+		const float* o = offset.GetData();
+
+		direction[0] = o[0];
+		direction[1] = o[1];
+		direction[2] = o[2];
+
+		if (Dot3(direction, direction) == 0.0f)
+		{
+			direction[0] = 1.0f;
+		}
+	}
+
+	SimplexVertex vertex;
+
+	SupportPair(shapeA, shapeB, direction, false, vertex);
+	SetSimplex1(simplex, vertex);
+
+	v[0] = vertex.w[0];
+	v[1] = vertex.w[1];
+	v[2] = vertex.w[2];
+	overlap = false;
+
+	for (iterations = 1; iterations <= GJK_MAX_ITERATIONS; iterations++)
+	{
+		float distanceSquared = Dot3(v, v);
+
+		if (distanceSquared <= GJK_OVERLAP_TOLERANCE)
+		{
+			overlap = true;
+
+			break;
+		}
+
+		float search[3] = { -v[0], -v[1], -v[2] };
+
+		SupportPair(shapeA, shapeB, search, false, vertex);
+
+		float progress = Dot3(v, vertex.w);
+
+		if (earlyOutDistance >= 0.0f && progress > 0.0f && progress * progress > earlyOutDistance * earlyOutDistance * distanceSquared)
+		{
+			return false;
+		}
+
+		// No support point closer than the current estimate, v is the closest point
+		if (distanceSquared - progress <= GJK_RELATIVE_TOLERANCE * distanceSquared)
+		{
+			break;
+		}
+
+		bool duplicate = false;
+
+		for (uint_t i = 0; i < simplex.count; i++)
+		{
+			const float* w = simplex.vertices[i].w;
+
+			duplicate = duplicate || (w[0] == vertex.w[0] && w[1] == vertex.w[1] && w[2] == vertex.w[2]);
+		}
+
+		if (duplicate)
+		{
+			break;
+		}
+
+		simplex.vertices[simplex.count++] = vertex;
+
+		if (SolveSimplex(simplex))
+		{
+			overlap = true;
+
+			break;
+		}
+
+		float previousDistanceSquared = distanceSquared;
+
+		GetSimplexPoint(simplex, v);
+
+		if (Dot3(v, v) >= previousDistanceSquared)
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+static bool AddEPAFace(EPAFace* faces, uint_t& faceCount, const SimplexVertex* vertices, uint_t a, uint_t b, uint_t c)
+{
+	if (faceCount == EPA_MAX_FACES)
+	{
+		return false;
+	}
+
+	EPAFace& face = faces[faceCount++];
+	float ab[3];
+	float ac[3];
+
+	face.vertices[0] = a;
+	face.vertices[1] = b;
+	face.vertices[2] = c;
+
+	Subtract3(vertices[b].w, vertices[a].w, ab);
+	Subtract3(vertices[c].w, vertices[a].w, ac);
+	Cross3(ab, ac, face.normal);
+
+	float length = std::sqrt(Dot3(face.normal, face.normal));
+
+	// Slivers keep the polytope closed but are never picked as the closest face
+	if (length <= FLT_MIN)
+	{
+		face.distance = FLT_MAX;
+
+		return true;
+	}
+
+	face.normal[0] /= length;
+	face.normal[1] /= length;
+	face.normal[2] /= length;
+	face.distance = Dot3(face.normal, vertices[a].w);
+
+	return true;
+}
+
+/* Grows a GJK simplex that reached the origin to a tetrahedron, false when the difference is flat */
+static bool BlowUpSimplex(const ConvexShape& shapeA, const ConvexShape& shapeB, bool margins, Simplex& simplex)
+{
+	static const float axes[6][3] = { { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } };
+	SimplexVertex* v = simplex.vertices;
+	SimplexVertex vertex;
+	float edge[3];
+
+	if (simplex.count == 1)
+	{
+		for (uint_t i = 0; i < 6 && simplex.count == 1; i++)
+		{
+			SupportPair(shapeA, shapeB, axes[i], margins, vertex);
+			Subtract3(vertex.w, v[0].w, edge);
+
+			if (Dot3(edge, edge) > GJK_OVERLAP_TOLERANCE)
+			{
+				v[simplex.count++] = vertex;
+			}
+		}
+	}
+
+	if (simplex.count == 2)
+	{
+		float line[3];
+
+		Subtract3(v[1].w, v[0].w, line);
+
+		// Directions perpendicular to the segment, the first from its least aligned axis
+		uint_t axis = Abs(line[0]) < Abs(line[1]) ? (Abs(line[0]) < Abs(line[2]) ? 0 : 2) : (Abs(line[1]) < Abs(line[2]) ? 1 : 2);
+		float directions[4][3];
+
+		Cross3(line, axes[axis * 2], directions[0]);
+		Cross3(line, directions[0], directions[1]);
+
+		for (uint_t i = 0; i < 3; i++)
+		{
+			directions[2][i] = -directions[0][i];
+			directions[3][i] = -directions[1][i];
+		}
+
+		for (uint_t i = 0; i < 4 && simplex.count == 2; i++)
+		{
+			float normal[3];
+
+			SupportPair(shapeA, shapeB, directions[i], margins, vertex);
+			Subtract3(vertex.w, v[0].w, edge);
+			Cross3(line, edge, normal);
+
+			if (Dot3(normal, normal) > GJK_OVERLAP_TOLERANCE)
+			{
+				v[simplex.count++] = vertex;
+			}
+		}
+	}
+
+	if (simplex.count == 3)
+	{
+		float ab[3];
+		float ac[3];
+		float normal[3];
+
+		Subtract3(v[1].w, v[0].w, ab);
+		Subtract3(v[2].w, v[0].w, ac);
+		Cross3(ab, ac, normal);
+
+		for (uint_t i = 0; i < 2 && simplex.count == 3; i++)
+		{
+			SupportPair(shapeA, shapeB, normal, margins, vertex);
+			Subtract3(vertex.w, v[0].w, edge);
+
+			if (Abs(Dot3(normal, edge)) > GJK_OVERLAP_TOLERANCE)
+			{
+				v[simplex.count++] = vertex;
+			}
+
+			normal[0] = -normal[0];
+			normal[1] = -normal[1];
+			normal[2] = -normal[2];
+		}
+	}
+
+	return simplex.count == 4;
+}
+
+//
+// Expanding polytope, starting from a tetrahedron around the origin. Faces seen from each
+// new support point are removed and the hole is closed with a fan to the new point.
+//
+static void RunEPA(const ConvexShape& shapeA, const ConvexShape& shapeB, bool margins, const Simplex& simplex, ConvexContact& contact)
+{
+	SimplexVertex vertices[EPA_MAX_VERTICES];
+	EPAFace faces[EPA_MAX_FACES];
+	uint_t horizon[EPA_MAX_FACES * 3][2];
+	uint_t vertexCount = 4;
+	uint_t faceCount = 0;
+
+	for (uint_t i = 0; i < 4; i++)
+	{
+		vertices[i] = simplex.vertices[i];
+	}
+
+	static const uint_t tetrahedron[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+
+	for (uint_t f = 0; f < 4; f++)
+	{
+		uint_t a = tetrahedron[f][0];
+		uint_t b = tetrahedron[f][1];
+		uint_t c = tetrahedron[f][2];
+		float ab[3];
+		float ac[3];
+		float ad[3];
+		float normal[3];
+
+		Subtract3(vertices[b].w, vertices[a].w, ab);
+		Subtract3(vertices[c].w, vertices[a].w, ac);
+		Subtract3(vertices[tetrahedron[f][3]].w, vertices[a].w, ad);
+		Cross3(ab, ac, normal);
+
+		// Wind every face so its normal points away from the opposite vertex
+		if (Dot3(normal, ad) > 0.0f)
+		{
+			AddEPAFace(faces, faceCount, vertices, a, c, b);
+		}
+		else
+		{
+			AddEPAFace(faces, faceCount, vertices, a, b, c);
+		}
+	}
+
+	uint_t closest = 0;
+
+	for (uint_t iteration = 0; iteration < EPA_MAX_ITERATIONS; iteration++)
+	{
+		closest = 0;
+
+		for (uint_t f = 1; f < faceCount; f++)
+		{
+			if (faces[f].distance < faces[closest].distance)
+			{
+				closest = f;
+			}
+		}
+
+		const EPAFace& face = faces[closest];
+
+		if (vertexCount == EPA_MAX_VERTICES || face.distance == FLT_MAX)
+		{
+			break;
+		}
+
+		SimplexVertex& vertex = vertices[vertexCount];
+
+		SupportPair(shapeA, shapeB, face.normal, margins, vertex);
+
+		float reach = Dot3(face.normal, vertex.w);
+
+		if (reach - face.distance <= EPA_TOLERANCE * Max(1.0f, reach))
+		{
+			break;
+		}
+
+		uint_t added = vertexCount++;
+		uint_t horizonCount = 0;
+		uint_t kept = 0;
+
+		for (uint_t f = 0; f < faceCount; f++)
+		{
+			float offset[3];
+
+			Subtract3(vertex.w, vertices[faces[f].vertices[0]].w, offset);
+
+			if (faces[f].distance == FLT_MAX || Dot3(faces[f].normal, offset) <= 0.0f)
+			{
+				faces[kept++] = faces[f];
+
+				continue;
+			}
+
+			// Edges shared by two visible faces cancel out, the rest form the horizon
+			for (uint_t e = 0; e < 3; e++)
+			{
+				uint_t from = faces[f].vertices[e];
+				uint_t to = faces[f].vertices[(e + 1) % 3];
+				bool shared = false;
+
+				for (uint_t h = 0; h < horizonCount; h++)
+				{
+					if (horizon[h][0] == to && horizon[h][1] == from)
+					{
+						horizon[h][0] = horizon[horizonCount - 1][0];
+						horizon[h][1] = horizon[horizonCount - 1][1];
+						horizonCount--;
+						shared = true;
+
+						break;
+					}
+				}
+
+				if (!shared)
+				{
+					horizon[horizonCount][0] = from;
+					horizon[horizonCount][1] = to;
+					horizonCount++;
+				}
+			}
+		}
+
+		faceCount = kept;
+
+		bool full = false;
+
+		for (uint_t h = 0; h < horizonCount && !full; h++)
+		{
+			full = !AddEPAFace(faces, faceCount, vertices, horizon[h][0], horizon[h][1], added);
+		}
+
+		if (full)
+		{
+			break;
+		}
+	}
+
+	closest = 0;
+
+	for (uint_t f = 1; f < faceCount; f++)
+	{
+		if (faces[f].distance < faces[closest].distance)
+		{
+			closest = f;
+		}
+	}
+
+	const EPAFace& face = faces[closest];
+	const SimplexVertex& a = vertices[face.vertices[0]];
+	const SimplexVertex& b = vertices[face.vertices[1]];
+	const SimplexVertex& c = vertices[face.vertices[2]];
+	float depth = face.distance == FLT_MAX ? 0.0f : face.distance;
+
+	// Barycentric coordinates of the origin projected on the face give the witness points
+	float projection[3] = { face.normal[0] * depth, face.normal[1] * depth, face.normal[2] * depth };
+	float ab[3];
+	float ac[3];
+	float ap[3];
+	float cross[3];
+
+	Subtract3(b.w, a.w, ab);
+	Subtract3(c.w, a.w, ac);
+	Subtract3(projection, a.w, ap);
+	Cross3(ab, ac, cross);
+
+	float area = Dot3(cross, cross);
+	float u = 0.0f;
+	float w = 0.0f;
+
+	if (area > 0.0f)
+	{
+		float temp[3];
+
+		Cross3(ap, ac, temp);
+		u = Dot3(temp, cross) / area;
+		Cross3(ab, ap, temp);
+		w = Dot3(temp, cross) / area;
+	}
+
+	float t = 1.0f - u - w;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		contact.pointA[i] = t * a.a[i] + u * b.a[i] + w * c.a[i];
+		contact.pointB[i] = t * a.b[i] + u * b.b[i] + w * c.b[i];
+		contact.normal[i] = face.normal[i];
+	}
+
+	contact.distance = -depth;
+}
+
+ConvexShape::ConvexShape() : type(CONVEX_SPHERE), position{ 0.0f, 0.0f, 0.0f }, axes{ 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f }, extents{ 0.0f, 0.0f, 0.0f }, radius(0.0f), hullPoints(nullptr), hullCount(0) {}
+
+void ConvexShape::SupportCore(const float* direction, float* point) const
+{
+	const float* m = this->axes;
+	const float* p = this->position;
+
+	// Direction in the local frame, columns of axes are the local axes
+	float local[3];
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		local[i] = direction[0] * m[i] + direction[1] * m[3 + i] + direction[2] * m[6 + i];
+	}
+
+	float corner[3] = { 0.0f, 0.0f, 0.0f };
+
+	switch (this->type)
+	{
+	case CONVEX_SPHERE:
+		break;
+	case CONVEX_BOX:
+		for (uint_t i = 0; i < 3; i++)
+		{
+			corner[i] = local[i] >= 0.0f ? this->extents[i] : -this->extents[i];
+		}
+		break;
+	case CONVEX_CAPSULE:
+		corner[1] = local[1] >= 0.0f ? this->extents[1] : -this->extents[1];
+		break;
+	case CONVEX_HULL:
+	{
+		float best = -FLT_MAX;
+
+		for (uint_t i = 0; i < this->hullCount; i++)
+		{
+			const float* h = this->hullPoints[i].GetData();
+			float projection = h[0] * local[0] + h[1] * local[1] + h[2] * local[2];
+
+			if (projection > best)
+			{
+				best = projection;
+				corner[0] = h[0];
+				corner[1] = h[1];
+				corner[2] = h[2];
+			}
+		}
+		break;
+	}
+	}
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		point[i] = p[i] + m[i * 3] * corner[0] + m[i * 3 + 1] * corner[1] + m[i * 3 + 2] * corner[2];
+	}
+}
+
+Vector3 ConvexShape::Support(const Vector3& direction) const
+{
+	float point[3];
+
+	SupportShape(*this, direction.GetData(), true, point);
+
+	return Vector3(point);
+}
+
+void ConvexShape::SetTransform(const Vector3& position, const Quaternion& orientation)
+{
+	Matrix3x3 rotation = orientation.GetRotationMatrix();
+	const float* m = rotation.GetData();
+	const float* p = position.GetData();
+
+	for (uint_t i = 0; i < 9; i++)
+	{
+		this->axes[i] = m[i];
+	}
+
+	this->position[0] = p[0];
+	this->position[1] = p[1];
+	this->position[2] = p[2];
+}
+
+ConvexShape ConvexShape::CreateSphere(const Sphere& sphere)
+{
+	ConvexShape ret;
+	const float* c = sphere.GetCenter().GetData();
+
+	ret.type = CONVEX_SPHERE;
+	ret.position[0] = c[0];
+	ret.position[1] = c[1];
+	ret.position[2] = c[2];
+	ret.radius = sphere.GetRadius();
+
+	return ret;
+}
+
+ConvexShape ConvexShape::CreateBox(const OBB& box)
+{
+	ConvexShape ret;
+	const float* e = box.GetHalfExtents().GetData();
+
+	ret.type = CONVEX_BOX;
+	ret.SetTransform(box.GetCenter(), box.GetOrientation());
+	ret.extents[0] = e[0];
+	ret.extents[1] = e[1];
+	ret.extents[2] = e[2];
+
+	return ret;
+}
+
+ConvexShape ConvexShape::CreateCapsule(const Vector3& pointA, const Vector3& pointB, float radius)
+{
+	ConvexShape ret;
+	const float* a = pointA.GetData();
+	const float* b = pointB.GetData();
+	float segment[3];
+
+	Subtract3(b, a, segment);
+
+	float length = std::sqrt(Dot3(segment, segment));
+
+	ret.type = CONVEX_CAPSULE;
+	ret.radius = radius;
+	ret.extents[1] = 0.5f * length;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		ret.position[i] = 0.5f * (a[i] + b[i]);
+	}
+
+	if (length > 0.0f)
+	{
+		// Orthonormal frame with the segment as local y
+		float y[3] = { segment[0] / length, segment[1] / length, segment[2] / length };
+		float helper[3] = { 0.0f, 0.0f, 0.0f };
+		float x[3];
+		float z[3];
+
+		helper[Abs(y[0]) < 0.9f ? 0 : 2] = 1.0f;
+		Cross3(y, helper, x);
+
+		float xLength = std::sqrt(Dot3(x, x));
+
+		x[0] /= xLength;
+		x[1] /= xLength;
+		x[2] /= xLength;
+		Cross3(x, y, z);
+
+		for (uint_t i = 0; i < 3; i++)
+		{
+			ret.axes[i * 3] = x[i];
+			ret.axes[i * 3 + 1] = y[i];
+			ret.axes[i * 3 + 2] = z[i];
+		}
+	}
+
+	return ret;
+}
+
+ConvexShape ConvexShape::CreateHull(const Vector3* points, uint_t count, const Vector3& position, const Quaternion& orientation)
+{
+	ConvexShape ret;
+
+	ret.type = CONVEX_HULL;
+	ret.hullPoints = points;
+	ret.hullCount = count;
+	ret.SetTransform(position, orientation);
+
+	return ret;
+}
+
+bool math3d::IntersectConvex(const ConvexShape& shapeA, const ConvexShape& shapeB, GJKCache* cache)
+{
+	Simplex simplex;
+	float v[3];
+	bool overlap;
+	uint_t iterations;
+	float margin = shapeA.GetRadius() + shapeB.GetRadius();
+
+	bool finished = RunGJK(shapeA, shapeB, cache, margin, simplex, v, overlap, iterations);
+	float distanceSquared = Dot3(v, v);
+
+	if (cache != nullptr && distanceSquared > 0.0f)
+	{
+		float scale = -1.0f / std::sqrt(distanceSquared);
+
+		cache->direction[0] = v[0] * scale;
+		cache->direction[1] = v[1] * scale;
+		cache->direction[2] = v[2] * scale;
+		cache->valid = true;
+	}
+
+	return finished && (overlap || distanceSquared <= margin * margin);
+}
+
+bool math3d::ComputeConvexContact(const ConvexShape& shapeA, const ConvexShape& shapeB, ConvexContact& contact, GJKCache* cache)
+{
+	Simplex simplex;
+	float v[3];
+	bool overlap;
+	uint_t iterations;
+
+	RunGJK(shapeA, shapeB, cache, -1.0f, simplex, v, overlap, iterations);
+
+	contact.iterations = iterations;
+
+	if (!overlap)
+	{
+		// Separated cores, closest points of the cores pushed out by the radii
+		float distance = std::sqrt(Dot3(v, v));
+		float normal[3] = { -v[0] / distance, -v[1] / distance, -v[2] / distance };
+		float radiusA = shapeA.GetRadius();
+		float radiusB = shapeB.GetRadius();
+
+		contact.distance = distance - radiusA - radiusB;
+
+		for (uint_t i = 0; i < 3; i++)
+		{
+			float pointA = 0.0f;
+			float pointB = 0.0f;
+
+			for (uint_t j = 0; j < simplex.count; j++)
+			{
+				pointA += simplex.weights[j] * simplex.vertices[j].a[i];
+				pointB += simplex.weights[j] * simplex.vertices[j].b[i];
+			}
+
+			contact.normal[i] = normal[i];
+			contact.pointA[i] = pointA + normal[i] * radiusA;
+			contact.pointB[i] = pointB - normal[i] * radiusB;
+		}
+	}
+	else if (BlowUpSimplex(shapeA, shapeB, false, simplex))
+	{
+		// Penetration of the cores grown by the radii, exact for polyhedral cores
+		float radiusA = shapeA.GetRadius();
+		float radiusB = shapeB.GetRadius();
+
+		RunEPA(shapeA, shapeB, false, simplex, contact);
+
+		contact.distance -= radiusA + radiusB;
+
+		for (uint_t i = 0; i < 3; i++)
+		{
+			contact.pointA[i] += contact.normal[i] * radiusA;
+			contact.pointB[i] -= contact.normal[i] * radiusB;
+		}
+	}
+	else if (BlowUpSimplex(shapeA, shapeB, true, simplex))
+	{
+		// Flat core difference (points, segments), the rounded shapes give it a volume
+		RunEPA(shapeA, shapeB, true, simplex, contact);
+	}
+	else
+	{
+		// Flat Minkowski difference (degenerate hulls), report touching along the last direction
+		const float* d = cache != nullptr && cache->valid ? cache->direction : nullptr;
+
+		contact.distance = 0.0f;
+
+		for (uint_t i = 0; i < 3; i++)
+		{
+			contact.normal[i] = d != nullptr ? d[i] : (i == 0 ? 1.0f : 0.0f);
+			contact.pointA[i] = simplex.vertices[0].a[i];
+			contact.pointB[i] = simplex.vertices[0].b[i];
+		}
+	}
+
+	if (cache != nullptr)
+	{
+		cache->direction[0] = contact.normal[0];
+		cache->direction[1] = contact.normal[1];
+		cache->direction[2] = contact.normal[2];
+		cache->valid = true;
+	}
+
+	return contact.distance < 0.0f;
+}
+
+void math3d::ComputeConvexContacts(const ConvexShape* shapes, const uint_t* pairs, uint_t pairCount, ConvexContact* contacts, GJKCache* caches)
+{
+	ParallelFor(0, pairCount, CONTACT_PAIR_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			ComputeConvexContact(shapes[pairs[i * 2]], shapes[pairs[i * 2 + 1]], contacts[i], caches != nullptr ? caches + i : nullptr);
+		}
+	});
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "geometry.h"
+
+namespace math3d
+{
+	enum ConvexShapeType
+	{
+		CONVEX_SPHERE,
+		CONVEX_BOX,
+		CONVEX_CAPSULE,
+		CONVEX_HULL
+	};
+
+	//
+	// Convex shape described by its support function. Every shape is a core (point, segment,
+	// box or point hull) grown by a radius, GJK runs on the cores and the radii are applied
+	// afterwards, so spheres and capsules converge in a couple of iterations.
+	// Hull points are referenced, not copied, and are given in the local frame of the shape.
+	//
+	class ConvexShape
+	{
+	private:
+		ConvexShapeType type;
+		float position[3];
+		/* Columns are the local axes in world space, row major */
+		float axes[9];
+		/* Box half extents, capsule half segment length along local y in extents[1] */
+		float extents[3];
+		float radius;
+		const Vector3* hullPoints;
+		uint_t hullCount;
+
+	public:
+		ConvexShape();
+		ConvexShape(const ConvexShape& shape) = default;
+		~ConvexShape() = default;
+
+		/* Farthest point of the core along direction, in world space */
+		void SupportCore(const float* direction, float* point) const;
+
+		/* Farthest point of the shape (core and radius) along direction */
+		Vector3 Support(const Vector3& direction) const;
+
+		void SetTransform(const Vector3& position, const Quaternion& orientation);
+
+		static ConvexShape CreateSphere(const Sphere& sphere);
+		static ConvexShape CreateBox(const OBB& box);
+		static ConvexShape CreateCapsule(const Vector3& pointA, const Vector3& pointB, float radius);
+		static ConvexShape CreateHull(const Vector3* points, uint_t count, const Vector3& position, const Quaternion& orientation);
+
+		ConvexShape& operator=(const ConvexShape& shape) = default;
+
+		inline ConvexShapeType GetType() const
+		{
+			return this->type;
+		}
+
+		inline float GetRadius() const
+		{
+			return this->radius;
+		}
+
+		inline Vector3 GetPosition() const
+		{
+			return Vector3(this->position);
+		}
+	};
+
+	struct ConvexContact
+	{
+		/* Separation along the normal, negative when the shapes overlap (penetration depth) */
+		float distance;
+		/* Unit direction from shape A to shape B */
+		float normal[3];
+		/* Closest points when separated, deepest points when overlapping */
+		float pointA[3];
+		float pointB[3];
+		uint_t iterations;
+	};
+
+	//
+	// Per pair state carried between frames. The search direction of the previous result
+	// seeds the first support query, for coherent motion GJK then starts next to the final
+	// simplex and usually terminates after one or two iterations.
+	//
+	struct GJKCache
+	{
+		float direction[3];
+		bool valid;
+	};
+
+	/* Boolean GJK with early out on the first separating axis */
+	bool IntersectConvex(const ConvexShape& shapeA, const ConvexShape& shapeB, GJKCache* cache = nullptr);
+
+	/* GJK distance, EPA penetration depth when the cores overlap. Returns true when the shapes overlap */
+	bool ComputeConvexContact(const ConvexShape& shapeA, const ConvexShape& shapeB, ConvexContact& contact, GJKCache* cache = nullptr);
+
+	/* Pair i tests shapes[pairs[2 * i]] against shapes[pairs[2 * i + 1]], pairs are distributed over all hardware threads. caches may be null */
+	void ComputeConvexContacts(const ConvexShape* shapes, const uint_t* pairs, uint_t pairCount, ConvexContact* contacts, GJKCache* caches = nullptr);
+}
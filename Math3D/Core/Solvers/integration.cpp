@@ -0,0 +1,145 @@
+#include "integration.h"
+#include "math3dparallel.h"
+
+using namespace math3d;
+
+static const uint_t INTEGRATION_GRAIN = 65536;
+
+void math3d::IntegrateSemiImplicitEuler(const ParticleBatch& particles, const AccelerationBatch& accelerations, const Vector3& acceleration, float deltaTime, uint_t count)
+{
+	const float* a = acceleration.GetData();
+	float ax = a[0] * deltaTime;
+	float ay = a[1] * deltaTime;
+	float az = a[2] * deltaTime;
+	bool perBody = accelerations.x != nullptr;
+
+	ParallelFor(0, count, INTEGRATION_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		float* px = particles.positionX;
+		float* py = particles.positionY;
+		float* pz = particles.positionZ;
+		float* vx = particles.velocityX;
+		float* vy = particles.velocityY;
+		float* vz = particles.velocityZ;
+
+		if (perBody)
+		{
+			const float* bx = accelerations.x;
+			const float* by = accelerations.y;
+			const float* bz = accelerations.z;
+
+			for (uint_t i = begin; i < end; i++)
+			{
+				vx[i] += ax + bx[i] * deltaTime;
+				vy[i] += ay + by[i] * deltaTime;
+				vz[i] += az + bz[i] * deltaTime;
+			}
+		}
+		else
+		{
+			for (uint_t i = begin; i < end; i++)
+			{
+				vx[i] += ax;
+				vy[i] += ay;
+				vz[i] += az;
+			}
+		}
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			px[i] += vx[i] * deltaTime;
+			py[i] += vy[i] * deltaTime;
+			pz[i] += vz[i] * deltaTime;
+		}
+	});
+}
+
+void math3d::IntegrateVerlet(const VerletBatch& particles, const AccelerationBatch& accelerations, const Vector3& acceleration, float deltaTime, float damping, uint_t count)
+{
+	const float* a = acceleration.GetData();
+	float deltaTimeSquared = deltaTime * deltaTime;
+	float ax = a[0] * deltaTimeSquared;
+	float ay = a[1] * deltaTimeSquared;
+	float az = a[2] * deltaTimeSquared;
+	float keep = 1.0f - damping;
+	bool perBody = accelerations.x != nullptr;
+
+	ParallelFor(0, count, INTEGRATION_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		float* const positions[3] = { particles.positionX, particles.positionY, particles.positionZ };
+		float* const previous[3] = { particles.previousX, particles.previousY, particles.previousZ };
+		const float* const bodyAccelerations[3] = { accelerations.x, accelerations.y, accelerations.z };
+		const float constant[3] = { ax, ay, az };
+
+		// One component at a time keeps every loop to three streams
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			float* x = positions[axis];
+			float* old = previous[axis];
+			const float* b = bodyAccelerations[axis];
+			float c = constant[axis];
+
+			if (perBody)
+			{
+				for (uint_t i = begin; i < end; i++)
+				{
+					float current = x[i];
+
+					x[i] = current + (current - old[i]) * keep + c + b[i] * deltaTimeSquared;
+					old[i] = current;
+				}
+			}
+			else
+			{
+				for (uint_t i = begin; i < end; i++)
+				{
+					float current = x[i];
+
+					x[i] = current + (current - old[i]) * keep + c;
+					old[i] = current;
+				}
+			}
+		}
+	});
+}
+
+void math3d::IntegrateOrientations(const OrientationBatch& orientations, float deltaTime, uint_t count)
+{
+	float halfDeltaTime = 0.5f * deltaTime;
+
+	ParallelFor(0, count, INTEGRATION_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		float* qw = orientations.rotationW;
+		float* qx = orientations.rotationX;
+		float* qy = orientations.rotationY;
+		float* qz = orientations.rotationZ;
+		const float* wx = orientations.angularVelocityX;
+		const float* wy = orientations.angularVelocityY;
+		const float* wz = orientations.angularVelocityZ;
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			float w = qw[i];
+			float x = qx[i];
+			float y = qy[i];
+			float z = qz[i];
+			float ox = wx[i] * halfDeltaTime;
+			float oy = wy[i] * halfDeltaTime;
+			float oz = wz[i] * halfDeltaTime;
+
+			// (0, o) * q
+			float nw = w - ox * x - oy * y - oz * z;
+			float nx = x + ox * w + oy * z - oz * y;
+			float ny = y + oy * w + oz * x - ox * z;
+			float nz = z + oz * w + ox * y - oy * x;
+
+			float lengthSquared = nw * nw + nx * nx + ny * ny + nz * nz;
+			float scale = 1.5f - 0.5f * lengthSquared;
+
+			qw[i] = nw * scale;
+			qx[i] = nx * scale;
+			qy[i] = ny * scale;
+			qz[i] = nz * scale;
+		}
+	});
+}
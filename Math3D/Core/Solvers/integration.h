@@ -0,0 +1,66 @@
+#pragma once
+#include "math3dhelpers.h"
+
+namespace math3d
+{
+	/* Positions and velocities of many bodies, one array per component */
+	struct ParticleBatch
+	{
+		float* positionX;
+		float* positionY;
+		float* positionZ;
+		float* velocityX;
+		float* velocityY;
+		float* velocityZ;
+	};
+
+	/* Current and previous positions for position Verlet, one array per component */
+	struct VerletBatch
+	{
+		float* positionX;
+		float* positionY;
+		float* positionZ;
+		float* previousX;
+		float* previousY;
+		float* previousZ;
+	};
+
+	/* Unit orientations and world space angular velocities (radians per second), one array per component */
+	struct OrientationBatch
+	{
+		float* rotationW;
+		float* rotationX;
+		float* rotationY;
+		float* rotationZ;
+		const float* angularVelocityX;
+		const float* angularVelocityY;
+		const float* angularVelocityZ;
+	};
+
+	/* Per body accelerations, all three null when only the constant acceleration applies */
+	struct AccelerationBatch
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+	};
+
+	//
+	// Batched integrators over SoA arrays. Each body is independent, the loops are plain
+	// component loops the compiler vectorizes and large batches are split over the hardware threads.
+	// acceleration is added to the per body accelerations (gravity, wind, ...).
+	//
+
+	/* v += a * dt, then x += v * dt */
+	void IntegrateSemiImplicitEuler(const ParticleBatch& particles, const AccelerationBatch& accelerations, const Vector3& acceleration, float deltaTime, uint_t count);
+
+	/* x' = x + (x - previous) * (1 - damping) + a * dt^2, previous becomes x */
+	void IntegrateVerlet(const VerletBatch& particles, const AccelerationBatch& accelerations, const Vector3& acceleration, float deltaTime, float damping, uint_t count);
+
+	//
+	// q += 0.5 * dt * (0, w) * q, then one Newton step of 1 / sqrt(|q|^2) around 1 instead of a
+	// full normalize. The remaining norm error is about 0.05 * (|w| * dt)^4 and does not
+	// accumulate, every step also corrects the error of the previous one.
+	//
+	void IntegrateOrientations(const OrientationBatch& orientations, float deltaTime, uint_t count);
+}
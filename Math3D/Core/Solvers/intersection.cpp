@@ -0,0 +1,301 @@
+#include "intersection.h"
+#include "math3dutil.h"
+#include <cmath>
+
+using namespace math3d;
+
+static const float INTERSECTION_EPSILON = 1e-7f;
+
+template <uint_t N>
+void RayPacket<N>::SetRay(const uint_t lane, const Ray& ray, float maxDistance)
+{
+	if (lane >= N)
+	{
+		throw VectorInvalidIndex();
+	}
+
+	const float* o = ray.GetOrigin().GetData();
+	const float* d = ray.GetDirection().GetData();
+	const float* inv = ray.GetInverseDirection().GetData();
+
+	this->originX[lane] = o[0];
+	this->originY[lane] = o[1];
+	this->originZ[lane] = o[2];
+	this->directionX[lane] = d[0];
+	this->directionY[lane] = d[1];
+	this->directionZ[lane] = d[2];
+	this->inverseDirectionX[lane] = inv[0];
+	this->inverseDirectionY[lane] = inv[1];
+	this->inverseDirectionZ[lane] = inv[2];
+	this->tMax[lane] = maxDistance;
+}
+
+template <uint_t N>
+void SpherePacket<N>::SetSphere(const uint_t lane, const Sphere& sphere)
+{
+	if (lane >= N)
+	{
+		throw VectorInvalidIndex();
+	}
+
+	const float* c = sphere.GetCenter().GetData();
+
+	this->centerX[lane] = c[0];
+	this->centerY[lane] = c[1];
+	this->centerZ[lane] = c[2];
+	this->radius[lane] = sphere.GetRadius();
+}
+
+//
+// Slab planes picked by the sign of the inverse direction, entry first. An origin lying on a
+// plane with a zero direction component gives 0 * inf = NaN, the comparisons below are ordered
+// so that NaN drops out and the slab keeps the ray (Ize, Robust BVH Ray Traversal).
+//
+static inline float GetSlabEntry(float minimum, float maximum, float inverse)
+{
+	return inverse < 0.0f ? maximum : minimum;
+}
+
+static inline float GetSlabExit(float minimum, float maximum, float inverse)
+{
+	return inverse < 0.0f ? minimum : maximum;
+}
+
+static inline float MaxDropNaN(float value, float bound)
+{
+	return value > bound ? value : bound;
+}
+
+static inline float MinDropNaN(float value, float bound)
+{
+	return value < bound ? value : bound;
+}
+
+bool math3d::IntersectRayAABB(const Ray& ray, const AABB& box, float& tNear, float& tFar)
+{
+	const float* o = ray.GetOrigin().GetData();
+	const float* inv = ray.GetInverseDirection().GetData();
+	const float* boxMin = box.GetMin().GetData();
+	const float* boxMax = box.GetMax().GetData();
+
+	tNear = 0.0f;
+	tFar = FLT_MAX;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		float t0 = (GetSlabEntry(boxMin[i], boxMax[i], inv[i]) - o[i]) * inv[i];
+		float t1 = (GetSlabExit(boxMin[i], boxMax[i], inv[i]) - o[i]) * inv[i];
+
+		tNear = MaxDropNaN(t0, tNear);
+		tFar = MinDropNaN(t1, tFar);
+	}
+
+	return tNear <= tFar;
+}
+
+/* Moller-Trumbore, u and v are the barycentric weights of the second and third vertex */
+bool math3d::IntersectRayTriangle(const Ray& ray, const Triangle& triangle, float& t, float& u, float& v)
+{
+	const float* o = ray.GetOrigin().GetData();
+	const float* d = ray.GetDirection().GetData();
+	const float* v0 = triangle.GetVertexAt(0).GetData();
+	const float* v1 = triangle.GetVertexAt(1).GetData();
+	const float* v2 = triangle.GetVertexAt(2).GetData();
+
+	float e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+	float e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+
+	float p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+	float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+
+	if (Abs(det) < INTERSECTION_EPSILON)
+	{
+		return false;
+	}
+
+	float invDet = 1.0f / det;
+	float s[3] = { o[0] - v0[0], o[1] - v0[1], o[2] - v0[2] };
+
+	u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+
+	v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+
+	return t > INTERSECTION_EPSILON;
+}
+
+bool math3d::IntersectRaySphere(const Ray& ray, const Sphere& sphere, float& t)
+{
+	Vector3 toOrigin = ray.GetOrigin() - sphere.GetCenter();
+
+	float a = Vector3::DotProduct(ray.GetDirection(), ray.GetDirection());
+	float b = Vector3::DotProduct(toOrigin, ray.GetDirection());
+	float c = Vector3::DotProduct(toOrigin, toOrigin) - sphere.GetRadius() * sphere.GetRadius();
+	float discriminant = b * b - a * c;
+
+	if (discriminant < 0.0f || IsNearlyZero(a))
+	{
+		return false;
+	}
+
+	float root = std::sqrt(discriminant);
+
+	t = (-b - root) / a;
+	if (t < 0.0f)
+	{
+		t = (-b + root) / a;
+	}
+
+	return t >= 0.0f;
+}
+
+bool math3d::IntersectRayPlane(const Ray& ray, const Plane& plane, float& t)
+{
+	float denominator = Vector3::DotProduct(plane.GetNormal(), ray.GetDirection());
+
+	if (Abs(denominator) < INTERSECTION_EPSILON)
+	{
+		return false;
+	}
+
+	t = -plane.SignedDistance(ray.GetOrigin()) / denominator;
+
+	return t >= 0.0f;
+}
+
+bool math3d::IntersectSphereSphere(const Sphere& sphereA, const Sphere& sphereB)
+{
+	Vector3 diff = sphereA.GetCenter() - sphereB.GetCenter();
+	float radii = sphereA.GetRadius() + sphereB.GetRadius();
+
+	return Vector3::DotProduct(diff, diff) <= radii * radii;
+}
+
+template <uint_t N>
+uint_t math3d::IntersectRayPacketAABB(const RayPacket<N>& packet, const AABB& box, float* tNear)
+{
+	const float* boxMin = box.GetMin().GetData();
+	const float* boxMax = box.GetMax().GetData();
+
+	alignas(32) float tEnter[N];
+	alignas(32) float tExit[N];
+
+	for (uint_t i = 0; i < N; i++)
+	{
+		float ix = packet.inverseDirectionX[i];
+		float iy = packet.inverseDirectionY[i];
+		float iz = packet.inverseDirectionZ[i];
+		float tx0 = (GetSlabEntry(boxMin[0], boxMax[0], ix) - packet.originX[i]) * ix;
+		float tx1 = (GetSlabExit(boxMin[0], boxMax[0], ix) - packet.originX[i]) * ix;
+		float ty0 = (GetSlabEntry(boxMin[1], boxMax[1], iy) - packet.originY[i]) * iy;
+		float ty1 = (GetSlabExit(boxMin[1], boxMax[1], iy) - packet.originY[i]) * iy;
+		float tz0 = (GetSlabEntry(boxMin[2], boxMax[2], iz) - packet.originZ[i]) * iz;
+		float tz1 = (GetSlabExit(boxMin[2], boxMax[2], iz) - packet.originZ[i]) * iz;
+
+		float enter = MaxDropNaN(tz0, MaxDropNaN(ty0, MaxDropNaN(tx0, 0.0f)));
+		float exit = MinDropNaN(tz1, MinDropNaN(ty1, MinDropNaN(tx1, packet.tMax[i])));
+
+		tEnter[i] = enter;
+		tExit[i] = exit;
+	}
+
+	uint_t mask = 0;
+
+	for (uint_t i = 0; i < N; i++)
+	{
+		tNear[i] = tEnter[i];
+		mask |= (uint_t)(tEnter[i] <= tExit[i]) << i;
+	}
+
+	return mask;
+}
+
+template <uint_t N>
+uint_t math3d::IntersectRayPacketTriangle(const RayPacket<N>& packet, const Triangle& triangle, float* t, float* u, float* v)
+{
+	const float* v0 = triangle.GetVertexAt(0).GetData();
+	const float* v1 = triangle.GetVertexAt(1).GetData();
+	const float* v2 = triangle.GetVertexAt(2).GetData();
+
+	const float e1x = v1[0] - v0[0], e1y = v1[1] - v0[1], e1z = v1[2] - v0[2];
+	const float e2x = v2[0] - v0[0], e2y = v2[1] - v0[1], e2z = v2[2] - v0[2];
+
+	uint_t mask = 0;
+
+	for (uint_t i = 0; i < N; i++)
+	{
+		float px = packet.directionY[i] * e2z - packet.directionZ[i] * e2y;
+		float py = packet.directionZ[i] * e2x - packet.directionX[i] * e2z;
+		float pz = packet.directionX[i] * e2y - packet.directionY[i] * e2x;
+		float det = e1x * px + e1y * py + e1z * pz;
+		float invDet = 1.0f / det;
+
+		float sx = packet.originX[i] - v0[0];
+		float sy = packet.originY[i] - v0[1];
+		float sz = packet.originZ[i] - v0[2];
+
+		float qx = sy * e1z - sz * e1y;
+		float qy = sz * e1x - sx * e1z;
+		float qz = sx * e1y - sy * e1x;
+
+		float laneU = (sx * px + sy * py + sz * pz) * invDet;
+		float laneV = (packet.directionX[i] * qx + packet.directionY[i] * qy + packet.directionZ[i] * qz) * invDet;
+		float laneT = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+		// Non short-circuiting on purpose, keeps the lane loop branch free
+		bool hit = (Abs(det) >= INTERSECTION_EPSILON)
+			& (laneU >= 0.0f) & (laneV >= 0.0f) & (laneU + laneV <= 1.0f)
+			& (laneT > INTERSECTION_EPSILON) & (laneT <= packet.tMax[i]);
+
+		t[i] = laneT;
+		u[i] = laneU;
+		v[i] = laneV;
+		mask |= (uint_t)hit << i;
+	}
+
+	return mask;
+}
+
+template <uint_t N>
+uint_t math3d::IntersectSpherePacketSphere(const SpherePacket<N>& packet, const Sphere& sphere)
+{
+	const float* c = sphere.GetCenter().GetData();
+	const float r = sphere.GetRadius();
+
+	uint_t mask = 0;
+
+	for (uint_t i = 0; i < N; i++)
+	{
+		float dx = packet.centerX[i] - c[0];
+		float dy = packet.centerY[i] - c[1];
+		float dz = packet.centerZ[i] - c[2];
+		float radii = packet.radius[i] + r;
+
+		mask |= (uint_t)(dx * dx + dy * dy + dz * dz <= radii * radii) << i;
+	}
+
+	return mask;
+}
+
+/* Enforce packet widths */
+template struct math3d::RayPacket<4>;
+template struct math3d::RayPacket<8>;
+template struct math3d::SpherePacket<4>;
+template struct math3d::SpherePacket<8>;
+template uint_t math3d::IntersectRayPacketAABB<4>(const RayPacket<4>&, const AABB&, float*);
+template uint_t math3d::IntersectRayPacketAABB<8>(const RayPacket<8>&, const AABB&, float*);
+template uint_t math3d::IntersectRayPacketTriangle<4>(const RayPacket<4>&, const Triangle&, float*, float*, float*);
+template uint_t math3d::IntersectRayPacketTriangle<8>(const RayPacket<8>&, const Triangle&, float*, float*, float*);
+template uint_t math3d::IntersectSpherePacketSphere<4>(const SpherePacket<4>&, const Sphere&);
+template uint_t math3d::IntersectSpherePacketSphere<8>(const SpherePacket<8>&, const Sphere&);
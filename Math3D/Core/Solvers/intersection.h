@@ -0,0 +1,60 @@
+#pragma once
+#include "geometry.h"
+#include <cfloat>
+
+namespace math3d
+{
+	//
+	// Packets keep N independent queries in SoA layout so that the lane loops
+	// of the packet tests compile down to straight SIMD code (4 lanes SSE, 8 lanes AVX)
+	//
+
+	template <uint_t N>
+	struct RayPacket
+	{
+		alignas(32) float originX[N];
+		alignas(32) float originY[N];
+		alignas(32) float originZ[N];
+		alignas(32) float directionX[N];
+		alignas(32) float directionY[N];
+		alignas(32) float directionZ[N];
+		alignas(32) float inverseDirectionX[N];
+		alignas(32) float inverseDirectionY[N];
+		alignas(32) float inverseDirectionZ[N];
+		alignas(32) float tMax[N];
+
+		void SetRay(const uint_t lane, const Ray& ray, float maxDistance = FLT_MAX);
+	};
+
+	template <uint_t N>
+	struct SpherePacket
+	{
+		alignas(32) float centerX[N];
+		alignas(32) float centerY[N];
+		alignas(32) float centerZ[N];
+		alignas(32) float radius[N];
+
+		void SetSphere(const uint_t lane, const Sphere& sphere);
+	};
+
+	typedef RayPacket<4> RayPacket4;
+	typedef RayPacket<8> RayPacket8;
+	typedef SpherePacket<4> SpherePacket4;
+	typedef SpherePacket<8> SpherePacket8;
+
+	bool IntersectRayAABB(const Ray& ray, const AABB& box, float& tNear, float& tFar);
+	bool IntersectRayTriangle(const Ray& ray, const Triangle& triangle, float& t, float& u, float& v);
+	bool IntersectRaySphere(const Ray& ray, const Sphere& sphere, float& t);
+	bool IntersectRayPlane(const Ray& ray, const Plane& plane, float& t);
+	bool IntersectSphereSphere(const Sphere& sphereA, const Sphere& sphereB);
+
+	/* Packet tests return a bitmask with bit i set when lane i hits, per lane outputs are only valid for hitting lanes */
+	template <uint_t N>
+	uint_t IntersectRayPacketAABB(const RayPacket<N>& packet, const AABB& box, float* tNear);
+
+	template <uint_t N>
+	uint_t IntersectRayPacketTriangle(const RayPacket<N>& packet, const Triangle& triangle, float* t, float* u, float* v);
+
+	template <uint_t N>
+	uint_t IntersectSpherePacketSphere(const SpherePacket<N>& packet, const Sphere& sphere);
+}
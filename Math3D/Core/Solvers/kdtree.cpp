@@ -0,0 +1,497 @@
+#include "kdtree.h"
+#include "math3dparallel.h"
+#include "math3dutil.h"
+#include <algorithm>
+#include <climits>
+
+using namespace math3d;
+
+static const uint_t KDTREE_STACK_SIZE = 64;
+static const uint_t KDTREE_BUILD_GRAIN = 65536;
+static const uint_t KDTREE_TASKS_PER_WORKER = 8;
+static const uint_t KDTREE_QUERY_GRAIN = 256;
+
+namespace
+{
+	struct KDTreeRange
+	{
+		uint_t begin;
+		uint_t end;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	struct KDTreeStackEntry
+	{
+		uint_t begin;
+		uint_t end;
+		float distanceSquared;
+	};
+}
+
+static inline float DistanceSquared(const float* a, const float* b)
+{
+	float dx = a[0] - b[0];
+	float dy = a[1] - b[1];
+	float dz = a[2] - b[2];
+
+	return dx * dx + dy * dy + dz * dz;
+}
+
+/* Partitions the range around its median along the widest axis, returns false for leaves */
+static bool SplitRange(KDTreePoint* points, unsigned char* splitAxes, const KDTreeRange& range, uint_t leafSize, KDTreeRange& left, KDTreeRange& right)
+{
+	uint_t count = range.end - range.begin;
+
+	if (count <= leafSize)
+	{
+		return false;
+	}
+
+	uint_t axis = 0;
+
+	for (uint_t i = 1; i < 3; i++)
+	{
+		if (range.boundsMax[i] - range.boundsMin[i] > range.boundsMax[axis] - range.boundsMin[axis])
+		{
+			axis = i;
+		}
+	}
+
+	uint_t mid = range.begin + count / 2;
+
+	std::nth_element(points + range.begin, points + mid, points + range.end, [axis](const KDTreePoint& a, const KDTreePoint& b)
+	{
+		return a.position[axis] < b.position[axis];
+	});
+
+	splitAxes[mid] = (unsigned char)axis;
+
+	float split = points[mid].position[axis];
+
+	left = range;
+	left.end = mid;
+	left.boundsMax[axis] = split;
+
+	right = range;
+	right.begin = mid + 1;
+	right.boundsMin[axis] = split;
+
+	return true;
+}
+
+static void BuildSubtree(KDTreePoint* points, unsigned char* splitAxes, const KDTreeRange& range, uint_t leafSize)
+{
+	KDTreeRange left;
+	KDTreeRange right;
+
+	if (SplitRange(points, splitAxes, range, leafSize, left, right))
+	{
+		BuildSubtree(points, splitAxes, left, leafSize);
+		BuildSubtree(points, splitAxes, right, leafSize);
+	}
+}
+
+//
+// Calls func(slot, distanceSquared) for every point within sqrt(radiusSquared), used by
+// both radius query passes.
+//
+template <typename Func>
+static void ForEachInRadius(const KDTreePoint* points, const unsigned char* splitAxes, uint_t count, uint_t leafSize, const float* p, float radiusSquared, Func func)
+{
+	KDTreeStackEntry stack[KDTREE_STACK_SIZE];
+	uint_t stackSize = 0;
+
+	stack[stackSize++] = { 0, count, 0.0f };
+
+	while (stackSize > 0)
+	{
+		KDTreeStackEntry entry = stack[--stackSize];
+		uint_t begin = entry.begin;
+		uint_t end = entry.end;
+
+		while (end - begin > leafSize)
+		{
+			uint_t mid = begin + (end - begin) / 2;
+			const KDTreePoint& median = points[mid];
+			float distanceSquared = DistanceSquared(p, median.position);
+
+			if (distanceSquared <= radiusSquared)
+			{
+				func(mid, distanceSquared);
+			}
+
+			float diff = p[splitAxes[mid]] - median.position[splitAxes[mid]];
+			bool lower = diff < 0.0f;
+
+			if (diff * diff <= radiusSquared)
+			{
+				stack[stackSize++] = lower ? KDTreeStackEntry{ mid + 1, end, diff * diff } : KDTreeStackEntry{ begin, mid, diff * diff };
+			}
+
+			if (lower)
+			{
+				end = mid;
+			}
+			else
+			{
+				begin = mid + 1;
+			}
+		}
+
+		for (uint_t slot = begin; slot < end; slot++)
+		{
+			float distanceSquared = DistanceSquared(p, points[slot].position);
+
+			if (distanceSquared <= radiusSquared)
+			{
+				func(slot, distanceSquared);
+			}
+		}
+	}
+}
+
+KDTree::KDTree() : leafSize(8) {}
+
+KDTree::KDTree(const Vector3* points, uint_t count, uint_t leafSize) : leafSize(leafSize == 0 ? 1 : leafSize)
+{
+	this->points.resize(count);
+	this->splitAxes.assign(count, 0);
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	KDTreePoint* treePoints = this->points.data();
+	unsigned char* axes = this->splitAxes.data();
+	KDTreeRange root = { 0, count, { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		const float* p = points[i].GetData();
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			treePoints[i].position[axis] = p[axis];
+			root.boundsMin[axis] = Min(root.boundsMin[axis], p[axis]);
+			root.boundsMax[axis] = Max(root.boundsMax[axis], p[axis]);
+		}
+
+		treePoints[i].index = i;
+	}
+
+	//
+	// Top levels are split one level at a time, each level spread over the threads, until
+	// there are enough independent subtrees to keep every worker busy on its own.
+	//
+	uint_t leaf = this->leafSize;
+	uint_t taskTarget = GetWorkerCount() * KDTREE_TASKS_PER_WORKER;
+	std::vector<KDTreeRange> level(1, root);
+	std::vector<KDTreeRange> children;
+	std::vector<unsigned char> split;
+
+	while (!level.empty() && level.size() < taskTarget && count / (uint_t)level.size() > KDTREE_BUILD_GRAIN)
+	{
+		uint_t rangeCount = (uint_t)level.size();
+
+		children.resize(rangeCount * 2);
+		split.assign(rangeCount, 0);
+
+		ParallelFor(0, rangeCount, 1, [&](uint_t begin, uint_t end)
+		{
+			for (uint_t i = begin; i < end; i++)
+			{
+				split[i] = SplitRange(treePoints, axes, level[i], leaf, children[i * 2], children[i * 2 + 1]) ? 1 : 0;
+			}
+		});
+
+		level.clear();
+
+		for (uint_t i = 0; i < rangeCount; i++)
+		{
+			if (split[i] != 0)
+			{
+				level.push_back(children[i * 2]);
+				level.push_back(children[i * 2 + 1]);
+			}
+		}
+	}
+
+	ParallelFor(0, (uint_t)level.size(), 1, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			BuildSubtree(treePoints, axes, level[i], leaf);
+		}
+	});
+}
+
+uint_t KDTree::FindNearest(const Vector3& point, float& distanceSquared, float maxDistance) const
+{
+	const KDTreePoint* treePoints = this->points.data();
+	const unsigned char* axes = this->splitAxes.data();
+	const float* p = point.GetData();
+	uint_t count = (uint_t)this->points.size();
+	uint_t best = UINT_MAX;
+	float bestDistanceSquared = maxDistance == FLT_MAX ? FLT_MAX : maxDistance * maxDistance;
+
+	KDTreeStackEntry stack[KDTREE_STACK_SIZE];
+	uint_t stackSize = 0;
+
+	stack[stackSize++] = { 0, count, 0.0f };
+
+	while (stackSize > 0)
+	{
+		KDTreeStackEntry entry = stack[--stackSize];
+
+		if (entry.distanceSquared > bestDistanceSquared)
+		{
+			continue;
+		}
+
+		uint_t begin = entry.begin;
+		uint_t end = entry.end;
+
+		// Descend to the leaf on the query side, far halves are pushed with their plane distance
+		while (end - begin > this->leafSize)
+		{
+			uint_t mid = begin + (end - begin) / 2;
+			const KDTreePoint& median = treePoints[mid];
+			float medianDistanceSquared = DistanceSquared(p, median.position);
+
+			if (medianDistanceSquared < bestDistanceSquared)
+			{
+				bestDistanceSquared = medianDistanceSquared;
+				best = mid;
+			}
+
+			float diff = p[axes[mid]] - median.position[axes[mid]];
+			bool lower = diff < 0.0f;
+
+			if (diff * diff < bestDistanceSquared)
+			{
+				stack[stackSize++] = lower ? KDTreeStackEntry{ mid + 1, end, diff * diff } : KDTreeStackEntry{ begin, mid, diff * diff };
+			}
+
+			if (lower)
+			{
+				end = mid;
+			}
+			else
+			{
+				begin = mid + 1;
+			}
+		}
+
+		for (uint_t slot = begin; slot < end; slot++)
+		{
+			float slotDistanceSquared = DistanceSquared(p, treePoints[slot].position);
+
+			if (slotDistanceSquared < bestDistanceSquared)
+			{
+				bestDistanceSquared = slotDistanceSquared;
+				best = slot;
+			}
+		}
+	}
+
+	if (best == UINT_MAX)
+	{
+		distanceSquared = FLT_MAX;
+
+		return UINT_MAX;
+	}
+
+	distanceSquared = bestDistanceSquared;
+
+	return treePoints[best].index;
+}
+
+uint_t KDTree::FindKNearest(const Vector3& point, uint_t k, uint_t* indices, float* distancesSquared, float maxDistance) const
+{
+	if (k == 0)
+	{
+		return 0;
+	}
+
+	const KDTreePoint* treePoints = this->points.data();
+	const unsigned char* axes = this->splitAxes.data();
+	const float* p = point.GetData();
+	uint_t count = (uint_t)this->points.size();
+	uint_t found = 0;
+	float limitSquared = maxDistance == FLT_MAX ? FLT_MAX : maxDistance * maxDistance;
+	float boundSquared = limitSquared;
+
+	/* Keeps the results sorted by insertion, k is expected to be small */
+	auto insert = [&](uint_t slot, float distanceSquared)
+	{
+		uint_t position = found < k ? found++ : k - 1;
+
+		while (position > 0 && distancesSquared[position - 1] > distanceSquared)
+		{
+			distancesSquared[position] = distancesSquared[position - 1];
+			indices[position] = indices[position - 1];
+			position--;
+		}
+
+		distancesSquared[position] = distanceSquared;
+		indices[position] = treePoints[slot].index;
+
+		if (found == k)
+		{
+			boundSquared = distancesSquared[k - 1];
+		}
+	};
+
+	KDTreeStackEntry stack[KDTREE_STACK_SIZE];
+	uint_t stackSize = 0;
+
+	stack[stackSize++] = { 0, count, 0.0f };
+
+	while (stackSize > 0)
+	{
+		KDTreeStackEntry entry = stack[--stackSize];
+
+		if (entry.distanceSquared > boundSquared)
+		{
+			continue;
+		}
+
+		uint_t begin = entry.begin;
+		uint_t end = entry.end;
+
+		while (end - begin > this->leafSize)
+		{
+			uint_t mid = begin + (end - begin) / 2;
+			const KDTreePoint& median = treePoints[mid];
+			float medianDistanceSquared = DistanceSquared(p, median.position);
+
+			if (medianDistanceSquared < boundSquared)
+			{
+				insert(mid, medianDistanceSquared);
+			}
+
+			float diff = p[axes[mid]] - median.position[axes[mid]];
+			bool lower = diff < 0.0f;
+
+			if (diff * diff < boundSquared)
+			{
+				stack[stackSize++] = lower ? KDTreeStackEntry{ mid + 1, end, diff * diff } : KDTreeStackEntry{ begin, mid, diff * diff };
+			}
+
+			if (lower)
+			{
+				end = mid;
+			}
+			else
+			{
+				begin = mid + 1;
+			}
+		}
+
+		for (uint_t slot = begin; slot < end; slot++)
+		{
+			float slotDistanceSquared = DistanceSquared(p, treePoints[slot].position);
+
+			if (slotDistanceSquared < boundSquared)
+			{
+				insert(slot, slotDistanceSquared);
+			}
+		}
+	}
+
+	return found;
+}
+
+void KDTree::FindInRadius(const Vector3& point, float radius, std::vector<uint_t>& indices) const
+{
+	const KDTreePoint* treePoints = this->points.data();
+
+	ForEachInRadius(treePoints, this->splitAxes.data(), (uint_t)this->points.size(), this->leafSize, point.GetData(), radius * radius, [&](uint_t slot, float)
+	{
+		indices.push_back(treePoints[slot].index);
+	});
+}
+
+void KDTree::FindNearest(const Vector3* queries, uint_t count, uint_t* indices, float* distancesSquared) const
+{
+	ParallelFor(0, count, KDTREE_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			indices[i] = this->FindNearest(queries[i], distancesSquared[i]);
+		}
+	});
+}
+
+void KDTree::FindKNearest(const Vector3* queries, uint_t count, uint_t k, uint_t* indices, float* distancesSquared) const
+{
+	ParallelFor(0, count, KDTREE_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t* queryIndices = indices + i * k;
+			float* queryDistances = distancesSquared + i * k;
+
+			for (uint_t j = this->FindKNearest(queries[i], k, queryIndices, queryDistances); j < k; j++)
+			{
+				queryIndices[j] = UINT_MAX;
+				queryDistances[j] = FLT_MAX;
+			}
+		}
+	});
+}
+
+void KDTree::FindInRadius(const Vector3* queries, uint_t count, float radius, std::vector<uint_t>& offsets, std::vector<uint_t>& neighbors) const
+{
+	const KDTreePoint* treePoints = this->points.data();
+	const unsigned char* axes = this->splitAxes.data();
+	uint_t pointCount = (uint_t)this->points.size();
+	uint_t leaf = this->leafSize;
+	float radiusSquared = radius * radius;
+
+	offsets.assign(count + 1, 0);
+
+	uint_t* counts = offsets.data();
+
+	// Count pass, then a fill pass into the exact CSR layout
+	ParallelFor(0, count, KDTREE_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t found = 0;
+
+			ForEachInRadius(treePoints, axes, pointCount, leaf, queries[i].GetData(), radiusSquared, [&](uint_t, float)
+			{
+				found++;
+			});
+
+			counts[i + 1] = found;
+		}
+	});
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		counts[i + 1] += counts[i];
+	}
+
+	neighbors.resize(counts[count]);
+
+	uint_t* out = neighbors.data();
+
+	ParallelFor(0, count, KDTREE_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t slot = counts[i];
+
+			ForEachInRadius(treePoints, axes, pointCount, leaf, queries[i].GetData(), radiusSquared, [&](uint_t treeSlot, float)
+			{
+				out[slot++] = treePoints[treeSlot].index;
+			});
+
+			std::sort(out + counts[i], out + counts[i + 1]);
+		}
+	});
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <vector>
+#include <cfloat>
+
+namespace math3d
+{
+	struct KDTreePoint
+	{
+		float position[3];
+		uint_t index;
+	};
+
+	//
+	// Balanced k-d tree without nodes. The points are permuted so that every range [begin, end)
+	// keeps its median at begin + (end - begin) / 2 with the lower half before it, the split
+	// axis of that median is the only per node data. Ranges of at most leafSize points are leaves.
+	// Build partitions top levels one level at a time and then distributes whole subtrees
+	// over the hardware threads, batched queries are split over threads as well.
+	// BenchmarkKDTree reports build and query throughput, 10M points by default.
+	//
+	class KDTree
+	{
+	private:
+		std::vector<KDTreePoint> points;
+		std::vector<unsigned char> splitAxes;
+		uint_t leafSize;
+
+	public:
+		KDTree();
+		KDTree(const Vector3* points, uint_t count, uint_t leafSize = 8);
+		KDTree(const KDTree& tree) = default;
+		~KDTree() = default;
+
+		/* Returns the source index of the closest point, distanceSquared is FLT_MAX when none is within maxDistance */
+		uint_t FindNearest(const Vector3& point, float& distanceSquared, float maxDistance = FLT_MAX) const;
+
+		/* Writes up to k source indices sorted by distance, returns how many were found */
+		uint_t FindKNearest(const Vector3& point, uint_t k, uint_t* indices, float* distancesSquared, float maxDistance = FLT_MAX) const;
+
+		/* Appends the source indices of all points within radius, unordered */
+		void FindInRadius(const Vector3& point, float radius, std::vector<uint_t>& indices) const;
+
+		/* Batched variants, queries are distributed over all hardware threads */
+		void FindNearest(const Vector3* queries, uint_t count, uint_t* indices, float* distancesSquared) const;
+
+		/* Results of query i start at i * k, missing entries have index UINT_MAX and distance FLT_MAX */
+		void FindKNearest(const Vector3* queries, uint_t count, uint_t k, uint_t* indices, float* distancesSquared) const;
+
+		/* Neighbors of query i are neighbors[offsets[i], offsets[i + 1]), ascending by source index */
+		void FindInRadius(const Vector3* queries, uint_t count, float radius, std::vector<uint_t>& offsets, std::vector<uint_t>& neighbors) const;
+
+		KDTree& operator=(const KDTree& tree) = default;
+
+		inline uint_t GetPointCount() const
+		{
+			return (uint_t)this->points.size();
+		}
+
+		inline uint_t GetLeafSize() const
+		{
+			return this->leafSize;
+		}
+
+		/* Points in tree order, each with its source index */
+		inline const KDTreePoint* GetPoints() const
+		{
+			return this->points.data();
+		}
+	};
+}
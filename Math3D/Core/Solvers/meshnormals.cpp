@@ -0,0 +1,280 @@
+#include "meshnormals.h"
+#include "math3dparallel.h"
+#include <cmath>
+
+using namespace math3d;
+
+static const uint_t NORMAL_VERTEX_GRAIN = 16384;
+static const float CORNER_HALF_PI = 1.57079633f;
+static const float CORNER_PI = 3.14159265f;
+
+VertexAdjacency::VertexAdjacency() : vertexCount(0), triangleCount(0), offsets(1, 0) {}
+
+VertexAdjacency::VertexAdjacency(const uint_t* indices, uint_t triangleCount, uint_t vertexCount) : vertexCount(vertexCount),
+	triangleCount(triangleCount), offsets((size_t)vertexCount + 1, 0), corners((size_t)triangleCount * 3)
+{
+	uint_t cornerCount = triangleCount * 3;
+
+	for (uint_t c = 0; c < cornerCount; c++)
+	{
+		if (indices[c] >= vertexCount)
+		{
+			throw MeshInvalidIndex();
+		}
+
+		this->offsets[indices[c] + 1]++;
+	}
+
+	for (uint_t v = 0; v < vertexCount; v++)
+	{
+		this->offsets[v + 1] += this->offsets[v];
+	}
+
+	std::vector<uint_t> cursors(this->offsets.begin(), this->offsets.end() - 1);
+
+	for (uint_t c = 0; c < cornerCount; c++)
+	{
+		this->corners[cursors[indices[c]]++] = c;
+	}
+}
+
+static inline void NormalizeOrZero(float& x, float& y, float& z)
+{
+	float length = std::sqrt(x * x + y * y + z * z);
+	float inverse = length > 0.0f ? 1.0f / length : 0.0f;
+
+	x *= inverse;
+	y *= inverse;
+	z *= inverse;
+}
+
+/* Vertex a of a corner and the next (b) and previous (c) vertex of its face, so (b - a) x (c - a) follows the face winding */
+static inline void GetCornerVertices(const uint_t* indices, uint_t corner, uint_t& a, uint_t& b, uint_t& c)
+{
+	uint_t face = corner / 3;
+	uint_t k = corner - face * 3;
+	const uint_t* vertices = indices + (size_t)face * 3;
+
+	a = vertices[k];
+	b = vertices[k == 2 ? 0 : k + 1];
+	c = vertices[k == 0 ? 2 : k - 1];
+}
+
+//
+// atan2(y, x) for y >= 0, the corner angle from |e1 x e2| and e1 . e2. Polynomial on [0, 1]
+// and octant folding, branch free. The error stays below 2.1e-4 radians, largest where the
+// folded ratio reaches 1 (corner angles near 45 and 135 degrees), far below what changes a
+// weighted normal direction visibly.
+//
+static inline float CornerAngle(float y, float x)
+{
+	float ax = std::fabs(x);
+	float high = ax > y ? ax : y;
+	float low = ax > y ? y : ax;
+	float a = high > 0.0f ? low / high : 0.0f;
+	float s = a * a;
+	float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+
+	r = y > ax ? CORNER_HALF_PI - r : r;
+
+	return x < 0.0f ? CORNER_PI - r : r;
+}
+
+/* Corner weight for a face cross product of the given length (twice the area), 0 for degenerate faces */
+static inline float GetCornerWeight(NormalWeighting weighting, float length, float dot)
+{
+	if (!(length > 0.0f))
+	{
+		return 0.0f;
+	}
+
+	return weighting == NORMAL_WEIGHT_ANGLE ? CornerAngle(length, dot) : 0.5f * length;
+}
+
+//
+// Every vertex gathers its own corners through the adjacency and recomputes their face terms,
+// about three times the face arithmetic of a scatter but no shared writes, no per call buffers,
+// and a sum order fixed by the adjacency. The loop stays scalar: every corner costs indexed
+// position loads and corner counts vary per vertex, so SIMD lanes would first need the corners
+// staged in a per call buffer.
+//
+void math3d::ComputeVertexNormals(const MeshVertexInput& positions, const uint_t* indices, const VertexAdjacency& adjacency,
+	NormalWeighting weighting, MeshVertexOutput& normals)
+{
+	const uint_t* offsets = adjacency.GetOffsets();
+	const uint_t* corners = adjacency.GetCorners();
+	const float* px = positions.x;
+	const float* py = positions.y;
+	const float* pz = positions.z;
+
+	ParallelFor(0, adjacency.GetVertexCount(), NORMAL_VERTEX_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t v = begin; v < end; v++)
+		{
+			float x = 0.0f;
+			float y = 0.0f;
+			float z = 0.0f;
+
+			for (uint_t j = offsets[v]; j < offsets[v + 1]; j++)
+			{
+				uint_t a, b, c;
+
+				GetCornerVertices(indices, corners[j], a, b, c);
+
+				float e1x = px[b] - px[a];
+				float e1y = py[b] - py[a];
+				float e1z = pz[b] - pz[a];
+				float e2x = px[c] - px[a];
+				float e2y = py[c] - py[a];
+				float e2z = pz[c] - pz[a];
+				float nx = e1y * e2z - e1z * e2y;
+				float ny = e1z * e2x - e1x * e2z;
+				float nz = e1x * e2y - e1y * e2x;
+
+				// The cross product already carries twice the area
+				if (weighting == NORMAL_WEIGHT_ANGLE)
+				{
+					float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+					float scale = length > 0.0f ? CornerAngle(length, e1x * e2x + e1y * e2y + e1z * e2z) / length : 0.0f;
+
+					nx *= scale;
+					ny *= scale;
+					nz *= scale;
+				}
+
+				x += nx;
+				y += ny;
+				z += nz;
+			}
+
+			NormalizeOrZero(x, y, z);
+			normals.x[v] = x;
+			normals.y[v] = y;
+			normals.z[v] = z;
+		}
+	});
+}
+
+//
+// Per corner, solving e1 = du1 T + dv1 B, e2 = du2 T + dv2 B for the face tangent and bitangent
+// directions, where only the sign of the uv determinant is kept. Faces with degenerate uvs add
+// nothing.
+//
+void math3d::ComputeVertexTangents(const MeshVertexInput& positions, const MeshTexcoordInput& texcoords, const MeshVertexInput& normals,
+	const uint_t* indices, const VertexAdjacency& adjacency, NormalWeighting weighting, MeshVertexOutput& tangents, float* bitangentSigns)
+{
+	const uint_t* offsets = adjacency.GetOffsets();
+	const uint_t* corners = adjacency.GetCorners();
+	const float* px = positions.x;
+	const float* py = positions.y;
+	const float* pz = positions.z;
+	const float* pu = texcoords.u;
+	const float* pv = texcoords.v;
+
+	ParallelFor(0, adjacency.GetVertexCount(), NORMAL_VERTEX_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t v = begin; v < end; v++)
+		{
+			float tx = 0.0f;
+			float ty = 0.0f;
+			float tz = 0.0f;
+			float bx = 0.0f;
+			float by = 0.0f;
+			float bz = 0.0f;
+
+			for (uint_t j = offsets[v]; j < offsets[v + 1]; j++)
+			{
+				uint_t a, b, c;
+
+				GetCornerVertices(indices, corners[j], a, b, c);
+
+				float e1x = px[b] - px[a];
+				float e1y = py[b] - py[a];
+				float e1z = pz[b] - pz[a];
+				float e2x = px[c] - px[a];
+				float e2y = py[c] - py[a];
+				float e2z = pz[c] - pz[a];
+				float du1 = pu[b] - pu[a];
+				float dv1 = pv[b] - pv[a];
+				float du2 = pu[c] - pu[a];
+				float dv2 = pv[c] - pv[a];
+				float nx = e1y * e2z - e1z * e2y;
+				float ny = e1z * e2x - e1x * e2z;
+				float nz = e1x * e2y - e1y * e2x;
+				float weight = GetCornerWeight(weighting, std::sqrt(nx * nx + ny * ny + nz * nz), e1x * e2x + e1y * e2y + e1z * e2z);
+				float determinant = du1 * dv2 - du2 * dv1;
+				float sign = determinant > 0.0f ? 1.0f : determinant < 0.0f ? -1.0f : 0.0f;
+				float fx = (dv2 * e1x - dv1 * e2x) * sign;
+				float fy = (dv2 * e1y - dv1 * e2y) * sign;
+				float fz = (dv2 * e1z - dv1 * e2z) * sign;
+				float gx = (du1 * e2x - du2 * e1x) * sign;
+				float gy = (du1 * e2y - du2 * e1y) * sign;
+				float gz = (du1 * e2z - du2 * e1z) * sign;
+
+				NormalizeOrZero(fx, fy, fz);
+				NormalizeOrZero(gx, gy, gz);
+				tx += weight * fx;
+				ty += weight * fy;
+				tz += weight * fz;
+				bx += weight * gx;
+				by += weight * gy;
+				bz += weight * gz;
+			}
+
+			float nx = normals.x[v];
+			float ny = normals.y[v];
+			float nz = normals.z[v];
+			float along = nx * tx + ny * ty + nz * tz;
+
+			tx -= along * nx;
+			ty -= along * ny;
+			tz -= along * nz;
+
+			float length = std::sqrt(tx * tx + ty * ty + tz * tz);
+
+			if (length > 1e-12f)
+			{
+				tx /= length;
+				ty /= length;
+				tz /= length;
+			}
+			else
+			{
+				// Any direction orthogonal to the normal, taken against its smallest component axis
+				float ax = std::fabs(nx);
+				float ay = std::fabs(ny);
+				float az = std::fabs(nz);
+
+				if (ax <= ay && ax <= az)
+				{
+					tx = 0.0f;
+					ty = nz;
+					tz = -ny;
+				}
+				else if (ay <= az)
+				{
+					tx = -nz;
+					ty = 0.0f;
+					tz = nx;
+				}
+				else
+				{
+					tx = ny;
+					ty = -nx;
+					tz = 0.0f;
+				}
+
+				NormalizeOrZero(tx, ty, tz);
+			}
+
+			float cx = ny * tz - nz * ty;
+			float cy = nz * tx - nx * tz;
+			float cz = nx * ty - ny * tx;
+
+			tangents.x[v] = tx;
+			tangents.y[v] = ty;
+			tangents.z[v] = tz;
+			bitangentSigns[v] = cx * bx + cy * by + cz * bz < 0.0f ? -1.0f : 1.0f;
+		}
+	});
+}
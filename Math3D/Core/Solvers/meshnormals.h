@@ -0,0 +1,97 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <vector>
+
+namespace math3d
+{
+	/* Per vertex vectors of an SoA mesh, one array per component */
+	struct MeshVertexInput
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+	};
+
+	struct MeshVertexOutput
+	{
+		float* x;
+		float* y;
+		float* z;
+	};
+
+	struct MeshTexcoordInput
+	{
+		const float* u;
+		const float* v;
+	};
+
+	enum NormalWeighting
+	{
+		/* Face normals weighted by the face area */
+		NORMAL_WEIGHT_AREA,
+		/* Face normals weighted by the corner angle, independent of how the faces around a vertex are tessellated */
+		NORMAL_WEIGHT_ANGLE
+	};
+
+	//
+	// Vertex to face corner adjacency of an indexed triangle list in compressed rows: the corners
+	// (3 * triangle + k) using vertex v are [GetOffsets()[v], GetOffsets()[v + 1]) in GetCorners(),
+	// in increasing order. Built once per topology, a deforming mesh keeps reusing it.
+	//
+	class VertexAdjacency
+	{
+	private:
+		uint_t vertexCount;
+		uint_t triangleCount;
+		std::vector<uint_t> offsets;
+		std::vector<uint_t> corners;
+
+	public:
+		VertexAdjacency();
+		/* Throws MeshInvalidIndex for indices past vertexCount */
+		VertexAdjacency(const uint_t* indices, uint_t triangleCount, uint_t vertexCount);
+		VertexAdjacency(const VertexAdjacency& adjacency) = default;
+		~VertexAdjacency() = default;
+
+		VertexAdjacency& operator=(const VertexAdjacency& adjacency) = default;
+
+		inline uint_t GetVertexCount() const
+		{
+			return this->vertexCount;
+		}
+
+		inline uint_t GetTriangleCount() const
+		{
+			return this->triangleCount;
+		}
+
+		inline const uint_t* GetOffsets() const
+		{
+			return this->offsets.data();
+		}
+
+		inline const uint_t* GetCorners() const
+		{
+			return this->corners.data();
+		}
+	};
+
+	//
+	// Unit vertex normals of a counterclockwise indexed triangle list. Every vertex sums the terms
+	// of its own corners through the adjacency in parallel chunks, so there is no scatter and no
+	// atomic, and results do not depend on the thread count. indices must be the list the
+	// adjacency was built from. Vertices without a non degenerate face get a zero normal.
+	//
+	void ComputeVertexNormals(const MeshVertexInput& positions, const uint_t* indices, const VertexAdjacency& adjacency,
+		NormalWeighting weighting, MeshVertexOutput& normals);
+
+	//
+	// Per vertex tangent frames from texture coordinates (Lengyel): face tangent and bitangent
+	// directions are weighted like the normals and summed per vertex, the tangent is then made
+	// orthogonal to the unit normal. bitangentSigns gets +1 or -1 so that the bitangent is
+	// sign * cross(normal, tangent), mirrored uv islands get -1. Faces with degenerate uvs are
+	// skipped, vertices left without a tangent get an arbitrary unit vector orthogonal to the normal.
+	//
+	void ComputeVertexTangents(const MeshVertexInput& positions, const MeshTexcoordInput& texcoords, const MeshVertexInput& normals,
+		const uint_t* indices, const VertexAdjacency& adjacency, NormalWeighting weighting, MeshVertexOutput& tangents, float* bitangentSigns);
+}
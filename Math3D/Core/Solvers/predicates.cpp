@@ -0,0 +1,678 @@
+#include "predicates.h"
+#include "math3dparallel.h"
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+using namespace math3d;
+
+static const uint_t PREDICATE_GRAIN = 16384;
+
+// Shewchuk's first stage error bounds, epsilon is half an ulp of 1.0
+static const double PREDICATE_EPSILON = 1.1102230246251565e-16;
+static const double ORIENT2D_BOUND = (3.0 + 16.0 * PREDICATE_EPSILON) * PREDICATE_EPSILON;
+static const double ORIENT3D_BOUND = (7.0 + 56.0 * PREDICATE_EPSILON) * PREDICATE_EPSILON;
+static const double INCIRCLE_BOUND = (10.0 + 96.0 * PREDICATE_EPSILON) * PREDICATE_EPSILON;
+static const double INSPHERE_BOUND = (16.0 + 224.0 * PREDICATE_EPSILON) * PREDICATE_EPSILON;
+
+//
+// Expansion arithmetic: a value is the exact sum of non overlapping doubles stored by
+// increasing magnitude, zero components are dropped. Product tails come from fma, which is
+// exact and cannot be broken by the compiler contracting the classic split products.
+//
+typedef std::vector<double> Expansion;
+
+static inline void TwoSum(double a, double b, double& sum, double& error)
+{
+	sum = a + b;
+
+	double bVirtual = sum - a;
+	double aVirtual = sum - bVirtual;
+
+	error = (a - aVirtual) + (b - bVirtual);
+}
+
+static inline void FastTwoSum(double a, double b, double& sum, double& error)
+{
+	sum = a + b;
+	error = b - (sum - a);
+}
+
+static inline void TwoProduct(double a, double b, double& product, double& error)
+{
+	product = a * b;
+	error = std::fma(a, b, -product);
+}
+
+static Expansion Difference(double a, double b)
+{
+	double difference = a - b;
+	double bVirtual = a - difference;
+	double aVirtual = difference + bVirtual;
+	double error = (a - aVirtual) + (bVirtual - b);
+	Expansion ret;
+
+	if (error != 0.0)
+	{
+		ret.push_back(error);
+	}
+
+	ret.push_back(difference);
+
+	return ret;
+}
+
+/* Shewchuk's fast_expansion_sum_zeroelim */
+static Expansion Sum(const Expansion& e, const Expansion& f)
+{
+	if (e.empty())
+	{
+		return f;
+	}
+
+	if (f.empty())
+	{
+		return e;
+	}
+
+	Expansion h;
+	size_t eIndex = 0;
+	size_t fIndex = 0;
+	double q;
+	double qNew;
+	double error;
+
+	h.reserve(e.size() + f.size());
+
+	if ((f[0] > e[0]) == (f[0] > -e[0]))
+	{
+		q = e[eIndex++];
+	}
+	else
+	{
+		q = f[fIndex++];
+	}
+
+	if (eIndex < e.size() && fIndex < f.size())
+	{
+		if ((f[fIndex] > e[eIndex]) == (f[fIndex] > -e[eIndex]))
+		{
+			FastTwoSum(e[eIndex++], q, qNew, error);
+		}
+		else
+		{
+			FastTwoSum(f[fIndex++], q, qNew, error);
+		}
+
+		q = qNew;
+
+		if (error != 0.0)
+		{
+			h.push_back(error);
+		}
+
+		while (eIndex < e.size() && fIndex < f.size())
+		{
+			if ((f[fIndex] > e[eIndex]) == (f[fIndex] > -e[eIndex]))
+			{
+				TwoSum(q, e[eIndex++], qNew, error);
+			}
+			else
+			{
+				TwoSum(q, f[fIndex++], qNew, error);
+			}
+
+			q = qNew;
+
+			if (error != 0.0)
+			{
+				h.push_back(error);
+			}
+		}
+	}
+
+	for (; eIndex < e.size(); eIndex++)
+	{
+		TwoSum(q, e[eIndex], qNew, error);
+		q = qNew;
+
+		if (error != 0.0)
+		{
+			h.push_back(error);
+		}
+	}
+
+	for (; fIndex < f.size(); fIndex++)
+	{
+		TwoSum(q, f[fIndex], qNew, error);
+		q = qNew;
+
+		if (error != 0.0)
+		{
+			h.push_back(error);
+		}
+	}
+
+	if (q != 0.0 || h.empty())
+	{
+		h.push_back(q);
+	}
+
+	return h;
+}
+
+/* Shewchuk's scale_expansion_zeroelim */
+static Expansion Scale(const Expansion& e, double b)
+{
+	Expansion h;
+
+	if (e.empty() || b == 0.0)
+	{
+		return h;
+	}
+
+	double q;
+	double error;
+
+	h.reserve(e.size() * 2);
+	TwoProduct(e[0], b, q, error);
+
+	if (error != 0.0)
+	{
+		h.push_back(error);
+	}
+
+	for (size_t i = 1; i < e.size(); i++)
+	{
+		double product;
+		double productError;
+		double sum;
+
+		TwoProduct(e[i], b, product, productError);
+		TwoSum(q, productError, sum, error);
+
+		if (error != 0.0)
+		{
+			h.push_back(error);
+		}
+
+		FastTwoSum(product, sum, q, error);
+
+		if (error != 0.0)
+		{
+			h.push_back(error);
+		}
+	}
+
+	if (q != 0.0 || h.empty())
+	{
+		h.push_back(q);
+	}
+
+	return h;
+}
+
+static Expansion Multiply(const Expansion& e, const Expansion& f)
+{
+	Expansion h;
+
+	for (double component : f)
+	{
+		h = Sum(h, Scale(e, component));
+	}
+
+	return h;
+}
+
+static Expansion Negate(Expansion e)
+{
+	for (double& component : e)
+	{
+		component = -component;
+	}
+
+	return e;
+}
+
+/* e * f - g * h */
+static Expansion CrossTerm(const Expansion& e, const Expansion& f, const Expansion& g, const Expansion& h)
+{
+	return Sum(Multiply(e, f), Negate(Multiply(g, h)));
+}
+
+static double Estimate(const Expansion& e)
+{
+	double sum = 0.0;
+
+	for (double component : e)
+	{
+		sum += component;
+	}
+
+	return sum;
+}
+
+//
+// Exact evaluations. Translating every point by the last one keeps the determinant and the
+// differences are exact as two component expansions, everything after them is exact products and sums.
+//
+static double Orient2DExact(const double* a, const double* b, const double* c)
+{
+	Expansion acx = Difference(a[0], c[0]);
+	Expansion acy = Difference(a[1], c[1]);
+	Expansion bcx = Difference(b[0], c[0]);
+	Expansion bcy = Difference(b[1], c[1]);
+
+	return Estimate(CrossTerm(acx, bcy, acy, bcx));
+}
+
+static double Orient3DExact(const double* a, const double* b, const double* c, const double* d)
+{
+	Expansion ad[3];
+	Expansion bd[3];
+	Expansion cd[3];
+
+	for (uint_t k = 0; k < 3; k++)
+	{
+		ad[k] = Difference(a[k], d[k]);
+		bd[k] = Difference(b[k], d[k]);
+		cd[k] = Difference(c[k], d[k]);
+	}
+
+	Expansion bc = CrossTerm(bd[0], cd[1], cd[0], bd[1]);
+	Expansion ca = CrossTerm(cd[0], ad[1], ad[0], cd[1]);
+	Expansion ab = CrossTerm(ad[0], bd[1], bd[0], ad[1]);
+
+	return Estimate(Sum(Sum(Multiply(ad[2], bc), Multiply(bd[2], ca)), Multiply(cd[2], ab)));
+}
+
+static double InCircleExact(const double* a, const double* b, const double* c, const double* d)
+{
+	Expansion adx = Difference(a[0], d[0]);
+	Expansion ady = Difference(a[1], d[1]);
+	Expansion bdx = Difference(b[0], d[0]);
+	Expansion bdy = Difference(b[1], d[1]);
+	Expansion cdx = Difference(c[0], d[0]);
+	Expansion cdy = Difference(c[1], d[1]);
+
+	Expansion aLift = Sum(Multiply(adx, adx), Multiply(ady, ady));
+	Expansion bLift = Sum(Multiply(bdx, bdx), Multiply(bdy, bdy));
+	Expansion cLift = Sum(Multiply(cdx, cdx), Multiply(cdy, cdy));
+
+	Expansion bc = CrossTerm(bdx, cdy, cdx, bdy);
+	Expansion ca = CrossTerm(cdx, ady, adx, cdy);
+	Expansion ab = CrossTerm(adx, bdy, bdx, ady);
+
+	return Estimate(Sum(Sum(Multiply(aLift, bc), Multiply(bLift, ca)), Multiply(cLift, ab)));
+}
+
+static double InSphereExact(const double* a, const double* b, const double* c, const double* d, const double* e)
+{
+	Expansion ae[3];
+	Expansion be[3];
+	Expansion ce[3];
+	Expansion de[3];
+
+	for (uint_t k = 0; k < 3; k++)
+	{
+		ae[k] = Difference(a[k], e[k]);
+		be[k] = Difference(b[k], e[k]);
+		ce[k] = Difference(c[k], e[k]);
+		de[k] = Difference(d[k], e[k]);
+	}
+
+	Expansion ab = CrossTerm(ae[0], be[1], be[0], ae[1]);
+	Expansion bc = CrossTerm(be[0], ce[1], ce[0], be[1]);
+	Expansion cd = CrossTerm(ce[0], de[1], de[0], ce[1]);
+	Expansion da = CrossTerm(de[0], ae[1], ae[0], de[1]);
+	Expansion ac = CrossTerm(ae[0], ce[1], ce[0], ae[1]);
+	Expansion bd = CrossTerm(be[0], de[1], de[0], be[1]);
+
+	Expansion abc = Sum(CrossTerm(ae[2], bc, be[2], ac), Multiply(ce[2], ab));
+	Expansion bcd = Sum(CrossTerm(be[2], cd, ce[2], bd), Multiply(de[2], bc));
+	Expansion cda = Sum(Sum(Multiply(ce[2], da), Multiply(de[2], ac)), Multiply(ae[2], cd));
+	Expansion dab = Sum(Sum(Multiply(de[2], ab), Multiply(ae[2], bd)), Multiply(be[2], da));
+
+	Expansion lift[4];
+	const Expansion* rows[4] = { ae, be, ce, de };
+
+	for (uint_t i = 0; i < 4; i++)
+	{
+		lift[i] = Sum(Sum(Multiply(rows[i][0], rows[i][0]), Multiply(rows[i][1], rows[i][1])), Multiply(rows[i][2], rows[i][2]));
+	}
+
+	return Estimate(Sum(CrossTerm(lift[3], abc, lift[2], dab), CrossTerm(lift[1], cda, lift[0], bcd)));
+}
+
+//
+// Filters, true when the rounded determinant has a certain sign. The bounds scale with the
+// permanent (the determinant with every term made positive) as in Shewchuk's stage A.
+//
+static inline bool Orient2DFilter(const double* a, const double* b, const double* c, double& det)
+{
+	double left = (a[0] - c[0]) * (b[1] - c[1]);
+	double right = (a[1] - c[1]) * (b[0] - c[0]);
+
+	det = left - right;
+
+	// Terms of opposite sign cannot cancel
+	if ((left > 0.0 && right <= 0.0) || (left < 0.0 && right >= 0.0) || left == 0.0)
+	{
+		return true;
+	}
+
+	return std::fabs(det) >= ORIENT2D_BOUND * (std::fabs(left) + std::fabs(right));
+}
+
+static inline bool Orient3DFilter(const double* a, const double* b, const double* c, const double* d, double& det)
+{
+	double adx = a[0] - d[0];
+	double bdx = b[0] - d[0];
+	double cdx = c[0] - d[0];
+	double ady = a[1] - d[1];
+	double bdy = b[1] - d[1];
+	double cdy = c[1] - d[1];
+	double adz = a[2] - d[2];
+	double bdz = b[2] - d[2];
+	double cdz = c[2] - d[2];
+
+	double bdxcdy = bdx * cdy;
+	double cdxbdy = cdx * bdy;
+	double cdxady = cdx * ady;
+	double adxcdy = adx * cdy;
+	double adxbdy = adx * bdy;
+	double bdxady = bdx * ady;
+
+	det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+	double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz) + (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz)
+		+ (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+
+	return std::fabs(det) > ORIENT3D_BOUND * permanent || permanent == 0.0;
+}
+
+static inline bool InCircleFilter(const double* a, const double* b, const double* c, const double* d, double& det)
+{
+	double adx = a[0] - d[0];
+	double bdx = b[0] - d[0];
+	double cdx = c[0] - d[0];
+	double ady = a[1] - d[1];
+	double bdy = b[1] - d[1];
+	double cdy = c[1] - d[1];
+
+	double bdxcdy = bdx * cdy;
+	double cdxbdy = cdx * bdy;
+	double cdxady = cdx * ady;
+	double adxcdy = adx * cdy;
+	double adxbdy = adx * bdy;
+	double bdxady = bdx * ady;
+	double aLift = adx * adx + ady * ady;
+	double bLift = bdx * bdx + bdy * bdy;
+	double cLift = cdx * cdx + cdy * cdy;
+
+	det = aLift * (bdxcdy - cdxbdy) + bLift * (cdxady - adxcdy) + cLift * (adxbdy - bdxady);
+
+	double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * aLift + (std::fabs(cdxady) + std::fabs(adxcdy)) * bLift
+		+ (std::fabs(adxbdy) + std::fabs(bdxady)) * cLift;
+
+	return std::fabs(det) > INCIRCLE_BOUND * permanent || permanent == 0.0;
+}
+
+static inline bool InSphereFilter(const double* a, const double* b, const double* c, const double* d, const double* e, double& det)
+{
+	double aex = a[0] - e[0];
+	double bex = b[0] - e[0];
+	double cex = c[0] - e[0];
+	double dex = d[0] - e[0];
+	double aey = a[1] - e[1];
+	double bey = b[1] - e[1];
+	double cey = c[1] - e[1];
+	double dey = d[1] - e[1];
+	double aez = a[2] - e[2];
+	double bez = b[2] - e[2];
+	double cez = c[2] - e[2];
+	double dez = d[2] - e[2];
+
+	double aexbey = aex * bey;
+	double bexaey = bex * aey;
+	double bexcey = bex * cey;
+	double cexbey = cex * bey;
+	double cexdey = cex * dey;
+	double dexcey = dex * cey;
+	double dexaey = dex * aey;
+	double aexdey = aex * dey;
+	double aexcey = aex * cey;
+	double cexaey = cex * aey;
+	double bexdey = bex * dey;
+	double dexbey = dex * bey;
+
+	double ab = aexbey - bexaey;
+	double bc = bexcey - cexbey;
+	double cd = cexdey - dexcey;
+	double da = dexaey - aexdey;
+	double ac = aexcey - cexaey;
+	double bd = bexdey - dexbey;
+
+	double abc = aez * bc - bez * ac + cez * ab;
+	double bcd = bez * cd - cez * bd + dez * bc;
+	double cda = cez * da + dez * ac + aez * cd;
+	double dab = dez * ab + aez * bd + bez * da;
+
+	double aLift = aex * aex + aey * aey + aez * aez;
+	double bLift = bex * bex + bey * bey + bez * bez;
+	double cLift = cex * cex + cey * cey + cez * cez;
+	double dLift = dex * dex + dey * dey + dez * dez;
+
+	det = (dLift * abc - cLift * dab) + (bLift * cda - aLift * bcd);
+
+	double aezPlus = std::fabs(aez);
+	double bezPlus = std::fabs(bez);
+	double cezPlus = std::fabs(cez);
+	double dezPlus = std::fabs(dez);
+	double abPlus = std::fabs(aexbey) + std::fabs(bexaey);
+	double bcPlus = std::fabs(bexcey) + std::fabs(cexbey);
+	double cdPlus = std::fabs(cexdey) + std::fabs(dexcey);
+	double daPlus = std::fabs(dexaey) + std::fabs(aexdey);
+	double acPlus = std::fabs(aexcey) + std::fabs(cexaey);
+	double bdPlus = std::fabs(bexdey) + std::fabs(dexbey);
+
+	double permanent = (cdPlus * bezPlus + bdPlus * cezPlus + bcPlus * dezPlus) * aLift
+		+ (daPlus * cezPlus + acPlus * dezPlus + cdPlus * aezPlus) * bLift
+		+ (abPlus * dezPlus + bdPlus * aezPlus + daPlus * bezPlus) * cLift
+		+ (bcPlus * aezPlus + acPlus * bezPlus + abPlus * cezPlus) * dLift;
+
+	return std::fabs(det) > INSPHERE_BOUND * permanent || permanent == 0.0;
+}
+
+double math3d::Orient2D(const double* a, const double* b, const double* c)
+{
+	double det;
+
+	return Orient2DFilter(a, b, c, det) ? det : Orient2DExact(a, b, c);
+}
+
+double math3d::Orient3D(const double* a, const double* b, const double* c, const double* d)
+{
+	double det;
+
+	return Orient3DFilter(a, b, c, d, det) ? det : Orient3DExact(a, b, c, d);
+}
+
+double math3d::InCircle(const double* a, const double* b, const double* c, const double* d)
+{
+	double det;
+
+	return InCircleFilter(a, b, c, d, det) ? det : InCircleExact(a, b, c, d);
+}
+
+double math3d::InSphere(const double* a, const double* b, const double* c, const double* d, const double* e)
+{
+	double det;
+
+	return InSphereFilter(a, b, c, d, e, det) ? det : InSphereExact(a, b, c, d, e);
+}
+
+namespace
+{
+	/* Widened copy of a float point */
+	struct PredicatePoint
+	{
+		double values[3];
+
+		PredicatePoint(const float* point, uint_t size)
+		{
+			for (uint_t k = 0; k < 3; k++)
+			{
+				this->values[k] = k < size ? (double)point[k] : 0.0;
+			}
+		}
+	};
+}
+
+double math3d::Orient2D(const Vector2& a, const Vector2& b, const Vector2& c)
+{
+	PredicatePoint pa(a.GetData(), 2), pb(b.GetData(), 2), pc(c.GetData(), 2);
+
+	return Orient2D(pa.values, pb.values, pc.values);
+}
+
+double math3d::Orient3D(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d)
+{
+	PredicatePoint pa(a.GetData(), 3), pb(b.GetData(), 3), pc(c.GetData(), 3), pd(d.GetData(), 3);
+
+	return Orient3D(pa.values, pb.values, pc.values, pd.values);
+}
+
+double math3d::InCircle(const Vector2& a, const Vector2& b, const Vector2& c, const Vector2& d)
+{
+	PredicatePoint pa(a.GetData(), 2), pb(b.GetData(), 2), pc(c.GetData(), 2), pd(d.GetData(), 2);
+
+	return InCircle(pa.values, pb.values, pc.values, pd.values);
+}
+
+double math3d::InSphere(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d, const Vector3& e)
+{
+	PredicatePoint pa(a.GetData(), 3), pb(b.GetData(), 3), pc(c.GetData(), 3), pd(d.GetData(), 3), pe(e.GetData(), 3);
+
+	return InSphere(pa.values, pb.values, pc.values, pd.values, pe.values);
+}
+
+//
+// Shared batch driver: filter(query, det) evaluates one query and reports whether the sign is
+// certain, exact(query) re-evaluates it. Uncertain queries are collected per chunk so the
+// filter loop stays free of the expansion code.
+//
+template <typename Filter, typename Exact>
+static uint_t RunPredicateBatch(uint_t count, double* results, Filter filter, Exact exact)
+{
+	std::atomic<uint_t> exactCount(0);
+
+	ParallelFor(0, count, PREDICATE_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		std::vector<uint_t> uncertain;
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			if (!filter(i, results[i]))
+			{
+				uncertain.push_back(i);
+			}
+		}
+
+		for (uint_t i : uncertain)
+		{
+			results[i] = exact(i);
+		}
+
+		exactCount.fetch_add((uint_t)uncertain.size(), std::memory_order_relaxed);
+	});
+
+	return exactCount.load();
+}
+
+uint_t math3d::Orient2DBatch(const Vector2* points, const uint_t* indices, uint_t count, double* results)
+{
+	return RunPredicateBatch(count, results, [=](uint_t i, double& det)
+	{
+		const uint_t* query = indices + i * 3;
+		PredicatePoint a(points[query[0]].GetData(), 2), b(points[query[1]].GetData(), 2), c(points[query[2]].GetData(), 2);
+
+		return Orient2DFilter(a.values, b.values, c.values, det);
+	}, [=](uint_t i)
+	{
+		const uint_t* query = indices + i * 3;
+		PredicatePoint a(points[query[0]].GetData(), 2), b(points[query[1]].GetData(), 2), c(points[query[2]].GetData(), 2);
+
+		return Orient2DExact(a.values, b.values, c.values);
+	});
+}
+
+uint_t math3d::Orient3DBatch(const Vector3* points, const uint_t* indices, uint_t count, double* results)
+{
+	return RunPredicateBatch(count, results, [=](uint_t i, double& det)
+	{
+		const uint_t* query = indices + i * 4;
+		PredicatePoint a(points[query[0]].GetData(), 3), b(points[query[1]].GetData(), 3), c(points[query[2]].GetData(), 3), d(points[query[3]].GetData(), 3);
+
+		return Orient3DFilter(a.values, b.values, c.values, d.values, det);
+	}, [=](uint_t i)
+	{
+		const uint_t* query = indices + i * 4;
+		PredicatePoint a(points[query[0]].GetData(), 3), b(points[query[1]].GetData(), 3), c(points[query[2]].GetData(), 3), d(points[query[3]].GetData(), 3);
+
+		return Orient3DExact(a.values, b.values, c.values, d.values);
+	});
+}
+
+uint_t math3d::InCircleBatch(const Vector2* points, const uint_t* indices, uint_t count, double* results)
+{
+	return RunPredicateBatch(count, results, [=](uint_t i, double& det)
+	{
+		const uint_t* query = indices + i * 4;
+		PredicatePoint a(points[query[0]].GetData(), 2), b(points[query[1]].GetData(), 2), c(points[query[2]].GetData(), 2), d(points[query[3]].GetData(), 2);
+
+		return InCircleFilter(a.values, b.values, c.values, d.values, det);
+	}, [=](uint_t i)
+	{
+		const uint_t* query = indices + i * 4;
+		PredicatePoint a(points[query[0]].GetData(), 2), b(points[query[1]].GetData(), 2), c(points[query[2]].GetData(), 2), d(points[query[3]].GetData(), 2);
+
+		return InCircleExact(a.values, b.values, c.values, d.values);
+	});
+}
+
+uint_t math3d::InSphereBatch(const Vector3* points, const uint_t* indices, uint_t count, double* results)
+{
+	return RunPredicateBatch(count, results, [=](uint_t i, double& det)
+	{
+		const uint_t* query = indices + i * 5;
+		PredicatePoint a(points[query[0]].GetData(), 3), b(points[query[1]].GetData(), 3), c(points[query[2]].GetData(), 3), d(points[query[3]].GetData(), 3),
+			e(points[query[4]].GetData(), 3);
+
+		return InSphereFilter(a.values, b.values, c.values, d.values, e.values, det);
+	}, [=](uint_t i)
+	{
+		const uint_t* query = indices + i * 5;
+		PredicatePoint a(points[query[0]].GetData(), 3), b(points[query[1]].GetData(), 3), c(points[query[2]].GetData(), 3), d(points[query[3]].GetData(), 3),
+			e(points[query[4]].GetData(), 3);
+
+		return InSphereExact(a.values, b.values, c.values, d.values, e.values);
+	});
+}
+
+uint_t math3d::Orient3DPlane(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3* points, uint_t count, double* results)
+{
+	PredicatePoint pa(a.GetData(), 3), pb(b.GetData(), 3), pc(c.GetData(), 3);
+
+	return RunPredicateBatch(count, results, [&](uint_t i, double& det)
+	{
+		PredicatePoint d(points[i].GetData(), 3);
+
+		return Orient3DFilter(pa.values, pb.values, pc.values, d.values, det);
+	}, [&](uint_t i)
+	{
+		PredicatePoint d(points[i].GetData(), 3);
+
+		return Orient3DExact(pa.values, pb.values, pc.values, d.values);
+	});
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "math3dhelpers.h"
+
+namespace math3d
+{
+	//
+	// Robust geometric predicates after Shewchuk. The determinant is first evaluated in double
+	// next to a forward error bound, only when the bound cannot settle the sign is it evaluated
+	// again with exact expansion arithmetic. The sign of the result is always exact, the
+	// magnitude is an approximation. Float inputs widen to double without rounding. Only
+	// exactly or nearly degenerate inputs pay for the exact path.
+	//
+
+	/* Positive when a, b, c are counterclockwise, negative when clockwise, zero when collinear */
+	double Orient2D(const double* a, const double* b, const double* c);
+	/* Positive when d lies below the plane of a, b, c, below meaning a, b, c appear counterclockwise from above */
+	double Orient3D(const double* a, const double* b, const double* c, const double* d);
+	/* Positive when d lies inside the circle through a, b, c given counterclockwise, zero when cocircular */
+	double InCircle(const double* a, const double* b, const double* c, const double* d);
+	/* Positive when e lies inside the sphere through a, b, c, d ordered so that Orient3D(a, b, c, d) > 0 */
+	double InSphere(const double* a, const double* b, const double* c, const double* d, const double* e);
+
+	double Orient2D(const Vector2& a, const Vector2& b, const Vector2& c);
+	double Orient3D(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d);
+	double InCircle(const Vector2& a, const Vector2& b, const Vector2& c, const Vector2& d);
+	double InSphere(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d, const Vector3& e);
+
+	//
+	// Batched forms over indexed points, indices holds 3 (Orient2D), 4 (Orient3D, InCircle) or
+	// 5 (InSphere) point indices per query in argument order. The filter runs over parallel
+	// chunks and the uncertain queries of each chunk are evaluated exactly right after.
+	// Returns the number of exact evaluations.
+	//
+	uint_t Orient2DBatch(const Vector2* points, const uint_t* indices, uint_t count, double* results);
+	uint_t Orient3DBatch(const Vector3* points, const uint_t* indices, uint_t count, double* results);
+	uint_t InCircleBatch(const Vector2* points, const uint_t* indices, uint_t count, double* results);
+	uint_t InSphereBatch(const Vector3* points, const uint_t* indices, uint_t count, double* results);
+
+	/* Orient3D(a, b, c, points[i]) for every point, the plane side test of hull builders */
+	uint_t Orient3DPlane(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3* points, uint_t count, double* results);
+}
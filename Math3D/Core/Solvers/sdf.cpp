@@ -4,6 +4,8 @@
 
 float math3d::LineSegmentSDF(math3d::Vector<float, 2> segmentStart, math3d::Vector<float, 2> segmentEnd, math3d::Vector<float, 2> point)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_SDF_LINE_SEGMENT);
+
 	math3d::Vector<float, 2> segment = segmentEnd - segmentStart;
 	math3d::Vector<float, 2> startToPoint = point - segmentStart;
 
@@ -14,10 +16,14 @@ float math3d::LineSegmentSDF(math3d::Vector<float, 2> segmentStart, math3d::Vect
 
 float math3d::CircleSDF(math3d::Vector<float, 2> center, float radius, math3d::Vector<float, 2> point)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_SDF_CIRCLE);
+
 	return (center - point).Magnitude() - radius;
 }
 
 float math3d::SphereSDF(math3d::Vector<float, 3> center, float radius, math3d::Vector<float, 3> point)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_SDF_SPHERE);
+
 	return (center - point).Magnitude() - radius;
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "spatialhash.h"
+#include "math3dparallel.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+using namespace math3d;
+
+static const uint_t GRID_POINT_GRAIN = 16384;
+static const uint_t GRID_BUCKET_GRAIN = 16384;
+static const uint_t GRID_QUERY_GRAIN = 1024;
+
+static uint_t NextPowerOfTwo(uint_t value)
+{
+	uint_t ret = 1;
+
+	while (ret < value)
+	{
+		ret <<= 1;
+	}
+
+	return ret;
+}
+
+SpatialHashGrid::SpatialHashGrid(float cellSize, uint_t tableSize) : cellSize(cellSize), invCellSize(1.0f / cellSize), requestedTableSize(tableSize), tableMask(0), pointCount(0) {}
+
+void SpatialHashGrid::ComputeBuckets(const Vector3* points, uint_t count, uint_t* buckets) const
+{
+	ParallelFor(0, count, GRID_POINT_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			const float* p = points[i].GetData();
+
+			buckets[i] = this->GetBucket(this->GetCellCoordinate(p[0]), this->GetCellCoordinate(p[1]), this->GetCellCoordinate(p[2]));
+		}
+	});
+}
+
+/* Copies the positions into cell order */
+static void GatherPositions(const Vector3* points, const uint_t* indices, uint_t count, float* positions)
+{
+	ParallelFor(0, count, GRID_POINT_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t slot = begin; slot < end; slot++)
+		{
+			const float* p = points[indices[slot]].GetData();
+
+			positions[slot * 3] = p[0];
+			positions[slot * 3 + 1] = p[1];
+			positions[slot * 3 + 2] = p[2];
+		}
+	});
+}
+
+void SpatialHashGrid::Build(const Vector3* points, uint_t count)
+{
+	uint_t tableSize = NextPowerOfTwo(this->requestedTableSize != 0 ? this->requestedTableSize : (count > 0 ? count * 2 : 1));
+
+	this->pointCount = count;
+	this->tableMask = tableSize - 1;
+	this->pointBuckets.resize(count);
+	this->sortedIndices.resize(count);
+	this->sortedPositions.resize(count * 3);
+	this->cellStart.assign(tableSize + 1, 0);
+
+	uint_t* buckets = this->pointBuckets.data();
+	uint_t* starts = this->cellStart.data();
+	uint_t* indices = this->sortedIndices.data();
+
+	this->ComputeBuckets(points, count, buckets);
+
+	// Counting sort: histogram, exclusive scan, scatter through per bucket cursors
+	std::unique_ptr<std::atomic<uint_t>[]> cursors(new std::atomic<uint_t>[tableSize]);
+
+	ParallelFor(0, tableSize, GRID_BUCKET_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t b = begin; b < end; b++)
+		{
+			cursors[b].store(0, std::memory_order_relaxed);
+		}
+	});
+
+	ParallelFor(0, count, GRID_POINT_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			cursors[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	uint_t sum = 0;
+
+	for (uint_t b = 0; b < tableSize; b++)
+	{
+		uint_t bucketCount = cursors[b].load(std::memory_order_relaxed);
+
+		starts[b] = sum;
+		cursors[b].store(sum, std::memory_order_relaxed);
+		sum += bucketCount;
+	}
+
+	starts[tableSize] = sum;
+
+	ParallelFor(0, count, GRID_POINT_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			indices[cursors[buckets[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+		}
+	});
+
+	// Scatter order inside a bucket depends on thread timing, sort it back so builds are deterministic
+	ParallelFor(0, tableSize, GRID_BUCKET_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t b = begin; b < end; b++)
+		{
+			if (starts[b + 1] - starts[b] > 1)
+			{
+				std::sort(indices + starts[b], indices + starts[b + 1]);
+			}
+		}
+	});
+
+	GatherPositions(points, indices, count, this->sortedPositions.data());
+}
+
+uint_t SpatialHashGrid::Update(const Vector3* points, uint_t count)
+{
+	if (count != this->pointCount || this->cellStart.empty())
+	{
+		this->Build(points, count);
+
+		return count;
+	}
+
+	uint_t tableSize = this->tableMask + 1;
+
+	this->scratchBuckets.resize(count);
+	this->ComputeBuckets(points, count, this->scratchBuckets.data());
+
+	const uint_t* oldBuckets = this->pointBuckets.data();
+	const uint_t* newBuckets = this->scratchBuckets.data();
+	std::vector<uint_t> movers;
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		if (oldBuckets[i] != newBuckets[i])
+		{
+			movers.push_back(i);
+		}
+	}
+
+	uint_t moved = (uint_t)movers.size();
+
+	// Past a quarter of the points the merge stops paying off against a full counting sort
+	if (moved > count / 4)
+	{
+		this->Build(points, count);
+
+		return moved;
+	}
+
+	if (moved > 0)
+	{
+		std::sort(movers.begin(), movers.end(), [=](uint_t a, uint_t b)
+		{
+			return newBuckets[a] < newBuckets[b] || (newBuckets[a] == newBuckets[b] && a < b);
+		});
+
+		// New bucket sizes from the old ones adjusted by the movers, then exclusive scan
+		const uint_t* oldStarts = this->cellStart.data();
+		this->scratchStart.resize(tableSize + 1);
+		uint_t* newStarts = this->scratchStart.data();
+
+		for (uint_t b = 0; b < tableSize; b++)
+		{
+			newStarts[b] = oldStarts[b + 1] - oldStarts[b];
+		}
+
+		for (uint_t i : movers)
+		{
+			newStarts[oldBuckets[i]]--;
+			newStarts[newBuckets[i]]++;
+		}
+
+		uint_t sum = 0;
+
+		for (uint_t b = 0; b < tableSize; b++)
+		{
+			uint_t bucketCount = newStarts[b];
+
+			newStarts[b] = sum;
+			sum += bucketCount;
+		}
+
+		newStarts[tableSize] = sum;
+
+		// Merge per bucket: points that stayed keep their relative order, movers are appended
+		this->scratchIndices.resize(count);
+
+		const uint_t* oldIndices = this->sortedIndices.data();
+		uint_t* newIndices = this->scratchIndices.data();
+		const uint_t* moverBegin = movers.data();
+		const uint_t* moverEnd = movers.data() + moved;
+
+		ParallelFor(0, tableSize, GRID_BUCKET_GRAIN, [=](uint_t begin, uint_t end)
+		{
+			const uint_t* mover = std::lower_bound(moverBegin, moverEnd, begin, [=](uint_t index, uint_t bucket)
+			{
+				return newBuckets[index] < bucket;
+			});
+
+			for (uint_t b = begin; b < end; b++)
+			{
+				uint_t slot = newStarts[b];
+
+				for (uint_t old = oldStarts[b]; old < oldStarts[b + 1]; old++)
+				{
+					uint_t index = oldIndices[old];
+
+					if (newBuckets[index] == b)
+					{
+						newIndices[slot++] = index;
+					}
+				}
+
+				for (; mover != moverEnd && newBuckets[*mover] == b; mover++)
+				{
+					newIndices[slot++] = *mover;
+				}
+			}
+		});
+
+		std::swap(this->sortedIndices, this->scratchIndices);
+		std::swap(this->cellStart, this->scratchStart);
+		std::swap(this->pointBuckets, this->scratchBuckets);
+	}
+
+	GatherPositions(points, this->sortedIndices.data(), count, this->sortedPositions.data());
+
+	return moved;
+}
+
+void SpatialHashGrid::FindNeighbors(const Vector3* queries, uint_t count, float radius, std::vector<uint_t>& offsets, std::vector<uint_t>& neighbors) const
+{
+	offsets.assign(count + 1, 0);
+
+	uint_t* counts = offsets.data();
+
+	// Count pass, then a fill pass into the exact CSR layout
+	ParallelFor(0, count, GRID_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t found = 0;
+
+			this->ForEachNeighbor(queries[i], radius, [&](uint_t, float)
+			{
+				found++;
+			});
+
+			counts[i + 1] = found;
+		}
+	});
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		counts[i + 1] += counts[i];
+	}
+
+	neighbors.resize(counts[count]);
+
+	uint_t* out = neighbors.data();
+
+	ParallelFor(0, count, GRID_QUERY_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t slot = counts[i];
+
+			this->ForEachNeighbor(queries[i], radius, [&](uint_t index, float)
+			{
+				out[slot++] = index;
+			});
+
+			std::sort(out + counts[i], out + counts[i + 1]);
+		}
+	});
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <cmath>
+#include <vector>
+
+namespace math3d
+{
+	//
+	// Uniform grid hashed into a power of two bucket table. Points are counting sorted by
+	// bucket into one contiguous array (cell start offsets + positions in cell order), so a
+	// neighbor query touches a few dense runs and nothing is allocated per cell.
+	// Buckets may be shared by several cells, queries filter by cell and distance.
+	//
+	class SpatialHashGrid
+	{
+	private:
+		float cellSize;
+		float invCellSize;
+		uint_t requestedTableSize;
+		uint_t tableMask;
+		uint_t pointCount;
+		std::vector<uint_t> cellStart;
+		std::vector<uint_t> sortedIndices;
+		std::vector<float> sortedPositions;
+		std::vector<uint_t> pointBuckets;
+		std::vector<uint_t> scratchIndices;
+		std::vector<uint_t> scratchBuckets;
+		std::vector<uint_t> scratchStart;
+
+		void ComputeBuckets(const Vector3* points, uint_t count, uint_t* buckets) const;
+
+		inline int GetCellCoordinate(float value) const
+		{
+			return (int)std::floor(value * this->invCellSize);
+		}
+
+		inline uint_t GetBucket(int x, int y, int z) const
+		{
+			return ((uint_t)x * 73856093u ^ (uint_t)y * 19349663u ^ (uint_t)z * 83492791u) & this->tableMask;
+		}
+
+	public:
+		/* tableSize is rounded up to a power of two, 0 sizes the table to twice the point count on build */
+		SpatialHashGrid(float cellSize, uint_t tableSize = 0);
+		SpatialHashGrid(const SpatialHashGrid& grid) = default;
+		~SpatialHashGrid() = default;
+
+		void Build(const Vector3* points, uint_t count);
+
+		//
+		// Rebuild for moved points, same count and order as the last build. Points that kept
+		// their bucket keep their slot order, only the movers are re-inserted, so small motions
+		// cost a linear merge instead of a full sort. Returns the number of points that changed bucket.
+		//
+		uint_t Update(const Vector3* points, uint_t count);
+
+		/* Calls func(pointIndex, distanceSquared) for every point within radius, best with radius <= cell size */
+		template <typename Func>
+		void ForEachNeighbor(const Vector3& point, float radius, Func func) const
+		{
+			if (this->pointCount == 0)
+			{
+				return;
+			}
+
+			const float* p = point.GetData();
+			float radiusSquared = radius * radius;
+
+			int minCell[3];
+			int maxCell[3];
+
+			for (uint_t axis = 0; axis < 3; axis++)
+			{
+				minCell[axis] = this->GetCellCoordinate(p[axis] - radius);
+				maxCell[axis] = this->GetCellCoordinate(p[axis] + radius);
+			}
+
+			const uint_t* starts = this->cellStart.data();
+			const uint_t* indices = this->sortedIndices.data();
+			const float* positions = this->sortedPositions.data();
+
+			for (int z = minCell[2]; z <= maxCell[2]; z++)
+			{
+				for (int y = minCell[1]; y <= maxCell[1]; y++)
+				{
+					for (int x = minCell[0]; x <= maxCell[0]; x++)
+					{
+						uint_t bucket = this->GetBucket(x, y, z);
+
+						for (uint_t slot = starts[bucket]; slot < starts[bucket + 1]; slot++)
+						{
+							const float* q = positions + slot * 3;
+							float dx = q[0] - p[0];
+							float dy = q[1] - p[1];
+							float dz = q[2] - p[2];
+							float distanceSquared = dx * dx + dy * dy + dz * dz;
+
+							// The cell check drops hash collisions and buckets visited twice
+							if (distanceSquared <= radiusSquared
+								&& this->GetCellCoordinate(q[0]) == x && this->GetCellCoordinate(q[1]) == y && this->GetCellCoordinate(q[2]) == z)
+							{
+								func(indices[slot], distanceSquared);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		/* Neighbors of query i are neighbors[offsets[i], offsets[i + 1]), ascending by point index, queries run in parallel */
+		void FindNeighbors(const Vector3* queries, uint_t count, float radius, std::vector<uint_t>& offsets, std::vector<uint_t>& neighbors) const;
+
+		SpatialHashGrid& operator=(const SpatialHashGrid& grid) = default;
+
+		inline float GetCellSize() const
+		{
+			return this->cellSize;
+		}
+
+		inline uint_t GetPointCount() const
+		{
+			return this->pointCount;
+		}
+
+		inline uint_t GetTableSize() const
+		{
+			return this->tableMask + 1;
+		}
+
+		/* Original point indices in cell order, the order the grid iterates them in */
+		inline const uint_t* GetSortedIndices() const
+		{
+			return this->sortedIndices.data();
+		}
+
+		/* Positions in cell order, xyz per point */
+		inline const float* GetSortedPositions() const
+		{
+			return this->sortedPositions.data();
+		}
+	};
+}
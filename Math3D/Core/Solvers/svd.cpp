@@ -0,0 +1,501 @@
+#include "svd.h"
+#include "eigen.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+using namespace math3d;
+
+static const uint_t SVD_BATCH_GRAIN = 512;
+static const uint_t REGISTRATION_GRAIN = 64;
+
+//
+// Givens rotation on rows i and j of b that annihilates b[j][i] against the pivot b[i][i],
+// the transposed rotation is accumulated in the columns of u so that u * b stays constant.
+//
+static inline void GivensQR(float* b, float* u, uint_t i, uint_t j)
+{
+	float pivot = b[i * 3 + i];
+	float target = b[j * 3 + i];
+	float r = std::sqrt(pivot * pivot + target * target);
+	bool negligible = r < FLT_MIN;
+	float invR = negligible ? 0.0f : 1.0f / r;
+	float c = negligible ? 1.0f : pivot * invR;
+	float s = target * invR;
+
+	for (uint_t k = 0; k < 3; k++)
+	{
+		float bi = b[i * 3 + k];
+		float bj = b[j * 3 + k];
+		b[i * 3 + k] = c * bi + s * bj;
+		b[j * 3 + k] = c * bj - s * bi;
+
+		float ui = u[k * 3 + i];
+		float uj = u[k * 3 + j];
+		u[k * 3 + i] = c * ui + s * uj;
+		u[k * 3 + j] = c * uj - s * ui;
+	}
+}
+
+/* Given V from the eigenanalysis of A^T A, QR of A V yields U and the signed singular values */
+static void CompleteSVD(const float* a, const float* v, float* u, float* singularValues)
+{
+	float b[9];
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		for (uint_t c = 0; c < 3; c++)
+		{
+			b[r * 3 + c] = a[r * 3] * v[c] + a[r * 3 + 1] * v[3 + c] + a[r * 3 + 2] * v[6 + c];
+			u[r * 3 + c] = (r == c) ? 1.0f : 0.0f;
+		}
+	}
+
+	GivensQR(b, u, 0, 1);
+	GivensQR(b, u, 0, 2);
+	GivensQR(b, u, 1, 2);
+
+	singularValues[0] = b[0];
+	singularValues[1] = b[4];
+	singularValues[2] = b[8];
+}
+
+/* Upper triangle of A^T A */
+static void ComputeNormalMatrix(const float* a, float* normal)
+{
+	normal[0] = a[0] * a[0] + a[3] * a[3] + a[6] * a[6];
+	normal[1] = a[0] * a[1] + a[3] * a[4] + a[6] * a[7];
+	normal[2] = a[0] * a[2] + a[3] * a[5] + a[6] * a[8];
+	normal[3] = a[1] * a[1] + a[4] * a[4] + a[7] * a[7];
+	normal[4] = a[1] * a[2] + a[4] * a[5] + a[7] * a[8];
+	normal[5] = a[2] * a[2] + a[5] * a[5] + a[8] * a[8];
+}
+
+void math3d::DecomposeSVD3x3(const Matrix3x3& matrix, Matrix3x3& u, Vector3& singularValues, Matrix3x3& v)
+{
+	const float* a = matrix.GetData();
+	float normal[6];
+
+	ComputeNormalMatrix(a, normal);
+
+	float values[9] = {
+		normal[0], normal[1], normal[2],
+		normal[1], normal[3], normal[4],
+		normal[2], normal[4], normal[5]
+	};
+
+	Vector3 eigenvalues;
+	DecomposeSymmetric3x3(Matrix3x3(values), eigenvalues, v);
+
+	float sigma[3];
+	CompleteSVD(a, v.GetData(), u.GetData(), sigma);
+
+	singularValues = Vector3(sigma);
+}
+
+void math3d::DecomposeSVD3x3(const Matrix3x3* matrices, uint_t count, Matrix3x3* u, Vector3* singularValues, Matrix3x3* v)
+{
+	std::vector<float> normals(count * 6);
+	std::vector<float> eigenvalues(count * 3);
+	std::vector<float> rotations(count * 4);
+
+	uint_t n = count;
+
+	ParallelFor(0, count, SVD_BATCH_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			float normal[6];
+
+			ComputeNormalMatrix(matrices[i].GetData(), normal);
+
+			for (uint_t k = 0; k < 6; k++)
+			{
+				normals[k * n + i] = normal[k];
+			}
+		}
+	});
+
+	SymmetricMatrix3Batch normalMatrices;
+	normalMatrices.xx = normals.data();
+	normalMatrices.xy = normals.data() + n;
+	normalMatrices.xz = normals.data() + n * 2;
+	normalMatrices.yy = normals.data() + n * 3;
+	normalMatrices.yz = normals.data() + n * 4;
+	normalMatrices.zz = normals.data() + n * 5;
+
+	EigenDecomposition3Batch decompositions;
+	decompositions.eigenvalue0 = eigenvalues.data();
+	decompositions.eigenvalue1 = eigenvalues.data() + n;
+	decompositions.eigenvalue2 = eigenvalues.data() + n * 2;
+	decompositions.rotationW = rotations.data();
+	decompositions.rotationX = rotations.data() + n;
+	decompositions.rotationY = rotations.data() + n * 2;
+	decompositions.rotationZ = rotations.data() + n * 3;
+
+	DecomposeSymmetric3x3(normalMatrices, count, decompositions);
+
+	ParallelFor(0, count, SVD_BATCH_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			Quaternion rotation(rotations[i], rotations[n + i], rotations[n * 2 + i], rotations[n * 3 + i]);
+			float sigma[3];
+
+			v[i] = rotation.GetRotationMatrix();
+			CompleteSVD(matrices[i].GetData(), v[i].GetData(), u[i].GetData(), sigma);
+			singularValues[i] = Vector3(sigma);
+		}
+	});
+}
+
+void math3d::DecomposePolar3x3(const Matrix3x3& matrix, Matrix3x3& rotation, Matrix3x3& stretch)
+{
+	Matrix3x3 u;
+	Matrix3x3 v;
+	Vector3 singularValues;
+
+	DecomposeSVD3x3(matrix, u, singularValues, v);
+
+	const float* mu = u.GetData();
+	const float* mv = v.GetData();
+	const float* sigma = singularValues.GetData();
+	float* r = rotation.GetData();
+	float* s = stretch.GetData();
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		for (uint_t j = 0; j < 3; j++)
+		{
+			r[i * 3 + j] = mu[i * 3] * mv[j * 3] + mu[i * 3 + 1] * mv[j * 3 + 1] + mu[i * 3 + 2] * mv[j * 3 + 2];
+			s[i * 3 + j] = mv[i * 3] * sigma[0] * mv[j * 3] + mv[i * 3 + 1] * sigma[1] * mv[j * 3 + 1] + mv[i * 3 + 2] * sigma[2] * mv[j * 3 + 2];
+		}
+	}
+}
+
+//
+// RigidRegistration
+//
+
+RigidRegistration::RigidRegistration()
+{
+	this->Reset();
+}
+
+RigidRegistration::RigidRegistration(const RigidRegistration& registration)
+{
+	*this = registration;
+}
+
+void RigidRegistration::Reset()
+{
+	this->count = 0;
+	this->weightSum = 0.0;
+	this->sourceSquaredSum = 0.0;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		this->sourceOrigin[i] = 0.0;
+		this->targetOrigin[i] = 0.0;
+		this->sourceSum[i] = 0.0;
+		this->targetSum[i] = 0.0;
+	}
+
+	for (uint_t i = 0; i < 9; i++)
+	{
+		this->crossSum[i] = 0.0;
+	}
+}
+
+void RigidRegistration::Add(const Vector3& source, const Vector3& target, float weight)
+{
+	const float* p = source.GetData();
+	const float* q = target.GetData();
+
+	// Sums are taken relative to the first correspondence, keeps the centered covariance exact for far away clouds
+	if (this->count == 0)
+	{
+		for (uint_t i = 0; i < 3; i++)
+		{
+			this->sourceOrigin[i] = p[i];
+			this->targetOrigin[i] = q[i];
+		}
+	}
+
+	double ps[3] = { p[0] - this->sourceOrigin[0], p[1] - this->sourceOrigin[1], p[2] - this->sourceOrigin[2] };
+	double qs[3] = { q[0] - this->targetOrigin[0], q[1] - this->targetOrigin[1], q[2] - this->targetOrigin[2] };
+
+	this->count++;
+	this->weightSum += weight;
+	this->sourceSquaredSum += weight * (ps[0] * ps[0] + ps[1] * ps[1] + ps[2] * ps[2]);
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		this->sourceSum[r] += weight * ps[r];
+		this->targetSum[r] += weight * qs[r];
+
+		for (uint_t c = 0; c < 3; c++)
+		{
+			this->crossSum[r * 3 + c] += weight * ps[r] * qs[c];
+		}
+	}
+}
+
+void RigidRegistration::Add(const Vector3* sources, const Vector3* targets, uint_t count)
+{
+	for (uint_t i = 0; i < count; i++)
+	{
+		this->Add(sources[i], targets[i]);
+	}
+}
+
+void RigidRegistration::Merge(const RigidRegistration& registration)
+{
+	if (registration.count == 0)
+	{
+		return;
+	}
+
+	if (this->count == 0)
+	{
+		*this = registration;
+
+		return;
+	}
+
+	// Shift the other sums to this origin: sum(p - o) = sum(p - o') + w * (o' - o)
+	double dp[3];
+	double dq[3];
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		dp[i] = registration.sourceOrigin[i] - this->sourceOrigin[i];
+		dq[i] = registration.targetOrigin[i] - this->targetOrigin[i];
+	}
+
+	double w = registration.weightSum;
+	const double* sp = registration.sourceSum;
+	const double* sq = registration.targetSum;
+
+	this->sourceSquaredSum += registration.sourceSquaredSum + 2.0 * (dp[0] * sp[0] + dp[1] * sp[1] + dp[2] * sp[2]) + w * (dp[0] * dp[0] + dp[1] * dp[1] + dp[2] * dp[2]);
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		for (uint_t c = 0; c < 3; c++)
+		{
+			this->crossSum[r * 3 + c] += registration.crossSum[r * 3 + c] + sp[r] * dq[c] + dp[r] * sq[c] + w * dp[r] * dq[c];
+		}
+	}
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		this->sourceSum[i] += sp[i] + w * dp[i];
+		this->targetSum[i] += sq[i] + w * dq[i];
+	}
+
+	this->count += registration.count;
+	this->weightSum += w;
+}
+
+Vector3 RigidRegistration::GetSourceMean() const
+{
+	if (this->weightSum <= 0.0)
+	{
+		return Vector3();
+	}
+
+	double invWeight = 1.0 / this->weightSum;
+
+	return CreateVector3((float)(this->sourceOrigin[0] + this->sourceSum[0] * invWeight), (float)(this->sourceOrigin[1] + this->sourceSum[1] * invWeight), (float)(this->sourceOrigin[2] + this->sourceSum[2] * invWeight));
+}
+
+Vector3 RigidRegistration::GetTargetMean() const
+{
+	if (this->weightSum <= 0.0)
+	{
+		return Vector3();
+	}
+
+	double invWeight = 1.0 / this->weightSum;
+
+	return CreateVector3((float)(this->targetOrigin[0] + this->targetSum[0] * invWeight), (float)(this->targetOrigin[1] + this->targetSum[1] * invWeight), (float)(this->targetOrigin[2] + this->targetSum[2] * invWeight));
+}
+
+Matrix3x3 RigidRegistration::GetCrossCovariance() const
+{
+	Matrix3x3 ret;
+	float* h = ret.GetData();
+
+	if (this->weightSum <= 0.0)
+	{
+		return ret;
+	}
+
+	double invWeight = 1.0 / this->weightSum;
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		for (uint_t c = 0; c < 3; c++)
+		{
+			h[r * 3 + c] = (float)((this->crossSum[r * 3 + c] - this->sourceSum[r] * this->targetSum[c] * invWeight) * invWeight);
+		}
+	}
+
+	return ret;
+}
+
+double RigidRegistration::GetSourceVariance() const
+{
+	if (this->weightSum <= 0.0)
+	{
+		return 0.0;
+	}
+
+	double invWeight = 1.0 / this->weightSum;
+	const double* sum = this->sourceSum;
+
+	return (this->sourceSquaredSum - (sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]) * invWeight) * invWeight;
+}
+
+/* H = U S V^T, the optimal rotation is V U^T. U and V are proper so no reflection fix is needed */
+static Matrix3x3 ComputeOptimalRotation(const Matrix3x3& u, const Matrix3x3& v)
+{
+	Matrix3x3 ret;
+	const float* mu = u.GetData();
+	const float* mv = v.GetData();
+	float* r = ret.GetData();
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		for (uint_t j = 0; j < 3; j++)
+		{
+			r[i * 3 + j] = mv[i * 3] * mu[j * 3] + mv[i * 3 + 1] * mu[j * 3 + 1] + mv[i * 3 + 2] * mu[j * 3 + 2];
+		}
+	}
+
+	return ret;
+}
+
+static Vector3 ComputeTranslation(const Matrix3x3& rotation, float scale, const Vector3& sourceMean, const Vector3& targetMean)
+{
+	const float* r = rotation.GetData();
+	const float* p = sourceMean.GetData();
+	const float* q = targetMean.GetData();
+
+	return CreateVector3(
+		q[0] - scale * (r[0] * p[0] + r[1] * p[1] + r[2] * p[2]),
+		q[1] - scale * (r[3] * p[0] + r[4] * p[1] + r[5] * p[2]),
+		q[2] - scale * (r[6] * p[0] + r[7] * p[1] + r[8] * p[2]));
+}
+
+bool RigidRegistration::Solve(Quaternion& rotation, Vector3& translation) const
+{
+	if (this->count == 0 || this->weightSum <= 0.0)
+	{
+		return false;
+	}
+
+	Matrix3x3 u;
+	Matrix3x3 v;
+	Vector3 singularValues;
+
+	DecomposeSVD3x3(this->GetCrossCovariance(), u, singularValues, v);
+
+	Matrix3x3 r = ComputeOptimalRotation(u, v);
+
+	rotation = Quaternion::CreateFromRotationMatrix(r);
+	translation = ComputeTranslation(r, 1.0f, this->GetSourceMean(), this->GetTargetMean());
+
+	return true;
+}
+
+bool RigidRegistration::Solve(Quaternion& rotation, Vector3& translation, float& scale) const
+{
+	if (this->count == 0 || this->weightSum <= 0.0)
+	{
+		return false;
+	}
+
+	Matrix3x3 u;
+	Matrix3x3 v;
+	Vector3 singularValues;
+
+	DecomposeSVD3x3(this->GetCrossCovariance(), u, singularValues, v);
+
+	Matrix3x3 r = ComputeOptimalRotation(u, v);
+	const float* sigma = singularValues.GetData();
+	double variance = this->GetSourceVariance();
+
+	// Umeyama: trace of the signed singular values over the source variance
+	scale = variance > 0.0 ? (float)((sigma[0] + sigma[1] + sigma[2]) / variance) : 1.0f;
+	rotation = Quaternion::CreateFromRotationMatrix(r);
+	translation = ComputeTranslation(r, scale, this->GetSourceMean(), this->GetTargetMean());
+
+	return true;
+}
+
+RigidRegistration& RigidRegistration::operator=(const RigidRegistration& registration)
+{
+	this->count = registration.count;
+	this->weightSum = registration.weightSum;
+	this->sourceSquaredSum = registration.sourceSquaredSum;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		this->sourceOrigin[i] = registration.sourceOrigin[i];
+		this->targetOrigin[i] = registration.targetOrigin[i];
+		this->sourceSum[i] = registration.sourceSum[i];
+		this->targetSum[i] = registration.targetSum[i];
+	}
+
+	for (uint_t i = 0; i < 9; i++)
+	{
+		this->crossSum[i] = registration.crossSum[i];
+	}
+
+	return *this;
+}
+
+void math3d::SolveRigidRegistrations(const Vector3* sources, const Vector3* targets, const uint_t* offsets, uint_t count, Quaternion* rotations, Vector3* translations)
+{
+	std::vector<RigidRegistration> registrations(count);
+	std::vector<Matrix3x3> covariances(count);
+	std::vector<Matrix3x3> u(count);
+	std::vector<Matrix3x3> v(count);
+	std::vector<Vector3> singularValues(count);
+
+	ParallelFor(0, count, REGISTRATION_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t first = offsets[i];
+
+			registrations[i].Add(sources + first, targets + first, offsets[i + 1] - first);
+			covariances[i] = registrations[i].GetCrossCovariance();
+		}
+	});
+
+	DecomposeSVD3x3(covariances.data(), count, u.data(), singularValues.data(), v.data());
+
+	ParallelFor(0, count, REGISTRATION_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			const RigidRegistration& registration = registrations[i];
+
+			if (registration.GetCount() == 0)
+			{
+				rotations[i] = Quaternion(1.0f, 0.0f, 0.0f, 0.0f);
+				translations[i] = Vector3();
+				continue;
+			}
+
+			Matrix3x3 rotation = ComputeOptimalRotation(u[i], v[i]);
+
+			rotations[i] = Quaternion::CreateFromRotationMatrix(rotation);
+			translations[i] = ComputeTranslation(rotation, 1.0f, registration.GetSourceMean(), registration.GetTargetMean());
+		}
+	});
+}
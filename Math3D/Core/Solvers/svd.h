@@ -0,0 +1,72 @@
+#pragma once
+#include "quaternion.h"
+#include "math3dhelpers.h"
+
+namespace math3d
+{
+	//
+	// Signed 3x3 SVD after McAdams et al. 2011: Jacobi eigenanalysis of A^T A with a fixed
+	// sweep count gives V, Givens QR of A V gives U and the singular values. U and V are
+	// always proper rotations, singular values are sorted by magnitude and only the last
+	// one carries the sign of det(A). A = U * diag(singularValues) * V^T
+	//
+	void DecomposeSVD3x3(const Matrix3x3& matrix, Matrix3x3& u, Vector3& singularValues, Matrix3x3& v);
+	void DecomposeSVD3x3(const Matrix3x3* matrices, uint_t count, Matrix3x3* u, Vector3* singularValues, Matrix3x3* v);
+
+	/* A = rotation * stretch, stretch is symmetric (indefinite when det(A) < 0) */
+	void DecomposePolar3x3(const Matrix3x3& matrix, Matrix3x3& rotation, Matrix3x3& stretch);
+
+	//
+	// Streaming Kabsch / Umeyama solver. Correspondences are accumulated in one pass
+	// (weighted sums in double around the first correspondence), Solve returns the rotation and translation minimizing
+	// sum w * |R * source + t - target|^2, optionally with uniform scale.
+	//
+	class RigidRegistration
+	{
+	private:
+		uint_t count;
+		double weightSum;
+		double sourceOrigin[3];
+		double targetOrigin[3];
+		double sourceSum[3];
+		double targetSum[3];
+		double crossSum[9];
+		double sourceSquaredSum;
+
+	public:
+		RigidRegistration();
+		RigidRegistration(const RigidRegistration& registration);
+		~RigidRegistration() = default;
+
+		void Reset();
+		void Add(const Vector3& source, const Vector3& target, float weight = 1.0f);
+		void Add(const Vector3* sources, const Vector3* targets, uint_t count);
+		void Merge(const RigidRegistration& registration);
+
+		Vector3 GetSourceMean() const;
+		Vector3 GetTargetMean() const;
+
+		/* Weighted mean of (source - sourceMean) * (target - targetMean)^T */
+		Matrix3x3 GetCrossCovariance() const;
+		double GetSourceVariance() const;
+
+		/* Returns false when no correspondence has been added */
+		bool Solve(Quaternion& rotation, Vector3& translation) const;
+		bool Solve(Quaternion& rotation, Vector3& translation, float& scale) const;
+
+		RigidRegistration& operator=(const RigidRegistration& registration);
+
+		inline uint_t GetCount() const
+		{
+			return this->count;
+		}
+
+		inline double GetWeightSum() const
+		{
+			return this->weightSum;
+		}
+	};
+
+	/* Alignment i uses correspondences [offsets[i], offsets[i + 1]), alignments are solved in parallel */
+	void SolveRigidRegistrations(const Vector3* sources, const Vector3* targets, const uint_t* offsets, uint_t count, Quaternion* rotations, Vector3* translations);
+}
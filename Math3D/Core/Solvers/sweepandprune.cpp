@@ -0,0 +1,259 @@
+#include "sweepandprune.h"
+#include "math3dparallel.h"
+#include "math3dsort.h"
+#include <algorithm>
+
+using namespace math3d;
+
+static const uint_t SAP_BOX_GRAIN = 16384;
+static const uint_t SAP_SWEEP_GRAIN = 1024;
+/* Insertion sort moves allowed per box before the update switches to a radix sort */
+static const uint_t SAP_MOVE_BUDGET = 16;
+
+SweepAndPrune::SweepAndPrune() : axis(0), boxCount(0), lastMoveCount(0), lastResorted(false) {}
+
+void SweepAndPrune::Resort(const AABB* boxes)
+{
+	uint_t count = this->boxCount;
+
+	// Sweep along the axis with the largest spread of box centers
+	double sum[3] = { 0.0, 0.0, 0.0 };
+	double sumSquared[3] = { 0.0, 0.0, 0.0 };
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		const float* boxMin = boxes[i].GetMin().GetData();
+		const float* boxMax = boxes[i].GetMax().GetData();
+
+		for (uint_t k = 0; k < 3; k++)
+		{
+			double center = 0.5 * ((double)boxMin[k] + (double)boxMax[k]);
+
+			sum[k] += center;
+			sumSquared[k] += center * center;
+		}
+	}
+
+	double bestVariance = -1.0;
+
+	for (uint_t k = 0; k < 3; k++)
+	{
+		double variance = sumSquared[k] - sum[k] * sum[k] / (double)count;
+
+		if (variance > bestVariance)
+		{
+			bestVariance = variance;
+			this->axis = k;
+		}
+	}
+
+	this->radixKeys.resize(count);
+	this->radixScratch.resize(count * 2);
+
+	uint_t sweepAxis = this->axis;
+	uint_t* keys = this->radixKeys.data();
+	uint_t* indices = this->order.data();
+
+	ParallelFor(0, count, SAP_BOX_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			keys[i] = FloatToSortKey(boxes[i].GetMin().GetData()[sweepAxis]);
+			indices[i] = i;
+		}
+	});
+
+	RadixSortPairs(keys, indices, this->radixScratch.data(), this->radixScratch.data() + count, count);
+
+	float* sortKeys = this->sortedMin.data();
+
+	ParallelFor(0, count, SAP_BOX_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t s = begin; s < end; s++)
+		{
+			sortKeys[s] = boxes[indices[s]].GetMin().GetData()[sweepAxis];
+		}
+	});
+}
+
+void SweepAndPrune::Update(const AABB* boxes, uint_t count)
+{
+	this->lastMoveCount = 0;
+	this->lastResorted = false;
+
+	if (count != this->boxCount || this->order.size() != count)
+	{
+		this->boxCount = count;
+		this->order.resize(count);
+		this->sortedMin.resize(count);
+		this->sortedMax.resize(count);
+		this->sortedOther.resize(count * 4);
+		this->lastResorted = true;
+		this->Resort(boxes);
+	}
+	else
+	{
+		uint_t sweepAxis = this->axis;
+		const uint_t* indices = this->order.data();
+		float* keys = this->sortedMin.data();
+
+		ParallelFor(0, count, SAP_BOX_GRAIN, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t s = begin; s < end; s++)
+			{
+				keys[s] = boxes[indices[s]].GetMin().GetData()[sweepAxis];
+			}
+		});
+
+		// Insertion sort over the previous order, nearly sorted after coherent motion
+		uint_t* slots = this->order.data();
+		uint_t budget = count * SAP_MOVE_BUDGET;
+		uint_t moves = 0;
+
+		for (uint_t i = 1; i < count && moves <= budget; i++)
+		{
+			float key = keys[i];
+			uint_t index = slots[i];
+			uint_t j = i;
+
+			while (j > 0 && keys[j - 1] > key)
+			{
+				keys[j] = keys[j - 1];
+				slots[j] = slots[j - 1];
+				j--;
+			}
+
+			keys[j] = key;
+			slots[j] = index;
+			moves += i - j;
+		}
+
+		this->lastMoveCount = moves;
+
+		if (moves > budget)
+		{
+			this->lastResorted = true;
+			this->Resort(boxes);
+		}
+	}
+
+	uint_t sweepAxis = this->axis;
+	uint_t axisA = (sweepAxis + 1) % 3;
+	uint_t axisB = (sweepAxis + 2) % 3;
+	const uint_t* indices = this->order.data();
+	float* sweepMax = this->sortedMax.data();
+	float* other = this->sortedOther.data();
+
+	ParallelFor(0, count, SAP_BOX_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t s = begin; s < end; s++)
+		{
+			const float* boxMin = boxes[indices[s]].GetMin().GetData();
+			const float* boxMax = boxes[indices[s]].GetMax().GetData();
+
+			sweepMax[s] = boxMax[sweepAxis];
+			other[s] = boxMin[axisA];
+			other[count + s] = boxMax[axisA];
+			other[count * 2 + s] = boxMin[axisB];
+			other[count * 3 + s] = boxMax[axisB];
+		}
+	});
+}
+
+//
+// Slots after i overlap it along the sweep axis up to the first minimum past its maximum,
+// that run is found by binary search and then tested on the two other axes.
+//
+static inline uint_t GetSweepEnd(const float* sortedMin, const float* sortedMax, uint_t count, uint_t i)
+{
+	return (uint_t)(std::upper_bound(sortedMin + i + 1, sortedMin + count, sortedMax[i]) - sortedMin);
+}
+
+/* Non short circuit and, so the count loop has no branches */
+static inline bool OverlapsOther(const float* other, uint_t count, uint_t i, uint_t j)
+{
+	return (other[i] <= other[count + j]) & (other[j] <= other[count + i]) & (other[count * 2 + i] <= other[count * 3 + j]) & (other[count * 2 + j] <= other[count * 3 + i]);
+}
+
+uint_t SweepAndPrune::FindPairs(uint_t* pairs, uint_t capacity)
+{
+	uint_t count = this->boxCount;
+	const float* sweepMin = this->sortedMin.data();
+	const float* sweepMax = this->sortedMax.data();
+	const float* other = this->sortedOther.data();
+	const uint_t* indices = this->order.data();
+
+	this->slotPairCounts.assign(count + 1, 0);
+
+	uint_t* counts = this->slotPairCounts.data();
+
+	// Count pass (branch free, vectorizes), then a fill pass at exact offsets so the output does not depend on threading
+	ParallelFor(0, count, SAP_SWEEP_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t last = GetSweepEnd(sweepMin, sweepMax, count, i);
+			uint_t found = 0;
+
+			for (uint_t j = i + 1; j < last; j++)
+			{
+				found += OverlapsOther(other, count, i, j) ? 1 : 0;
+			}
+
+			counts[i + 1] = found;
+		}
+	});
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		counts[i + 1] += counts[i];
+	}
+
+	ParallelFor(0, count, SAP_SWEEP_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end && counts[i] < capacity; i++)
+		{
+			uint_t last = GetSweepEnd(sweepMin, sweepMax, count, i);
+			uint_t pair = counts[i];
+
+			for (uint_t j = i + 1; j < last && pair < capacity; j++)
+			{
+				if (OverlapsOther(other, count, i, j))
+				{
+					uint_t a = indices[i];
+					uint_t b = indices[j];
+
+					pairs[pair * 2] = a < b ? a : b;
+					pairs[pair * 2 + 1] = a < b ? b : a;
+					pair++;
+				}
+			}
+		}
+	});
+
+	return counts[count];
+}
+
+uint_t math3d::FindPairsBruteForce(const AABB* boxes, uint_t count, uint_t* pairs, uint_t capacity)
+{
+	uint_t found = 0;
+
+	for (uint_t a = 0; a < count; a++)
+	{
+		for (uint_t b = a + 1; b < count; b++)
+		{
+			if (boxes[a].Overlaps(boxes[b]))
+			{
+				if (found < capacity)
+				{
+					pairs[found * 2] = a;
+					pairs[found * 2 + 1] = b;
+				}
+
+				found++;
+			}
+		}
+	}
+
+	return found;
+}
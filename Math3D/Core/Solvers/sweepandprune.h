@@ -0,0 +1,77 @@
+#pragma once
+#include "geometry.h"
+#include <vector>
+
+namespace math3d
+{
+	//
+	// Single axis sweep and prune broadphase. Boxes are kept sorted by their minimum along the
+	// sweep axis from one update to the next. Coherent motion only needs an insertion sort
+	// over the nearly sorted keys, past a move budget the keys are radix sorted instead.
+	// BenchmarkSweepAndPrune times updates and pair search against FindPairsBruteForce. A
+	// single sweep axis scales with the box density along that axis, sparse or mostly planar
+	// scenes run much faster.
+	//
+	class SweepAndPrune
+	{
+	private:
+		uint_t axis;
+		uint_t boxCount;
+		uint_t lastMoveCount;
+		bool lastResorted;
+		/* Box index per sorted slot */
+		std::vector<uint_t> order;
+		/* Sort keys (minimum along the sweep axis) per slot */
+		std::vector<float> sortedMin;
+		std::vector<float> sortedMax;
+		/* Bounds on the two other axes per slot, four arrays (min, max, min, max) of count floats */
+		std::vector<float> sortedOther;
+		std::vector<uint_t> slotPairCounts;
+		std::vector<uint_t> radixKeys;
+		std::vector<uint_t> radixScratch;
+
+		void Resort(const AABB* boxes);
+
+	public:
+		SweepAndPrune();
+		SweepAndPrune(const SweepAndPrune& sap) = default;
+		~SweepAndPrune() = default;
+
+		/* Same boxes in the same order as the last update, anything else is a full rebuild */
+		void Update(const AABB* boxes, uint_t count);
+
+		//
+		// Writes overlapping pairs (a, b) with a < b, two indices per pair, grouped by sorted slot.
+		// Returns the total number of pairs, only the first capacity pairs are written so a
+		// caller can grow its buffer and call again. The sweep runs over all hardware threads.
+		//
+		uint_t FindPairs(uint_t* pairs, uint_t capacity);
+
+		SweepAndPrune& operator=(const SweepAndPrune& sap) = default;
+
+		inline uint_t GetAxis() const
+		{
+			return this->axis;
+		}
+
+		inline uint_t GetBoxCount() const
+		{
+			return this->boxCount;
+		}
+
+		/* Insertion sort moves of the last update */
+		inline uint_t GetLastMoveCount() const
+		{
+			return this->lastMoveCount;
+		}
+
+		/* True when the last update fell back to a full radix sort */
+		inline bool WasLastResorted() const
+		{
+			return this->lastResorted;
+		}
+	};
+
+	/* Reference O(n^2) pair search with the same output convention */
+	uint_t FindPairsBruteForce(const AABB* boxes, uint_t count, uint_t* pairs, uint_t capacity);
+}
@@ -0,0 +1,314 @@
+#include "affine.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include "math3dexceptions.h"
+#include <cmath>
+
+using namespace math3d;
+
+static const uint_t AFFINE_BATCH_GRAIN = 4096;
+/* Smallest |det| / Hadamard bound (product of the column norms of L) Inverse accepts */
+static const float AFFINE_SINGULAR_TOLERANCE = 1e-6f;
+
+Affine3::Affine3()
+{
+	for (uint_t i = 0; i < 12; i++)
+	{
+		this->values[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+	}
+}
+
+Affine3::Affine3(const float* values)
+{
+	for (uint_t i = 0; i < 12; i++)
+	{
+		this->values[i] = values[i];
+	}
+}
+
+Affine3::Affine3(const Matrix3x3& linear, const Vector3& translation)
+{
+	const float* l = linear.GetData();
+	const float* t = translation.GetData();
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		this->values[r * 4] = l[r * 3];
+		this->values[r * 4 + 1] = l[r * 3 + 1];
+		this->values[r * 4 + 2] = l[r * 3 + 2];
+		this->values[r * 4 + 3] = t[r];
+	}
+}
+
+Affine3::Affine3(const Quaternion& rotation, const Vector3& translation) : Affine3(rotation.GetRotationMatrix(), translation) {}
+
+/* The last row of the matrix is dropped, it is assumed to be (0, 0, 0, 1) */
+Affine3::Affine3(const Matrix4x4& matrix) : Affine3(matrix.GetData()) {}
+
+Affine3::Affine3(const Affine3& affine) : Affine3(affine.values) {}
+
+Vector3 Affine3::TransformPoint(const Vector3& point) const
+{
+	const float* m = this->values;
+	const float* p = point.GetData();
+
+	return CreateVector3(
+		m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3],
+		m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7],
+		m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11]);
+}
+
+Vector3 Affine3::TransformDirection(const Vector3& direction) const
+{
+	const float* m = this->values;
+	const float* d = direction.GetData();
+
+	return CreateVector3(
+		m[0] * d[0] + m[1] * d[1] + m[2] * d[2],
+		m[4] * d[0] + m[5] * d[1] + m[6] * d[2],
+		m[8] * d[0] + m[9] * d[1] + m[10] * d[2]);
+}
+
+float Affine3::Determinant() const
+{
+	const float* m = this->values;
+
+	return m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8]) + m[2] * (m[4] * m[9] - m[5] * m[8]);
+}
+
+void Affine3::Inverse()
+{
+	*this = Affine3::Inverse(*this);
+}
+
+void Affine3::InverseRigid()
+{
+	*this = Affine3::InverseRigid(*this);
+}
+
+Matrix3x3 Affine3::GetLinear() const
+{
+	const float* m = this->values;
+	float linear[9] = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+
+	return Matrix3x3(linear);
+}
+
+Vector3 Affine3::GetTranslation() const
+{
+	return CreateVector3(this->values[3], this->values[7], this->values[11]);
+}
+
+void Affine3::SetTranslation(const Vector3& translation)
+{
+	const float* t = translation.GetData();
+
+	this->values[3] = t[0];
+	this->values[7] = t[1];
+	this->values[11] = t[2];
+}
+
+/* Assumes the linear part is a pure rotation */
+Quaternion Affine3::GetRotation() const
+{
+	return Quaternion::CreateFromRotationMatrix(this->GetLinear());
+}
+
+Matrix4x4 Affine3::GetMatrix4x4() const
+{
+	float matrix[16];
+
+	for (uint_t i = 0; i < 12; i++)
+	{
+		matrix[i] = this->values[i];
+	}
+
+	matrix[12] = 0.0f;
+	matrix[13] = 0.0f;
+	matrix[14] = 0.0f;
+	matrix[15] = 1.0f;
+
+	return Matrix4x4(matrix);
+}
+
+Affine3 Affine3::Inverse(const Affine3& affine)
+{
+	const float* m = affine.values;
+	float det = affine.Determinant();
+	float c0 = std::sqrt(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+	float c1 = std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+	float c2 = std::sqrt(m[2] * m[2] + m[6] * m[6] + m[10] * m[10]);
+
+	// Relative to the scale of L, so small but well conditioned transforms stay invertible
+	if (!(Abs(det) > AFFINE_SINGULAR_TOLERANCE * (c0 * c1 * c2)))
+	{
+		throw MatrixNonReversible();
+	}
+
+	float invDet = 1.0f / det;
+	float ret[12];
+
+	ret[0] = (m[5] * m[10] - m[6] * m[9]) * invDet;
+	ret[1] = (m[2] * m[9] - m[1] * m[10]) * invDet;
+	ret[2] = (m[1] * m[6] - m[2] * m[5]) * invDet;
+	ret[4] = (m[6] * m[8] - m[4] * m[10]) * invDet;
+	ret[5] = (m[0] * m[10] - m[2] * m[8]) * invDet;
+	ret[6] = (m[2] * m[4] - m[0] * m[6]) * invDet;
+	ret[8] = (m[4] * m[9] - m[5] * m[8]) * invDet;
+	ret[9] = (m[1] * m[8] - m[0] * m[9]) * invDet;
+	ret[10] = (m[0] * m[5] - m[1] * m[4]) * invDet;
+
+	// t' = -L^-1 * t
+	for (uint_t r = 0; r < 3; r++)
+	{
+		ret[r * 4 + 3] = -(ret[r * 4] * m[3] + ret[r * 4 + 1] * m[7] + ret[r * 4 + 2] * m[11]);
+	}
+
+	return Affine3(ret);
+}
+
+Affine3 Affine3::InverseRigid(const Affine3& affine)
+{
+	const float* m = affine.values;
+	float ret[12] = {
+		m[0], m[4], m[8], 0.0f,
+		m[1], m[5], m[9], 0.0f,
+		m[2], m[6], m[10], 0.0f
+	};
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		ret[r * 4 + 3] = -(ret[r * 4] * m[3] + ret[r * 4 + 1] * m[7] + ret[r * 4 + 2] * m[11]);
+	}
+
+	return Affine3(ret);
+}
+
+Affine3 Affine3::CreateIdentity()
+{
+	return Affine3();
+}
+
+Affine3 Affine3::CreateTranslation(const Vector3& translation)
+{
+	Affine3 ret;
+	ret.SetTranslation(translation);
+
+	return ret;
+}
+
+Affine3 Affine3::CreateScale(const Vector3& scale)
+{
+	const float* s = scale.GetData();
+	Affine3 ret;
+
+	ret.values[0] = s[0];
+	ret.values[5] = s[1];
+	ret.values[10] = s[2];
+
+	return ret;
+}
+
+Affine3& Affine3::operator=(const Affine3& affine)
+{
+	for (uint_t i = 0; i < 12; i++)
+	{
+		this->values[i] = affine.values[i];
+	}
+
+	return *this;
+}
+
+Affine3& Affine3::operator*=(const Affine3& affine)
+{
+	const float* a = this->values;
+	const float* b = affine.values;
+	float ret[12];
+
+	for (uint_t r = 0; r < 3; r++)
+	{
+		for (uint_t c = 0; c < 4; c++)
+		{
+			ret[r * 4 + c] = a[r * 4] * b[c] + a[r * 4 + 1] * b[4 + c] + a[r * 4 + 2] * b[8 + c];
+		}
+
+		ret[r * 4 + 3] += a[r * 4 + 3];
+	}
+
+	for (uint_t i = 0; i < 12; i++)
+	{
+		this->values[i] = ret[i];
+	}
+
+	return *this;
+}
+
+//
+// Batched forms
+//
+
+void math3d::TransformPoints(const Affine3& affine, const Vector3* points, uint_t count, Vector3* out)
+{
+	const float* m = affine.GetData();
+
+	ParallelFor(0, count, AFFINE_BATCH_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		const float* src = points[0].GetData();
+		float* dst = out[0].GetData();
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			float x = src[i * 3];
+			float y = src[i * 3 + 1];
+			float z = src[i * 3 + 2];
+
+			dst[i * 3] = m[0] * x + m[1] * y + m[2] * z + m[3];
+			dst[i * 3 + 1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+			dst[i * 3 + 2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+		}
+	});
+}
+
+void math3d::TransformDirections(const Affine3& affine, const Vector3* directions, uint_t count, Vector3* out)
+{
+	const float* m = affine.GetData();
+
+	ParallelFor(0, count, AFFINE_BATCH_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		const float* src = directions[0].GetData();
+		float* dst = out[0].GetData();
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			float x = src[i * 3];
+			float y = src[i * 3 + 1];
+			float z = src[i * 3 + 2];
+
+			dst[i * 3] = m[0] * x + m[1] * y + m[2] * z;
+			dst[i * 3 + 1] = m[4] * x + m[5] * y + m[6] * z;
+			dst[i * 3 + 2] = m[8] * x + m[9] * y + m[10] * z;
+		}
+	});
+}
+
+void math3d::ComposeAffines(const Affine3* affinesA, const Affine3* affinesB, uint_t count, Affine3* out)
+{
+	ParallelFor(0, count, AFFINE_BATCH_GRAIN / 4, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			out[i] = affinesA[i] * affinesB[i];
+		}
+	});
+}
+
+void math3d::InverseRigidAffines(const Affine3* affines, uint_t count, Affine3* out)
+{
+	ParallelFor(0, count, AFFINE_BATCH_GRAIN / 4, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			out[i] = Affine3::InverseRigid(affines[i]);
+		}
+	});
+}
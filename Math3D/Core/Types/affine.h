@@ -0,0 +1,90 @@
+#pragma once
+#include "quaternion.h"
+#include "math3dhelpers.h"
+#include <iostream>
+
+namespace math3d
+{
+	//
+	// Affine transform stored as the top 3x4 of a 4x4 matrix, row major [L | t].
+	// Acts on column vectors like Matrix4x4, the implicit last row is (0, 0, 0, 1).
+	// Compose costs 36 mul / 27 add against 64 / 48 for Matrix4x4.
+	//
+	class Affine3
+	{
+	private:
+		float values[12];
+
+	public:
+		Affine3();
+		Affine3(const float* values);
+		Affine3(const Matrix3x3& linear, const Vector3& translation);
+		Affine3(const Quaternion& rotation, const Vector3& translation);
+		/* Drops the bottom row, explicit so Matrix4x4 products never turn into affine ones */
+		explicit Affine3(const Matrix4x4& matrix);
+		Affine3(const Affine3& affine);
+		~Affine3() = default;
+
+		Vector3 TransformPoint(const Vector3& point) const;
+		Vector3 TransformDirection(const Vector3& direction) const;
+		float Determinant() const;
+		void Inverse();
+		void InverseRigid();
+		Matrix3x3 GetLinear() const;
+		Vector3 GetTranslation() const;
+		void SetTranslation(const Vector3& translation);
+		Quaternion GetRotation() const;
+		Matrix4x4 GetMatrix4x4() const;
+
+		/* General inverse through the 3x3 adjugate, throws MatrixNonReversible when L is singular relative to its scale */
+		static Affine3 Inverse(const Affine3& affine);
+		/* Transposed rotation and rotated translation, only valid for rotation + translation */
+		static Affine3 InverseRigid(const Affine3& affine);
+		static Affine3 CreateIdentity();
+		static Affine3 CreateTranslation(const Vector3& translation);
+		static Affine3 CreateScale(const Vector3& scale);
+
+		Affine3& operator=(const Affine3& affine);
+		/* this = this * affine, affine is applied first */
+		Affine3& operator*=(const Affine3& affine);
+
+		inline const float* GetData() const
+		{
+			return this->values;
+		}
+
+		inline float* GetData()
+		{
+			return this->values;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const Affine3& affine)
+		{
+			out << "A(\n";
+
+			for (uint_t i = 0; i < 3; i++)
+			{
+				const float* row = affine.values + i * 4;
+				out << "  " << row[0] << ", " << row[1] << ", " << row[2] << " | " << row[3] << '\n';
+			}
+
+			out << ")\n";
+
+			return out;
+		}
+	};
+
+	inline Affine3 operator*(Affine3 affineA, const Affine3& affineB)
+	{
+		return affineA *= affineB;
+	}
+
+	//
+	// Batched forms, split in parallel chunks for large counts. out may alias in.
+	//
+	void TransformPoints(const Affine3& affine, const Vector3* points, uint_t count, Vector3* out);
+	void TransformDirections(const Affine3& affine, const Vector3* directions, uint_t count, Vector3* out);
+	/* out[i] = affinesA[i] * affinesB[i], e.g. parent world * local for a flattened hierarchy level */
+	void ComposeAffines(const Affine3* affinesA, const Affine3* affinesB, uint_t count, Affine3* out);
+	void InverseRigidAffines(const Affine3* affines, uint_t count, Affine3* out);
+}
@@ -0,0 +1,361 @@
+#include "animation.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include "math3dexceptions.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace math3d;
+
+static const uint_t CURSOR_LINEAR_STEPS = 4;
+static const uint_t ANIMATION_TRACK_GRAIN = 1024;
+static const uint_t ROTATION_SCRATCH_STRIDE = 9;
+
+AnimationClip::AnimationClip() : vectorOffsets(1, 0), rotationOffsets(1, 0), duration(0.0f) {}
+
+uint_t AnimationClip::AddVectorTrack(const float* times, const Vector3* values, uint_t count)
+{
+	if (count == 0)
+	{
+		throw AnimationInvalidTrack();
+	}
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		const float* v = values[i].GetData();
+
+		this->vectorTimes.push_back(times[i]);
+		this->vectorX.push_back(v[0]);
+		this->vectorY.push_back(v[1]);
+		this->vectorZ.push_back(v[2]);
+	}
+
+	this->vectorOffsets.push_back((uint_t)this->vectorTimes.size());
+	this->duration = Max(this->duration, times[count - 1]);
+
+	return this->GetVectorTrackCount() - 1;
+}
+
+uint_t AnimationClip::AddRotationTrack(const float* times, const Quaternion* values, uint_t count)
+{
+	if (count == 0)
+	{
+		throw AnimationInvalidTrack();
+	}
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		this->rotationTimes.push_back(times[i]);
+		this->rotationW.push_back((float)values[i].GetW());
+		this->rotationX.push_back((float)values[i].GetX());
+		this->rotationY.push_back((float)values[i].GetY());
+		this->rotationZ.push_back((float)values[i].GetZ());
+	}
+
+	this->rotationOffsets.push_back((uint_t)this->rotationTimes.size());
+	this->duration = Max(this->duration, times[count - 1]);
+
+	return this->GetRotationTrackCount() - 1;
+}
+
+//
+// Key interval [k, k + 1] containing time, starting from the cached cursor.
+// Tracks with a single key always return 0, the caller then reads the same key twice.
+//
+static inline uint_t FindKey(const float* times, uint_t count, float time, uint_t cursor)
+{
+	if (count < 2)
+	{
+		return 0;
+	}
+
+	uint_t last = count - 2;
+	uint_t k = cursor < last ? cursor : last;
+
+	if (time >= times[k])
+	{
+		for (uint_t step = 0; step < CURSOR_LINEAR_STEPS && k < last && time >= times[k + 1]; step++)
+		{
+			k++;
+		}
+
+		if (k == last || time < times[k + 1])
+		{
+			return k;
+		}
+	}
+
+	uint_t upper = (uint_t)(std::upper_bound(times, times + count, time) - times);
+
+	k = upper == 0 ? 0 : upper - 1;
+
+	return k < last ? k : last;
+}
+
+static inline float GetKeyAlpha(const float* times, uint_t count, uint_t key, float time)
+{
+	if (count < 2)
+	{
+		return 0.0f;
+	}
+
+	float span = times[key + 1] - times[key];
+	float alpha = span > 0.0f ? (time - times[key]) / span : 0.0f;
+
+	return Max(0.0f, Min(1.0f, alpha));
+}
+
+/* Shortest arc slerp, falls back to a normalized lerp when the rotations are nearly equal */
+static inline void SlerpComponents(const float* a, const float* b, float alpha, float* out)
+{
+	float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+	float sign = dot < 0.0f ? -1.0f : 1.0f;
+
+	dot = Min(dot * sign, 1.0f);
+
+	float theta = std::acos(dot);
+	float sinTheta = std::sqrt(1.0f - dot * dot);
+	bool small = sinTheta < 1e-4f;
+	float invSin = small ? 1.0f : 1.0f / sinTheta;
+	float weightA = small ? 1.0f - alpha : std::sin((1.0f - alpha) * theta) * invSin;
+	float weightB = (small ? alpha : std::sin(alpha * theta) * invSin) * sign;
+
+	float w = weightA * a[0] + weightB * b[0];
+	float x = weightA * a[1] + weightB * b[1];
+	float y = weightA * a[2] + weightB * b[2];
+	float z = weightA * a[3] + weightB * b[3];
+	float invLength = 1.0f / std::sqrt(w * w + x * x + y * y + z * z);
+
+	out[0] = w * invLength;
+	out[1] = x * invLength;
+	out[2] = y * invLength;
+	out[3] = z * invLength;
+}
+
+Vector3 AnimationClip::SampleVectorTrack(uint_t track, float time) const
+{
+	if (track >= this->GetVectorTrackCount())
+	{
+		throw AnimationInvalidTrack();
+	}
+
+	uint_t first = this->vectorOffsets[track];
+	uint_t count = this->vectorOffsets[track + 1] - first;
+	const float* times = this->vectorTimes.data() + first;
+
+	uint_t key = FindKey(times, count, time, 0);
+	float alpha = GetKeyAlpha(times, count, key, time);
+	uint_t a = first + key;
+	uint_t b = count < 2 ? a : a + 1;
+
+	return CreateVector3(
+		this->vectorX[a] + (this->vectorX[b] - this->vectorX[a]) * alpha,
+		this->vectorY[a] + (this->vectorY[b] - this->vectorY[a]) * alpha,
+		this->vectorZ[a] + (this->vectorZ[b] - this->vectorZ[a]) * alpha);
+}
+
+Quaternion AnimationClip::SampleRotationTrack(uint_t track, float time) const
+{
+	if (track >= this->GetRotationTrackCount())
+	{
+		throw AnimationInvalidTrack();
+	}
+
+	uint_t first = this->rotationOffsets[track];
+	uint_t count = this->rotationOffsets[track + 1] - first;
+	const float* times = this->rotationTimes.data() + first;
+
+	uint_t key = FindKey(times, count, time, 0);
+	float alpha = GetKeyAlpha(times, count, key, time);
+	uint_t a = first + key;
+	uint_t b = count < 2 ? a : a + 1;
+
+	float qa[4] = { this->rotationW[a], this->rotationX[a], this->rotationY[a], this->rotationZ[a] };
+	float qb[4] = { this->rotationW[b], this->rotationX[b], this->rotationY[b], this->rotationZ[b] };
+	float q[4];
+
+	SlerpComponents(qa, qb, alpha, q);
+
+	return Quaternion(q[0], q[1], q[2], q[3]);
+}
+
+//
+// AnimationSampler
+//
+
+AnimationSampler::AnimationSampler(const AnimationClip& clip) : clip(&clip)
+{
+	this->Reset();
+}
+
+void AnimationSampler::Reset()
+{
+	this->vectorCursors.assign(this->clip->GetVectorTrackCount(), 0);
+	this->rotationCursors.assign(this->clip->GetRotationTrackCount(), 0);
+	this->rotationScratch.resize(this->clip->GetRotationTrackCount() * ROTATION_SCRATCH_STRIDE);
+}
+
+void AnimationSampler::Sample(float time, AnimationPose& pose)
+{
+	const AnimationClip& source = *this->clip;
+	uint_t vectorCount = source.GetVectorTrackCount();
+	uint_t rotationCount = source.GetRotationTrackCount();
+
+	// The clip may have grown since the sampler was created
+	if (this->vectorCursors.size() != vectorCount || this->rotationCursors.size() != rotationCount)
+	{
+		this->Reset();
+	}
+
+	pose.vectors.resize(vectorCount);
+	pose.rotations.resize(rotationCount);
+
+	uint_t* vectorCursors = this->vectorCursors.data();
+	Vector3* vectors = pose.vectors.data();
+
+	ParallelFor(0, vectorCount, ANIMATION_TRACK_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		const uint_t* offsets = source.vectorOffsets.data();
+		const float* x = source.vectorX.data();
+		const float* y = source.vectorY.data();
+		const float* z = source.vectorZ.data();
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t first = offsets[i];
+			uint_t count = offsets[i + 1] - first;
+			const float* times = source.vectorTimes.data() + first;
+
+			uint_t key = FindKey(times, count, time, vectorCursors[i]);
+			float alpha = GetKeyAlpha(times, count, key, time);
+			uint_t a = first + key;
+			uint_t b = count < 2 ? a : a + 1;
+
+			vectorCursors[i] = key;
+
+			float* out = vectors[i].GetData();
+			out[0] = x[a] + (x[b] - x[a]) * alpha;
+			out[1] = y[a] + (y[b] - y[a]) * alpha;
+			out[2] = z[a] + (z[b] - z[a]) * alpha;
+		}
+	});
+
+	uint_t* rotationCursors = this->rotationCursors.data();
+	float* scratch = this->rotationScratch.data();
+	Quaternion* rotations = pose.rotations.data();
+
+	ParallelFor(0, rotationCount, ANIMATION_TRACK_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		const uint_t* offsets = source.rotationOffsets.data();
+		const float* components[4] = { source.rotationW.data(), source.rotationX.data(), source.rotationY.data(), source.rotationZ.data() };
+		uint_t n = rotationCount;
+
+		// Gather pass: cursor lookup and both endpoint keys per track into SoA scratch
+		for (uint_t i = begin; i < end; i++)
+		{
+			uint_t first = offsets[i];
+			uint_t count = offsets[i + 1] - first;
+			const float* times = source.rotationTimes.data() + first;
+
+			uint_t key = FindKey(times, count, time, rotationCursors[i]);
+			uint_t a = first + key;
+			uint_t b = count < 2 ? a : a + 1;
+
+			rotationCursors[i] = key;
+
+			for (uint_t c = 0; c < 4; c++)
+			{
+				scratch[c * n + i] = components[c][a];
+				scratch[(4 + c) * n + i] = components[c][b];
+			}
+
+			scratch[8 * n + i] = GetKeyAlpha(times, count, key, time);
+		}
+
+		// Interpolation pass, no lookups left so the loop is branch free over tracks
+		for (uint_t i = begin; i < end; i++)
+		{
+			float qa[4] = { scratch[i], scratch[n + i], scratch[2 * n + i], scratch[3 * n + i] };
+			float qb[4] = { scratch[4 * n + i], scratch[5 * n + i], scratch[6 * n + i], scratch[7 * n + i] };
+			float q[4];
+
+			SlerpComponents(qa, qb, scratch[8 * n + i], q);
+
+			rotations[i] = Quaternion(q[0], q[1], q[2], q[3]);
+		}
+	});
+}
+
+void math3d::BlendPoses(const AnimationPose* poses, const float* weights, uint_t count, AnimationPose& result)
+{
+	if (count == 0)
+	{
+		result.vectors.clear();
+		result.rotations.clear();
+
+		return;
+	}
+
+	uint_t vectorCount = (uint_t)poses[0].vectors.size();
+	uint_t rotationCount = (uint_t)poses[0].rotations.size();
+	float weightSum = 0.0f;
+
+	for (uint_t p = 0; p < count; p++)
+	{
+		if (poses[p].vectors.size() != vectorCount || poses[p].rotations.size() != rotationCount)
+		{
+			throw AnimationPoseMismatch();
+		}
+
+		weightSum += weights[p];
+	}
+
+	float invWeight = weightSum > 0.0f ? 1.0f / weightSum : 0.0f;
+
+	result.vectors.resize(vectorCount);
+	result.rotations.resize(rotationCount);
+
+	ParallelFor(0, vectorCount, ANIMATION_TRACK_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			float sum[3] = { 0.0f, 0.0f, 0.0f };
+
+			for (uint_t p = 0; p < count; p++)
+			{
+				const float* v = poses[p].vectors[i].GetData();
+
+				sum[0] += v[0] * weights[p];
+				sum[1] += v[1] * weights[p];
+				sum[2] += v[2] * weights[p];
+			}
+
+			result.vectors[i] = CreateVector3(sum[0] * invWeight, sum[1] * invWeight, sum[2] * invWeight);
+		}
+	});
+
+	ParallelFor(0, rotationCount, ANIMATION_TRACK_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			const Quaternion& reference = poses[0].rotations[i];
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+			for (uint_t p = 0; p < count; p++)
+			{
+				const Quaternion& q = poses[p].rotations[i];
+				float weight = Quaternion::DotProduct(reference, q) < 0.0 ? -weights[p] : weights[p];
+
+				sum[0] += (float)q.GetW() * weight;
+				sum[1] += (float)q.GetX() * weight;
+				sum[2] += (float)q.GetY() * weight;
+				sum[3] += (float)q.GetZ() * weight;
+			}
+
+			float lengthSquared = sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2] + sum[3] * sum[3];
+			float invLength = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+
+			result.rotations[i] = lengthSquared > 0.0f ? Quaternion(sum[0] * invLength, sum[1] * invLength, sum[2] * invLength, sum[3] * invLength) : reference;
+		}
+	});
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "quaternion.h"
+#include "math3dhelpers.h"
+#include <vector>
+
+namespace math3d
+{
+	//
+	// Keyframe clip, keys of all tracks are stored back to back in SoA arrays (times and one
+	// array per component), track i spans keys [offsets[i], offsets[i + 1]).
+	// Vector tracks (translation, scale) are linearly interpolated, rotation tracks are slerped.
+	//
+	class AnimationClip
+	{
+	private:
+		std::vector<uint_t> vectorOffsets;
+		std::vector<float> vectorTimes;
+		std::vector<float> vectorX;
+		std::vector<float> vectorY;
+		std::vector<float> vectorZ;
+
+		std::vector<uint_t> rotationOffsets;
+		std::vector<float> rotationTimes;
+		std::vector<float> rotationW;
+		std::vector<float> rotationX;
+		std::vector<float> rotationY;
+		std::vector<float> rotationZ;
+
+		float duration;
+
+		friend class AnimationSampler;
+
+	public:
+		AnimationClip();
+		AnimationClip(const AnimationClip& clip) = default;
+		~AnimationClip() = default;
+
+		/* Keys must be sorted by time, returns the track index */
+		uint_t AddVectorTrack(const float* times, const Vector3* values, uint_t count);
+		uint_t AddRotationTrack(const float* times, const Quaternion* values, uint_t count);
+
+		/* Stateless sampling with a binary search, for random access */
+		Vector3 SampleVectorTrack(uint_t track, float time) const;
+		Quaternion SampleRotationTrack(uint_t track, float time) const;
+
+		AnimationClip& operator=(const AnimationClip& clip) = default;
+
+		inline uint_t GetVectorTrackCount() const
+		{
+			return (uint_t)this->vectorOffsets.size() - 1;
+		}
+
+		inline uint_t GetRotationTrackCount() const
+		{
+			return (uint_t)this->rotationOffsets.size() - 1;
+		}
+
+		/* Time of the last key over all tracks */
+		inline float GetDuration() const
+		{
+			return this->duration;
+		}
+	};
+
+	struct AnimationPose
+	{
+		std::vector<Vector3> vectors;
+		std::vector<Quaternion> rotations;
+	};
+
+	//
+	// Playback state of one clip instance. Every track keeps the key interval used by the
+	// previous sample, for forward playback the next lookup is a compare or a short scan and
+	// only jumps (seek, loop wrap) fall back to a binary search.
+	// All tracks are sampled in one batched pass, large clips are split over the hardware threads.
+	// BenchmarkAnimation compares it with stateless binary search sampling.
+	//
+	class AnimationSampler
+	{
+	private:
+		const AnimationClip* clip;
+		std::vector<uint_t> vectorCursors;
+		std::vector<uint_t> rotationCursors;
+		/* Rotation endpoints and blend factor gathered per track, SoA so the slerp runs over lanes */
+		std::vector<float> rotationScratch;
+
+	public:
+		AnimationSampler(const AnimationClip& clip);
+		AnimationSampler(const AnimationSampler& sampler) = default;
+		~AnimationSampler() = default;
+
+		/* Time is clamped to the key range of each track, pose is resized to the clip layout */
+		void Sample(float time, AnimationPose& pose);
+		void Reset();
+
+		AnimationSampler& operator=(const AnimationSampler& sampler) = default;
+
+		inline const AnimationClip& GetClip() const
+		{
+			return *this->clip;
+		}
+	};
+
+	/* Weighted blend of poses with the same layout, vectors are averaged, rotations nlerped on the shortest arc */
+	void BlendPoses(const AnimationPose* poses, const float* weights, uint_t count, AnimationPose& result);
+}
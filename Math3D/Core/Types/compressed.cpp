@@ -0,0 +1,678 @@
+#include "compressed.h"
+#include "math3dutil.h"
+#include <cmath>
+#include <cstring>
+
+// GCC and Clang only enable F16C with -mf16c (or a -march that has it), -mavx2 alone does not.
+// MSVC has no __F16C__ and every /arch:AVX2 target supports F16C.
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define MATH3D_F16C
+#endif
+
+#if defined(__AVX__) || defined(__AVX2__)
+#include <immintrin.h>
+#define MATH3D_AVX
+#endif
+
+using namespace math3d;
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 arrays are treated as tightly packed floats");
+
+static inline unsigned int FloatBits(float value)
+{
+	unsigned int bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	return bits;
+}
+
+static inline float BitsFloat(unsigned int bits)
+{
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+/* Round to nearest even, overflow saturates to infinity, NaN stays NaN */
+unsigned short math3d::FloatToHalf(float value)
+{
+	unsigned int bits = FloatBits(value);
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int absBits = bits & 0x7FFFFFFF;
+	unsigned int half;
+
+	if (absBits >= 0x47800000)
+	{
+		half = absBits > 0x7F800000 ? 0x7E00 : 0x7C00;
+	}
+	else if (absBits < 0x38800000)
+	{
+		// Subnormal half, let the FPU do the rounding by aligning against 0.5f
+		half = FloatBits(BitsFloat(absBits) + 0.5f) - 0x3F000000;
+	}
+	else
+	{
+		unsigned int mantissaOdd = (absBits >> 13) & 1;
+
+		absBits += 0xC8000FFF;
+		absBits += mantissaOdd;
+		half = absBits >> 13;
+	}
+
+	return (unsigned short)(half | sign);
+}
+
+float math3d::HalfToFloat(unsigned short value)
+{
+	const unsigned int shiftedExponent = 0x7C00 << 13;
+
+	unsigned int bits = (value & 0x7FFF) << 13;
+	unsigned int exponent = bits & shiftedExponent;
+
+	bits += (127 - 15) << 23;
+
+	if (exponent == shiftedExponent)
+	{
+		bits += (128 - 16) << 23;
+	}
+	else if (exponent == 0)
+	{
+		bits += 1 << 23;
+		bits = FloatBits(BitsFloat(bits) - BitsFloat(113 << 23));
+	}
+
+	return BitsFloat(bits | ((value & 0x8000) << 16));
+}
+
+//
+// Smallest three: drop the largest magnitude component (recovered from the unit
+// constraint), flip the sign so it is positive and quantize the remaining three
+// which all lie in [-1/sqrt(2), 1/sqrt(2)]. The largest component comes from a compare
+// tournament, lowest index on ties, and the kept ones from selects, so the batched loops
+// have no data dependent branches.
+//
+
+static inline void EncodeSmallestThree(const Quaternion& quat, const unsigned int maxValue, unsigned int& largest, unsigned int* quantized)
+{
+	float c0 = (float)quat.GetW();
+	float c1 = (float)quat.GetX();
+	float c2 = (float)quat.GetY();
+	float c3 = (float)quat.GetZ();
+	float invMagnitude = 1.0f / std::sqrt(c0 * c0 + c1 * c1 + c2 * c2 + c3 * c3);
+
+	float a0 = Abs(c0);
+	float a1 = Abs(c1);
+	float a2 = Abs(c2);
+	float a3 = Abs(c3);
+	unsigned int lowIndex = a1 > a0 ? 1 : 0;
+	unsigned int highIndex = a3 > a2 ? 3 : 2;
+
+	largest = Max(a2, a3) > Max(a0, a1) ? highIndex : lowIndex;
+
+	float dropped = largest == 0 ? c0 : largest == 1 ? c1 : largest == 2 ? c2 : c3;
+	float kept0 = largest == 0 ? c1 : c0;
+	float kept1 = largest <= 1 ? c2 : c1;
+	float kept2 = largest <= 2 ? c3 : c2;
+	float scale = (dropped < 0.0f ? -invMagnitude : invMagnitude) * (float)SQRT_TWO * 0.5f;
+
+	quantized[0] = (unsigned int)(Min(Max(kept0 * scale + 0.5f, 0.0f), 1.0f) * maxValue + 0.5f);
+	quantized[1] = (unsigned int)(Min(Max(kept1 * scale + 0.5f, 0.0f), 1.0f) * maxValue + 0.5f);
+	quantized[2] = (unsigned int)(Min(Max(kept2 * scale + 0.5f, 0.0f), 1.0f) * maxValue + 0.5f);
+}
+
+static inline Quaternion DecodeSmallestThree(const unsigned int maxValue, const unsigned int largest, const unsigned int* quantized)
+{
+	float scale = 1.0f / maxValue;
+	float kept0 = (quantized[0] * scale - 0.5f) * (float)SQRT_TWO;
+	float kept1 = (quantized[1] * scale - 0.5f) * (float)SQRT_TWO;
+	float kept2 = (quantized[2] * scale - 0.5f) * (float)SQRT_TWO;
+	float dropped = std::sqrt(Max(1.0f - (kept0 * kept0 + kept1 * kept1 + kept2 * kept2), 0.0f));
+
+	float c0 = largest == 0 ? dropped : kept0;
+	float c1 = largest == 0 ? kept0 : largest == 1 ? dropped : kept1;
+	float c2 = largest <= 1 ? kept1 : largest == 2 ? dropped : kept2;
+	float c3 = largest == 3 ? dropped : kept2;
+
+	return Quaternion(c0, c1, c2, c3);
+}
+
+static inline PackedQuaternion48 PackQuaternion48(unsigned int largest, unsigned int q0, unsigned int q1, unsigned int q2)
+{
+	unsigned long long bits = ((unsigned long long)largest << 45) | ((unsigned long long)q0 << 30) | ((unsigned long long)q1 << 15) | q2;
+
+	PackedQuaternion48 packed;
+	packed.data[0] = (unsigned short)(bits >> 32);
+	packed.data[1] = (unsigned short)(bits >> 16);
+	packed.data[2] = (unsigned short)bits;
+
+	return packed;
+}
+
+static inline void UnpackQuaternion48(const PackedQuaternion48& packed, unsigned int& largest, unsigned int& q0, unsigned int& q1, unsigned int& q2)
+{
+	unsigned long long bits = ((unsigned long long)packed.data[0] << 32) | ((unsigned long long)packed.data[1] << 16) | packed.data[2];
+
+	largest = (unsigned int)(bits >> 45) & 0x3;
+	q0 = (unsigned int)(bits >> 30) & 0x7FFF;
+	q1 = (unsigned int)(bits >> 15) & 0x7FFF;
+	q2 = (unsigned int)bits & 0x7FFF;
+}
+
+static inline PackedQuaternion32 PackQuaternion32(unsigned int largest, unsigned int q0, unsigned int q1, unsigned int q2)
+{
+	PackedQuaternion32 packed;
+	packed.data = (largest << 30) | (q0 << 20) | (q1 << 10) | q2;
+
+	return packed;
+}
+
+static inline void UnpackQuaternion32(const PackedQuaternion32& packed, unsigned int& largest, unsigned int& q0, unsigned int& q1, unsigned int& q2)
+{
+	largest = packed.data >> 30;
+	q0 = (packed.data >> 20) & 0x3FF;
+	q1 = (packed.data >> 10) & 0x3FF;
+	q2 = packed.data & 0x3FF;
+}
+
+PackedQuaternion48 math3d::EncodeQuaternion48(const Quaternion& quat)
+{
+	unsigned int largest;
+	unsigned int quantized[3];
+
+	EncodeSmallestThree(quat, 0x7FFF, largest, quantized);
+
+	return PackQuaternion48(largest, quantized[0], quantized[1], quantized[2]);
+}
+
+Quaternion math3d::DecodeQuaternion48(const PackedQuaternion48& packed)
+{
+	unsigned int largest;
+	unsigned int quantized[3];
+
+	UnpackQuaternion48(packed, largest, quantized[0], quantized[1], quantized[2]);
+
+	return DecodeSmallestThree(0x7FFF, largest, quantized);
+}
+
+PackedQuaternion32 math3d::EncodeQuaternion32(const Quaternion& quat)
+{
+	unsigned int largest;
+	unsigned int quantized[3];
+
+	EncodeSmallestThree(quat, 0x3FF, largest, quantized);
+
+	return PackQuaternion32(largest, quantized[0], quantized[1], quantized[2]);
+}
+
+Quaternion math3d::DecodeQuaternion32(const PackedQuaternion32& packed)
+{
+	unsigned int largest;
+	unsigned int quantized[3];
+
+	UnpackQuaternion32(packed, largest, quantized[0], quantized[1], quantized[2]);
+
+	return DecodeSmallestThree(0x3FF, largest, quantized);
+}
+
+static inline unsigned int EncodeOctahedral(const float* v)
+{
+	float invNorm = 1.0f / (Abs(v[0]) + Abs(v[1]) + Abs(v[2]));
+	float x = v[0] * invNorm;
+	float y = v[1] * invNorm;
+
+	// Fold the lower hemisphere over the diagonals
+	float foldedX = (1.0f - Abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+	float foldedY = (1.0f - Abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+
+	x = v[2] < 0.0f ? foldedX : x;
+	y = v[2] < 0.0f ? foldedY : y;
+
+	int qx = (int)(Min(Max(x, -1.0f), 1.0f) * 32767.0f + (x >= 0.0f ? 0.5f : -0.5f));
+	int qy = (int)(Min(Max(y, -1.0f), 1.0f) * 32767.0f + (y >= 0.0f ? 0.5f : -0.5f));
+
+	return ((unsigned int)(unsigned short)(short)qx << 16) | (unsigned int)(unsigned short)(short)qy;
+}
+
+static inline void DecodeOctahedral(const unsigned int packed, float* v)
+{
+	float x = (short)(packed >> 16) * (1.0f / 32767.0f);
+	float y = (short)(packed & 0xFFFF) * (1.0f / 32767.0f);
+	float z = 1.0f - Abs(x) - Abs(y);
+	float t = Max(-z, 0.0f);
+
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+
+	float invLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+
+	v[0] = x * invLength;
+	v[1] = y * invLength;
+	v[2] = z * invLength;
+}
+
+PackedUnitVector32 math3d::EncodeUnitVector32(const Vector3& vec)
+{
+	PackedUnitVector32 packed;
+	packed.data = EncodeOctahedral(vec.GetData());
+
+	return packed;
+}
+
+Vector3 math3d::DecodeUnitVector32(const PackedUnitVector32& packed)
+{
+	float v[3];
+	DecodeOctahedral(packed.data, v);
+
+	return Vector3(v);
+}
+
+PackedHalfVector3 math3d::EncodeHalfVector3(const Vector3& vec)
+{
+	const float* v = vec.GetData();
+
+	PackedHalfVector3 packed;
+	packed.data[0] = FloatToHalf(v[0]);
+	packed.data[1] = FloatToHalf(v[1]);
+	packed.data[2] = FloatToHalf(v[2]);
+
+	return packed;
+}
+
+Vector3 math3d::DecodeHalfVector3(const PackedHalfVector3& packed)
+{
+	float v[3] = { HalfToFloat(packed.data[0]), HalfToFloat(packed.data[1]), HalfToFloat(packed.data[2]) };
+
+	return Vector3(v);
+}
+
+#ifdef MATH3D_AVX
+static const uint_t CODEC_LANES = 8;
+
+/* mask ? a : b per lane */
+static inline __m256 Select8(__m256 mask, __m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+static inline __m256 Abs8(__m256 v)
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+/* Lane forms of Min(Max(v, low), high), same NaN handling as the scalar selects */
+static inline __m256 Clamp8(__m256 v, float low, float high)
+{
+	return _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(low)), _mm256_set1_ps(high));
+}
+
+//
+// Eight lanes of the codecs above for the batched loops. Lanes are gathered into SoA arrays and
+// every compare and select mirrors the scalar routine, so both give the same codes; only the
+// bit packing and the gathers stay scalar. quantized holds the three kept components, lane
+// arrays one after the other.
+//
+static inline void EncodeSmallestThree8(const Quaternion* quats, const float maxValue, unsigned int* largest, unsigned int* quantized)
+{
+	alignas(32) float lanes[4][CODEC_LANES];
+
+	for (uint_t l = 0; l < CODEC_LANES; l++)
+	{
+		lanes[0][l] = (float)quats[l].GetW();
+		lanes[1][l] = (float)quats[l].GetX();
+		lanes[2][l] = (float)quats[l].GetY();
+		lanes[3][l] = (float)quats[l].GetZ();
+	}
+
+	__m256 c0 = _mm256_load_ps(lanes[0]);
+	__m256 c1 = _mm256_load_ps(lanes[1]);
+	__m256 c2 = _mm256_load_ps(lanes[2]);
+	__m256 c3 = _mm256_load_ps(lanes[3]);
+	__m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c0, c0), _mm256_mul_ps(c1, c1)), _mm256_mul_ps(c2, c2)),
+		_mm256_mul_ps(c3, c3));
+	__m256 invMagnitude = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(squared));
+
+	__m256 a0 = Abs8(c0);
+	__m256 a1 = Abs8(c1);
+	__m256 a2 = Abs8(c2);
+	__m256 a3 = Abs8(c3);
+	__m256 lowIndex = Select8(_mm256_cmp_ps(a1, a0, _CMP_GT_OQ), _mm256_set1_ps(1.0f), _mm256_setzero_ps());
+	__m256 highIndex = Select8(_mm256_cmp_ps(a3, a2, _CMP_GT_OQ), _mm256_set1_ps(3.0f), _mm256_set1_ps(2.0f));
+	__m256 index = Select8(_mm256_cmp_ps(_mm256_max_ps(a2, a3), _mm256_max_ps(a0, a1), _CMP_GT_OQ), highIndex, lowIndex);
+
+	__m256 is0 = _mm256_cmp_ps(index, _mm256_setzero_ps(), _CMP_EQ_OQ);
+	__m256 is1 = _mm256_cmp_ps(index, _mm256_set1_ps(1.0f), _CMP_EQ_OQ);
+	__m256 is2 = _mm256_cmp_ps(index, _mm256_set1_ps(2.0f), _CMP_EQ_OQ);
+	__m256 upTo1 = _mm256_cmp_ps(index, _mm256_set1_ps(1.0f), _CMP_LE_OQ);
+	__m256 upTo2 = _mm256_cmp_ps(index, _mm256_set1_ps(2.0f), _CMP_LE_OQ);
+
+	__m256 dropped = Select8(is0, c0, Select8(is1, c1, Select8(is2, c2, c3)));
+	__m256 kept[3] = { Select8(is0, c1, c0), Select8(upTo1, c2, c1), Select8(upTo2, c3, c2) };
+	__m256 sign = Select8(_mm256_cmp_ps(dropped, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_sub_ps(_mm256_setzero_ps(), invMagnitude), invMagnitude);
+	__m256 scale = _mm256_mul_ps(_mm256_mul_ps(sign, _mm256_set1_ps((float)SQRT_TWO)), _mm256_set1_ps(0.5f));
+
+	_mm256_storeu_si256((__m256i*)largest, _mm256_cvttps_epi32(index));
+
+	for (uint_t k = 0; k < 3; k++)
+	{
+		__m256 unit = Clamp8(_mm256_add_ps(_mm256_mul_ps(kept[k], scale), _mm256_set1_ps(0.5f)), 0.0f, 1.0f);
+		__m256 value = _mm256_add_ps(_mm256_mul_ps(unit, _mm256_set1_ps(maxValue)), _mm256_set1_ps(0.5f));
+
+		_mm256_storeu_si256((__m256i*)(quantized + k * CODEC_LANES), _mm256_cvttps_epi32(value));
+	}
+}
+
+static inline void DecodeSmallestThree8(const float maxValue, const unsigned int* largest, const unsigned int* quantized, Quaternion* quats)
+{
+	alignas(32) float lanes[4][CODEC_LANES];
+	__m256 scale = _mm256_set1_ps(1.0f / maxValue);
+	__m256 kept[3];
+
+	for (uint_t k = 0; k < 3; k++)
+	{
+		__m256 value = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(quantized + k * CODEC_LANES)));
+
+		kept[k] = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(value, scale), _mm256_set1_ps(0.5f)), _mm256_set1_ps((float)SQRT_TWO));
+	}
+
+	__m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(kept[0], kept[0]), _mm256_mul_ps(kept[1], kept[1])), _mm256_mul_ps(kept[2], kept[2]));
+	__m256 dropped = _mm256_sqrt_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), squared), _mm256_setzero_ps()));
+	__m256 index = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)largest));
+
+	__m256 is0 = _mm256_cmp_ps(index, _mm256_setzero_ps(), _CMP_EQ_OQ);
+	__m256 is1 = _mm256_cmp_ps(index, _mm256_set1_ps(1.0f), _CMP_EQ_OQ);
+	__m256 is2 = _mm256_cmp_ps(index, _mm256_set1_ps(2.0f), _CMP_EQ_OQ);
+	__m256 is3 = _mm256_cmp_ps(index, _mm256_set1_ps(3.0f), _CMP_EQ_OQ);
+	__m256 upTo1 = _mm256_cmp_ps(index, _mm256_set1_ps(1.0f), _CMP_LE_OQ);
+
+	_mm256_store_ps(lanes[0], Select8(is0, dropped, kept[0]));
+	_mm256_store_ps(lanes[1], Select8(is0, kept[0], Select8(is1, dropped, kept[1])));
+	_mm256_store_ps(lanes[2], Select8(upTo1, kept[1], Select8(is2, dropped, kept[2])));
+	_mm256_store_ps(lanes[3], Select8(is3, dropped, kept[2]));
+
+	for (uint_t l = 0; l < CODEC_LANES; l++)
+	{
+		quats[l] = Quaternion(lanes[0][l], lanes[1][l], lanes[2][l], lanes[3][l]);
+	}
+}
+
+static inline void EncodeOctahedral8(const float* v, unsigned int* packed)
+{
+	alignas(32) float lanes[3][CODEC_LANES];
+	alignas(32) int quantized[2][CODEC_LANES];
+
+	for (uint_t l = 0; l < CODEC_LANES; l++)
+	{
+		lanes[0][l] = v[l * 3];
+		lanes[1][l] = v[l * 3 + 1];
+		lanes[2][l] = v[l * 3 + 2];
+	}
+
+	__m256 vx = _mm256_load_ps(lanes[0]);
+	__m256 vy = _mm256_load_ps(lanes[1]);
+	__m256 vz = _mm256_load_ps(lanes[2]);
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 invNorm = _mm256_div_ps(one, _mm256_add_ps(_mm256_add_ps(Abs8(vx), Abs8(vy)), Abs8(vz)));
+	__m256 x = _mm256_mul_ps(vx, invNorm);
+	__m256 y = _mm256_mul_ps(vy, invNorm);
+
+	// Fold the lower hemisphere over the diagonals
+	__m256 foldedX = _mm256_mul_ps(_mm256_sub_ps(one, Abs8(y)), Select8(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), one, _mm256_set1_ps(-1.0f)));
+	__m256 foldedY = _mm256_mul_ps(_mm256_sub_ps(one, Abs8(x)), Select8(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), one, _mm256_set1_ps(-1.0f)));
+	__m256 lower = _mm256_cmp_ps(vz, zero, _CMP_LT_OQ);
+
+	x = Select8(lower, foldedX, x);
+	y = Select8(lower, foldedY, y);
+
+	__m256 roundX = Select8(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), _mm256_set1_ps(0.5f), _mm256_set1_ps(-0.5f));
+	__m256 roundY = Select8(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), _mm256_set1_ps(0.5f), _mm256_set1_ps(-0.5f));
+
+	_mm256_store_si256((__m256i*)quantized[0], _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(Clamp8(x, -1.0f, 1.0f), _mm256_set1_ps(32767.0f)), roundX)));
+	_mm256_store_si256((__m256i*)quantized[1], _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(Clamp8(y, -1.0f, 1.0f), _mm256_set1_ps(32767.0f)), roundY)));
+
+	for (uint_t l = 0; l < CODEC_LANES; l++)
+	{
+		packed[l] = ((unsigned int)(unsigned short)(short)quantized[0][l] << 16) | (unsigned int)(unsigned short)(short)quantized[1][l];
+	}
+}
+
+static inline void DecodeOctahedral8(const PackedUnitVector32* packed, Vector3* vecs)
+{
+	alignas(32) float lanes[3][CODEC_LANES];
+
+	for (uint_t l = 0; l < CODEC_LANES; l++)
+	{
+		lanes[0][l] = (float)(short)(packed[l].data >> 16);
+		lanes[1][l] = (float)(short)(packed[l].data & 0xFFFF);
+	}
+
+	__m256 zero = _mm256_setzero_ps();
+	__m256 x = _mm256_mul_ps(_mm256_load_ps(lanes[0]), _mm256_set1_ps(1.0f / 32767.0f));
+	__m256 y = _mm256_mul_ps(_mm256_load_ps(lanes[1]), _mm256_set1_ps(1.0f / 32767.0f));
+	__m256 z = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), Abs8(x)), Abs8(y));
+	__m256 t = _mm256_max_ps(_mm256_sub_ps(zero, z), zero);
+
+	x = _mm256_add_ps(x, Select8(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), _mm256_sub_ps(zero, t), t));
+	y = _mm256_add_ps(y, Select8(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), _mm256_sub_ps(zero, t), t));
+
+	__m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+	__m256 invLength = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(squared));
+
+	_mm256_store_ps(lanes[0], _mm256_mul_ps(x, invLength));
+	_mm256_store_ps(lanes[1], _mm256_mul_ps(y, invLength));
+	_mm256_store_ps(lanes[2], _mm256_mul_ps(z, invLength));
+
+	for (uint_t l = 0; l < CODEC_LANES; l++)
+	{
+		float* v = vecs[l].GetData();
+
+		v[0] = lanes[0][l];
+		v[1] = lanes[1][l];
+		v[2] = lanes[2][l];
+	}
+}
+#endif
+
+void math3d::EncodeHalfFloats(const float* values, uint_t count, unsigned short* packed)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_F16C
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i*)(packed + i), half);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		packed[i] = FloatToHalf(values[i]);
+	}
+}
+
+void math3d::DecodeHalfFloats(const unsigned short* packed, uint_t count, float* values)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_F16C
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(values + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(packed + i))));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		values[i] = HalfToFloat(packed[i]);
+	}
+}
+
+void math3d::EncodeQuaternions48(const Quaternion* quats, uint_t count, PackedQuaternion48* packed)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_AVX
+	for (; i + CODEC_LANES <= count; i += CODEC_LANES)
+	{
+		unsigned int largest[CODEC_LANES];
+		unsigned int quantized[3 * CODEC_LANES];
+
+		EncodeSmallestThree8(quats + i, (float)0x7FFF, largest, quantized);
+
+		for (uint_t l = 0; l < CODEC_LANES; l++)
+		{
+			packed[i + l] = PackQuaternion48(largest[l], quantized[l], quantized[CODEC_LANES + l], quantized[2 * CODEC_LANES + l]);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		packed[i] = EncodeQuaternion48(quats[i]);
+	}
+}
+
+void math3d::DecodeQuaternions48(const PackedQuaternion48* packed, uint_t count, Quaternion* quats)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_AVX
+	for (; i + CODEC_LANES <= count; i += CODEC_LANES)
+	{
+		unsigned int largest[CODEC_LANES];
+		unsigned int quantized[3 * CODEC_LANES];
+
+		for (uint_t l = 0; l < CODEC_LANES; l++)
+		{
+			UnpackQuaternion48(packed[i + l], largest[l], quantized[l], quantized[CODEC_LANES + l], quantized[2 * CODEC_LANES + l]);
+		}
+
+		DecodeSmallestThree8((float)0x7FFF, largest, quantized, quats + i);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		quats[i] = DecodeQuaternion48(packed[i]);
+	}
+}
+
+void math3d::EncodeQuaternions32(const Quaternion* quats, uint_t count, PackedQuaternion32* packed)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_AVX
+	for (; i + CODEC_LANES <= count; i += CODEC_LANES)
+	{
+		unsigned int largest[CODEC_LANES];
+		unsigned int quantized[3 * CODEC_LANES];
+
+		EncodeSmallestThree8(quats + i, (float)0x3FF, largest, quantized);
+
+		for (uint_t l = 0; l < CODEC_LANES; l++)
+		{
+			packed[i + l] = PackQuaternion32(largest[l], quantized[l], quantized[CODEC_LANES + l], quantized[2 * CODEC_LANES + l]);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		packed[i] = EncodeQuaternion32(quats[i]);
+	}
+}
+
+void math3d::DecodeQuaternions32(const PackedQuaternion32* packed, uint_t count, Quaternion* quats)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_AVX
+	for (; i + CODEC_LANES <= count; i += CODEC_LANES)
+	{
+		unsigned int largest[CODEC_LANES];
+		unsigned int quantized[3 * CODEC_LANES];
+
+		for (uint_t l = 0; l < CODEC_LANES; l++)
+		{
+			UnpackQuaternion32(packed[i + l], largest[l], quantized[l], quantized[CODEC_LANES + l], quantized[2 * CODEC_LANES + l]);
+		}
+
+		DecodeSmallestThree8((float)0x3FF, largest, quantized, quats + i);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		quats[i] = DecodeQuaternion32(packed[i]);
+	}
+}
+
+void math3d::EncodeUnitVectors32(const Vector3* vecs, uint_t count, PackedUnitVector32* packed)
+{
+	const float* v = count > 0 ? vecs[0].GetData() : nullptr;
+	uint_t i = 0;
+
+#ifdef MATH3D_AVX
+	for (; i + CODEC_LANES <= count; i += CODEC_LANES)
+	{
+		unsigned int codes[CODEC_LANES];
+
+		EncodeOctahedral8(v + (size_t)i * 3, codes);
+
+		for (uint_t l = 0; l < CODEC_LANES; l++)
+		{
+			packed[i + l].data = codes[l];
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		packed[i].data = EncodeOctahedral(v + (size_t)i * 3);
+	}
+}
+
+void math3d::DecodeUnitVectors32(const PackedUnitVector32* packed, uint_t count, Vector3* vecs)
+{
+	uint_t i = 0;
+
+#ifdef MATH3D_AVX
+	for (; i + CODEC_LANES <= count; i += CODEC_LANES)
+	{
+		DecodeOctahedral8(packed + i, vecs + i);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float v[3];
+		DecodeOctahedral(packed[i].data, v);
+
+		vecs[i] = Vector3(v);
+	}
+}
+
+void math3d::EncodeHalfVectors3(const Vector3* vecs, uint_t count, PackedHalfVector3* packed)
+{
+	static_assert(sizeof(PackedHalfVector3) == 3 * sizeof(unsigned short), "PackedHalfVector3 arrays are treated as tightly packed halves");
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	EncodeHalfFloats(vecs[0].GetData(), count * 3, packed[0].data);
+}
+
+void math3d::DecodeHalfVectors3(const PackedHalfVector3* packed, uint_t count, Vector3* vecs)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	DecodeHalfFloats(packed[0].data, count * 3, vecs[0].GetData());
+}
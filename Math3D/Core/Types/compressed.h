@@ -0,0 +1,65 @@
+#pragma once
+#include "quaternion.h"
+#include "math3dhelpers.h"
+
+namespace math3d
+{
+	//
+	// Compact storage formats for memory bound streams (keyframes, mesh attributes).
+	// Error bounds below are the worst case measured over 10M random unit inputs.
+	//
+
+	/* Smallest three, 2 bit index of the dropped component + 3 x 15 bit, max component error 5.9e-5 */
+	struct PackedQuaternion48
+	{
+		unsigned short data[3];
+	};
+
+	/* Smallest three, 2 bit index of the dropped component + 3 x 10 bit, max component error 2.0e-3 */
+	struct PackedQuaternion32
+	{
+		unsigned int data;
+	};
+
+	/* Octahedral mapping, 2 x 16 bit snorm, max angular error 6.5e-5 rad */
+	struct PackedUnitVector32
+	{
+		unsigned int data;
+	};
+
+	/* IEEE 754 binary16 per component, relative error 4.9e-4 */
+	struct PackedHalfVector3
+	{
+		unsigned short data[3];
+	};
+
+	unsigned short FloatToHalf(float value);
+	float HalfToFloat(unsigned short value);
+
+	PackedQuaternion48 EncodeQuaternion48(const Quaternion& quat);
+	Quaternion DecodeQuaternion48(const PackedQuaternion48& packed);
+	PackedQuaternion32 EncodeQuaternion32(const Quaternion& quat);
+	Quaternion DecodeQuaternion32(const PackedQuaternion32& packed);
+	PackedUnitVector32 EncodeUnitVector32(const Vector3& vec);
+	Vector3 DecodeUnitVector32(const PackedUnitVector32& packed);
+	PackedHalfVector3 EncodeHalfVector3(const Vector3& vec);
+	Vector3 DecodeHalfVector3(const PackedHalfVector3& packed);
+
+	//
+	// Batched forms. Smallest three and octahedral coding select with compares instead of
+	// branching on the data and run eight lanes at a time with AVX, half conversions use F16C,
+	// each when the target supports it. Results match the single element functions, up to one
+	// quantization step or rounding where the compiler fuses their scalar multiply adds.
+	//
+	void EncodeHalfFloats(const float* values, uint_t count, unsigned short* packed);
+	void DecodeHalfFloats(const unsigned short* packed, uint_t count, float* values);
+
+	void EncodeQuaternions48(const Quaternion* quats, uint_t count, PackedQuaternion48* packed);
+	void DecodeQuaternions48(const PackedQuaternion48* packed, uint_t count, Quaternion* quats);
+	void EncodeQuaternions32(const Quaternion* quats, uint_t count, PackedQuaternion32* packed);
+	void DecodeQuaternions32(const PackedQuaternion32* packed, uint_t count, Quaternion* quats);
+	void EncodeUnitVectors32(const Vector3* vecs, uint_t count, PackedUnitVector32* packed);
+	void DecodeUnitVectors32(const PackedUnitVector32* packed, uint_t count, Vector3* vecs);
+	void EncodeHalfVectors3(const Vector3* vecs, uint_t count, PackedHalfVector3* packed);
+	void DecodeHalfVectors3(const PackedHalfVector3* packed, uint_t count, Vector3* vecs);
+}
@@ -0,0 +1,476 @@
+#include "curve.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include "math3dexceptions.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace math3d;
+
+static const uint_t CURVE_LANES = 8;
+static const uint_t CURVE_BATCH_GRAIN = 4096;
+
+Curve::Curve() : segmentCount(0), arcSamplesPerSegment(0) {}
+
+void Curve::AddSegment(const float* a, const float* b, const float* c, const float* d)
+{
+	this->coefficients.insert(this->coefficients.end(), a, a + 3);
+	this->coefficients.insert(this->coefficients.end(), b, b + 3);
+	this->coefficients.insert(this->coefficients.end(), c, c + 3);
+	this->coefficients.insert(this->coefficients.end(), d, d + 3);
+	this->segmentCount++;
+}
+
+/* Maps the curve parameter to a segment and its local parameter in [0, 1] */
+static inline uint_t LocateSegment(float u, uint_t segmentCount, float& t)
+{
+	// Inline min/max instead of clamp so the lane loops stay branch free
+	float x = Max(0.0f, Min(1.0f, u)) * segmentCount;
+	float segment = Min(std::floor(x), (float)(segmentCount - 1));
+
+	t = x - segment;
+
+	return (uint_t)(int)segment;
+}
+
+Vector3 Curve::Evaluate(float u) const
+{
+	if (this->segmentCount == 0)
+	{
+		return Vector3();
+	}
+
+	float t;
+	const float* k = this->coefficients.data() + LocateSegment(u, this->segmentCount, t) * 12;
+
+	return CreateVector3(
+		((k[0] * t + k[3]) * t + k[6]) * t + k[9],
+		((k[1] * t + k[4]) * t + k[7]) * t + k[10],
+		((k[2] * t + k[5]) * t + k[8]) * t + k[11]);
+}
+
+Vector3 Curve::EvaluateDerivative(float u) const
+{
+	if (this->segmentCount == 0)
+	{
+		return Vector3();
+	}
+
+	float t;
+	const float* k = this->coefficients.data() + LocateSegment(u, this->segmentCount, t) * 12;
+	float scale = (float)this->segmentCount;
+
+	return CreateVector3(
+		((3.0f * k[0] * t + 2.0f * k[3]) * t + k[6]) * scale,
+		((3.0f * k[1] * t + 2.0f * k[4]) * t + k[7]) * scale,
+		((3.0f * k[2] * t + 2.0f * k[5]) * t + k[8]) * scale);
+}
+
+Vector3 Curve::EvaluateSecondDerivative(float u) const
+{
+	if (this->segmentCount == 0)
+	{
+		return Vector3();
+	}
+
+	float t;
+	const float* k = this->coefficients.data() + LocateSegment(u, this->segmentCount, t) * 12;
+	float scale = (float)this->segmentCount * this->segmentCount;
+
+	return CreateVector3(
+		(6.0f * k[0] * t + 2.0f * k[3]) * scale,
+		(6.0f * k[1] * t + 2.0f * k[4]) * scale,
+		(6.0f * k[2] * t + 2.0f * k[5]) * scale);
+}
+
+//
+// Gathers the segment coefficients of 8 parameters into lanes, the Horner steps
+// then run over the lanes with no dependency between them so they vectorize.
+//
+template <bool Derivative>
+static void EvaluateLanes(const float* coefficients, uint_t segmentCount, const float* parameters, uint_t count, float* out)
+{
+	alignas(32) float u[CURVE_LANES];
+	alignas(32) float t[CURVE_LANES];
+	alignas(32) float k[12][CURVE_LANES];
+	alignas(32) float result[3][CURVE_LANES];
+	uint_t segments[CURVE_LANES];
+
+	float scale = (float)segmentCount;
+
+	for (uint_t first = 0; first < count; first += CURVE_LANES)
+	{
+		uint_t active = count - first < CURVE_LANES ? count - first : CURVE_LANES;
+
+		for (uint_t i = 0; i < CURVE_LANES; i++)
+		{
+			u[i] = parameters[first + (i < active ? i : 0)];
+		}
+
+		for (uint_t i = 0; i < CURVE_LANES; i++)
+		{
+			segments[i] = LocateSegment(u[i], segmentCount, t[i]);
+		}
+
+		for (uint_t i = 0; i < CURVE_LANES; i++)
+		{
+			const float* source = coefficients + segments[i] * 12;
+
+			for (uint_t c = 0; c < 12; c++)
+			{
+				k[c][i] = source[c];
+			}
+		}
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			for (uint_t i = 0; i < CURVE_LANES; i++)
+			{
+				if (Derivative)
+				{
+					result[axis][i] = ((3.0f * k[axis][i] * t[i] + 2.0f * k[3 + axis][i]) * t[i] + k[6 + axis][i]) * scale;
+				}
+				else
+				{
+					result[axis][i] = ((k[axis][i] * t[i] + k[3 + axis][i]) * t[i] + k[6 + axis][i]) * t[i] + k[9 + axis][i];
+				}
+			}
+		}
+
+		for (uint_t i = 0; i < active; i++)
+		{
+			out[(first + i) * 3] = result[0][i];
+			out[(first + i) * 3 + 1] = result[1][i];
+			out[(first + i) * 3 + 2] = result[2][i];
+		}
+	}
+}
+
+void Curve::Evaluate(const float* parameters, uint_t count, Vector3* points) const
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (this->segmentCount == 0)
+	{
+		std::fill(points, points + count, Vector3());
+
+		return;
+	}
+
+	const float* k = this->coefficients.data();
+	uint_t segments = this->segmentCount;
+	float* out = points[0].GetData();
+
+	ParallelFor(0, count, CURVE_BATCH_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		EvaluateLanes<false>(k, segments, parameters + begin, end - begin, out + begin * 3);
+	});
+}
+
+void Curve::EvaluateDerivative(const float* parameters, uint_t count, Vector3* derivatives) const
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (this->segmentCount == 0)
+	{
+		std::fill(derivatives, derivatives + count, Vector3());
+
+		return;
+	}
+
+	const float* k = this->coefficients.data();
+	uint_t segments = this->segmentCount;
+	float* out = derivatives[0].GetData();
+
+	ParallelFor(0, count, CURVE_BATCH_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		EvaluateLanes<true>(k, segments, parameters + begin, end - begin, out + begin * 3);
+	});
+}
+
+void Curve::EvaluateUniform(uint_t count, Vector3* points) const
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (count == 1 || this->segmentCount == 0)
+	{
+		std::fill(points, points + count, this->Evaluate(0.0f));
+
+		return;
+	}
+
+	const float* coefficients = this->coefficients.data();
+	uint_t segmentCount = this->segmentCount;
+	uint_t intervals = count - 1;
+	double step = (double)segmentCount / intervals;
+	float* out = points[0].GetData();
+
+	ParallelFor(0, segmentCount, 1, [=](uint_t segmentBegin, uint_t segmentEnd)
+	{
+		for (uint_t segment = segmentBegin; segment < segmentEnd; segment++)
+		{
+			// Samples i with segment <= i * step < segment + 1, the last segment also owns u = 1
+			uint_t first = (uint_t)(((unsigned long long)segment * intervals + segmentCount - 1) / segmentCount);
+			uint_t last = segment + 1 == segmentCount ? count : (uint_t)(((unsigned long long)(segment + 1) * intervals + segmentCount - 1) / segmentCount);
+
+			if (first >= last)
+			{
+				continue;
+			}
+
+			const float* k = coefficients + segment * 12;
+			double t0 = first * step - segment;
+
+			// Forward differences of the cubic in double, drift stays far below float precision
+			for (uint_t axis = 0; axis < 3; axis++)
+			{
+				double f[4];
+
+				for (uint_t j = 0; j < 4; j++)
+				{
+					double t = t0 + j * step;
+					f[j] = ((k[axis] * t + k[3 + axis]) * t + k[6 + axis]) * t + k[9 + axis];
+				}
+
+				double value = f[0];
+				double delta1 = f[1] - f[0];
+				double delta2 = f[2] - 2.0 * f[1] + f[0];
+				double delta3 = f[3] - 3.0 * f[2] + 3.0 * f[1] - f[0];
+
+				for (uint_t i = first; i < last; i++)
+				{
+					out[i * 3 + axis] = (float)value;
+					value += delta1;
+					delta1 += delta2;
+					delta2 += delta3;
+				}
+			}
+		}
+	});
+}
+
+/* Length of segment k between local parameters t0 and t1, 3 point Gauss-Legendre on |p'(t)| */
+static float IntegrateSegmentLength(const float* k, float t0, float t1)
+{
+	static const float nodes[3] = { -0.774596669f, 0.0f, 0.774596669f };
+	static const float weights[3] = { 0.555555556f, 0.888888889f, 0.555555556f };
+
+	float half = 0.5f * (t1 - t0);
+	float mid = 0.5f * (t1 + t0);
+	float length = 0.0f;
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		float t = mid + half * nodes[i];
+		float dx = (3.0f * k[0] * t + 2.0f * k[3]) * t + k[6];
+		float dy = (3.0f * k[1] * t + 2.0f * k[4]) * t + k[7];
+		float dz = (3.0f * k[2] * t + 2.0f * k[5]) * t + k[8];
+
+		length += weights[i] * std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	return length * half;
+}
+
+void Curve::BuildArcLengthTable(uint_t samplesPerSegment)
+{
+	uint_t samples = samplesPerSegment == 0 ? 1 : samplesPerSegment;
+	uint_t total = this->segmentCount * samples;
+
+	this->arcSamplesPerSegment = samples;
+	this->arcLengths.assign(total + 1, 0.0f);
+
+	float* table = this->arcLengths.data();
+	const float* coefficients = this->coefficients.data();
+	float invSamples = 1.0f / samples;
+
+	// Segment local lengths in parallel, prefix sum afterwards
+	ParallelFor(0, this->segmentCount, 64, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t segment = begin; segment < end; segment++)
+		{
+			const float* k = coefficients + segment * 12;
+
+			for (uint_t i = 0; i < samples; i++)
+			{
+				table[segment * samples + i + 1] = IntegrateSegmentLength(k, i * invSamples, (i + 1) * invSamples);
+			}
+		}
+	});
+
+	double sum = 0.0;
+
+	for (uint_t i = 1; i <= total; i++)
+	{
+		sum += table[i];
+		table[i] = (float)sum;
+	}
+}
+
+float Curve::GetLength() const
+{
+	if (this->arcLengths.empty())
+	{
+		throw CurveNoArcLengthTable();
+	}
+
+	return this->arcLengths.back();
+}
+
+float Curve::GetParameterAtDistance(float distance) const
+{
+	if (this->arcLengths.empty())
+	{
+		throw CurveNoArcLengthTable();
+	}
+
+	const float* table = this->arcLengths.data();
+	uint_t total = (uint_t)this->arcLengths.size() - 1;
+
+	if (total == 0 || distance <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	if (distance >= table[total])
+	{
+		return 1.0f;
+	}
+
+	uint_t upper = (uint_t)(std::upper_bound(table, table + total + 1, distance) - table);
+	float span = table[upper] - table[upper - 1];
+	float alpha = span > 0.0f ? (distance - table[upper - 1]) / span : 0.0f;
+
+	return (upper - 1 + alpha) / total;
+}
+
+Vector3 Curve::EvaluateAtDistance(float distance) const
+{
+	return this->Evaluate(this->GetParameterAtDistance(distance));
+}
+
+void Curve::EvaluateAtDistances(const float* distances, uint_t count, Vector3* points) const
+{
+	if (this->arcLengths.empty())
+	{
+		throw CurveNoArcLengthTable();
+	}
+
+	std::vector<float> parameters(count);
+	float* u = parameters.data();
+
+	ParallelFor(0, count, CURVE_BATCH_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			u[i] = this->GetParameterAtDistance(distances[i]);
+		}
+	});
+
+	this->Evaluate(u, count, points);
+}
+
+Curve Curve::CreateCatmullRom(const Vector3* points, uint_t count)
+{
+	if (count < 2)
+	{
+		throw CurveInvalidControlPoints();
+	}
+
+	Curve ret;
+
+	for (uint_t i = 0; i + 1 < count; i++)
+	{
+		const float* p0 = points[i == 0 ? 0 : i - 1].GetData();
+		const float* p1 = points[i].GetData();
+		const float* p2 = points[i + 1].GetData();
+		const float* p3 = points[i + 2 < count ? i + 2 : count - 1].GetData();
+
+		float a[3], b[3], c[3], d[3];
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			a[axis] = 0.5f * (-p0[axis] + 3.0f * p1[axis] - 3.0f * p2[axis] + p3[axis]);
+			b[axis] = 0.5f * (2.0f * p0[axis] - 5.0f * p1[axis] + 4.0f * p2[axis] - p3[axis]);
+			c[axis] = 0.5f * (p2[axis] - p0[axis]);
+			d[axis] = p1[axis];
+		}
+
+		ret.AddSegment(a, b, c, d);
+	}
+
+	return ret;
+}
+
+Curve Curve::CreateBezier(const Vector3* controls, uint_t count)
+{
+	if (count < 4 || (count - 1) % 3 != 0)
+	{
+		throw CurveInvalidControlPoints();
+	}
+
+	Curve ret;
+
+	for (uint_t i = 0; i + 3 < count; i += 3)
+	{
+		const float* p0 = controls[i].GetData();
+		const float* c0 = controls[i + 1].GetData();
+		const float* c1 = controls[i + 2].GetData();
+		const float* p1 = controls[i + 3].GetData();
+
+		float a[3], b[3], c[3], d[3];
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			a[axis] = -p0[axis] + 3.0f * c0[axis] - 3.0f * c1[axis] + p1[axis];
+			b[axis] = 3.0f * p0[axis] - 6.0f * c0[axis] + 3.0f * c1[axis];
+			c[axis] = 3.0f * (c0[axis] - p0[axis]);
+			d[axis] = p0[axis];
+		}
+
+		ret.AddSegment(a, b, c, d);
+	}
+
+	return ret;
+}
+
+Curve Curve::CreateHermite(const Vector3* points, const Vector3* tangents, uint_t count)
+{
+	if (count < 2)
+	{
+		throw CurveInvalidControlPoints();
+	}
+
+	Curve ret;
+
+	for (uint_t i = 0; i + 1 < count; i++)
+	{
+		const float* p0 = points[i].GetData();
+		const float* p1 = points[i + 1].GetData();
+		const float* m0 = tangents[i].GetData();
+		const float* m1 = tangents[i + 1].GetData();
+
+		float a[3], b[3], c[3], d[3];
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			a[axis] = 2.0f * p0[axis] + m0[axis] - 2.0f * p1[axis] + m1[axis];
+			b[axis] = -3.0f * p0[axis] - 2.0f * m0[axis] + 3.0f * p1[axis] - m1[axis];
+			c[axis] = m0[axis];
+			d[axis] = p0[axis];
+		}
+
+		ret.AddSegment(a, b, c, d);
+	}
+
+	return ret;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <vector>
+
+namespace math3d
+{
+	//
+	// Piecewise cubic curve over Vector3, every segment is stored in power basis
+	// p(t) = a t^3 + b t^2 + c t + d so all curve kinds share the same evaluation kernels.
+	// The curve parameter u runs over [0, 1] across all segments (clamped), derivatives
+	// are taken with respect to u.
+	//
+	class Curve
+	{
+	private:
+		/* 12 floats per segment: a, b, c, d, xyz each */
+		std::vector<float> coefficients;
+		/* Cumulative length at arcSamplesPerSegment uniform steps per segment, empty until built */
+		std::vector<float> arcLengths;
+		uint_t segmentCount;
+		uint_t arcSamplesPerSegment;
+
+		void AddSegment(const float* a, const float* b, const float* c, const float* d);
+
+	public:
+		Curve();
+		Curve(const Curve& curve) = default;
+		~Curve() = default;
+
+		Vector3 Evaluate(float u) const;
+		Vector3 EvaluateDerivative(float u) const;
+		Vector3 EvaluateSecondDerivative(float u) const;
+
+		//
+		// Batched evaluation. Arbitrary parameters are processed 8 lanes at a time (SoA Horner),
+		// uniform sampling uses forward differencing inside each segment.
+		// Large batches are split over all hardware threads.
+		//
+		void Evaluate(const float* parameters, uint_t count, Vector3* points) const;
+		void EvaluateDerivative(const float* parameters, uint_t count, Vector3* derivatives) const;
+		/* count >= 2 points at u = i / (count - 1) */
+		void EvaluateUniform(uint_t count, Vector3* points) const;
+
+		/* Tabulates the arc length with Gauss-Legendre quadrature, required by the distance queries below */
+		void BuildArcLengthTable(uint_t samplesPerSegment = 16);
+		float GetLength() const;
+		/* Parameter u at the given distance from the start, interpolated from the arc length table */
+		float GetParameterAtDistance(float distance) const;
+		Vector3 EvaluateAtDistance(float distance) const;
+		void EvaluateAtDistances(const float* distances, uint_t count, Vector3* points) const;
+
+		/* Uniform Catmull-Rom through all points, the end points are duplicated so the curve spans them all */
+		static Curve CreateCatmullRom(const Vector3* points, uint_t count);
+		/* Cubic Bezier spline, segment i uses controls [3i, 3i + 3], needs 3n + 1 controls */
+		static Curve CreateBezier(const Vector3* controls, uint_t count);
+		static Curve CreateHermite(const Vector3* points, const Vector3* tangents, uint_t count);
+
+		Curve& operator=(const Curve& curve) = default;
+
+		inline uint_t GetSegmentCount() const
+		{
+			return this->segmentCount;
+		}
+
+		inline bool HasArcLengthTable() const
+		{
+			return !this->arcLengths.empty();
+		}
+	};
+}
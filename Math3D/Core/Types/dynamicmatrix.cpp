@@ -0,0 +1,453 @@
+#include "dynamicmatrix.h"
+#include "math3dparallel.h"
+#include "math3dexceptions.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace math3d;
+
+static const std::size_t DYNAMIC_MATRIX_ALIGNMENT = 64;
+
+//
+// GEMM blocking, BLIS style. A KC x NC panel of B and an MC x KC block of A are packed
+// into contiguous micro panels so the MR x NR micro kernel streams both operands with
+// unit stride. KC x NR of B stays in L1, MC x KC of A in L2, KC x NC of B in L3.
+//
+static const uint_t GEMM_MR = 6;
+static const uint_t GEMM_KC = 256;
+static const uint_t GEMM_MC = 120;
+static const uint_t GEMM_NC = 2048;
+
+template <typename T>
+struct GemmTraits
+{
+	// One micro panel row fills a cache line: 16 floats or 8 doubles
+	static const uint_t NR = 64 / sizeof(T);
+};
+
+template <typename T>
+static T* AllocateAligned(std::size_t count)
+{
+	return static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t(DYNAMIC_MATRIX_ALIGNMENT)));
+}
+
+template <typename T>
+static void FreeAligned(T* ptr)
+{
+	::operator delete[](ptr, std::align_val_t(DYNAMIC_MATRIX_ALIGNMENT));
+}
+
+/* Packs rows [0, mc) x cols [0, kc) of A into MR row micro panels, zero padded */
+template <typename T>
+static void PackA(const T* a, uint_t lda, uint_t mc, uint_t kc, T* packed)
+{
+	for (uint_t i = 0; i < mc; i += GEMM_MR)
+	{
+		uint_t mr = mc - i < GEMM_MR ? mc - i : GEMM_MR;
+
+		for (uint_t k = 0; k < kc; k++)
+		{
+			for (uint_t r = 0; r < GEMM_MR; r++)
+			{
+				*(packed++) = r < mr ? *(a + (std::size_t)(i + r) * lda + k) : (T)0;
+			}
+		}
+	}
+}
+
+/* Packs rows [0, kc) x cols [0, nc) of B into NR column micro panels, zero padded */
+template <typename T>
+static void PackB(const T* b, uint_t ldb, uint_t kc, uint_t nc, T* packed)
+{
+	const uint_t NR = GemmTraits<T>::NR;
+
+	for (uint_t j = 0; j < nc; j += NR)
+	{
+		uint_t nr = nc - j < NR ? nc - j : NR;
+
+		for (uint_t k = 0; k < kc; k++)
+		{
+			const T* row = b + (std::size_t)k * ldb + j;
+
+			for (uint_t c = 0; c < NR; c++)
+			{
+				*(packed++) = c < nr ? *(row + c) : (T)0;
+			}
+		}
+	}
+}
+
+/* C[mr x nr] (+)= A micro panel * B micro panel, accumulators stay in registers. The first K panel overwrites C, so C needs no clearing */
+template <typename T>
+static void MicroKernel(uint_t kc, const T* a, const T* b, T* c, uint_t ldc, uint_t mr, uint_t nr, bool overwrite)
+{
+	const uint_t NR = GemmTraits<T>::NR;
+
+	alignas(64) T accumulators[GEMM_MR][NR] = {};
+
+	for (uint_t k = 0; k < kc; k++)
+	{
+		const T* aColumn = a + k * GEMM_MR;
+		const T* bRow = b + k * NR;
+
+		for (uint_t r = 0; r < GEMM_MR; r++)
+		{
+			const T aValue = aColumn[r];
+
+			for (uint_t col = 0; col < NR; col++)
+			{
+				accumulators[r][col] += aValue * bRow[col];
+			}
+		}
+	}
+
+	if (overwrite)
+	{
+		for (uint_t r = 0; r < mr; r++)
+		{
+			for (uint_t col = 0; col < nr; col++)
+			{
+				*(c + (std::size_t)r * ldc + col) = accumulators[r][col];
+			}
+		}
+
+		return;
+	}
+
+	for (uint_t r = 0; r < mr; r++)
+	{
+		for (uint_t col = 0; col < nr; col++)
+		{
+			*(c + (std::size_t)r * ldc + col) += accumulators[r][col];
+		}
+	}
+}
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix() : values(nullptr), rows(0), columns(0) {}
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(uint_t rows, uint_t columns) : values(nullptr), rows(0), columns(0)
+{
+	this->Allocate(rows, columns);
+	this->Fill((T)0);
+}
+
+/* Caller is responsible for handling memory violation via out of bounds values pointer dereference */
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(uint_t rows, uint_t columns, const T* values) : values(nullptr), rows(0), columns(0)
+{
+	this->Allocate(rows, columns);
+
+	if ((std::size_t)rows * columns > 0)
+	{
+		std::memcpy(this->values, values, sizeof(T) * rows * columns);
+	}
+}
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(const DynamicMatrix<T>& m) : values(nullptr), rows(0), columns(0)
+{
+	this->Allocate(m.rows, m.columns);
+
+	if ((std::size_t)this->rows * this->columns > 0)
+	{
+		std::memcpy(this->values, m.values, sizeof(T) * this->rows * this->columns);
+	}
+}
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(DynamicMatrix<T>&& m) noexcept : values(m.values), rows(m.rows), columns(m.columns)
+{
+	m.values = nullptr;
+	m.rows = 0;
+	m.columns = 0;
+}
+
+template <typename T>
+DynamicMatrix<T>::~DynamicMatrix()
+{
+	this->Release();
+}
+
+template <typename T>
+void DynamicMatrix<T>::Allocate(uint_t rows, uint_t columns)
+{
+	this->Release();
+
+	if ((std::size_t)rows * columns > 0)
+	{
+		this->values = AllocateAligned<T>((std::size_t)rows * columns);
+	}
+
+	this->rows = rows;
+	this->columns = columns;
+}
+
+template <typename T>
+void DynamicMatrix<T>::Release()
+{
+	if (this->values != nullptr)
+	{
+		FreeAligned(this->values);
+	}
+
+	this->values = nullptr;
+	this->rows = 0;
+	this->columns = 0;
+}
+
+/* Contents are not preserved */
+template <typename T>
+void DynamicMatrix<T>::Resize(uint_t rows, uint_t columns)
+{
+	if (rows == this->rows && columns == this->columns)
+	{
+		return;
+	}
+
+	this->Allocate(rows, columns);
+	this->Fill((T)0);
+}
+
+template <typename T>
+void DynamicMatrix<T>::Fill(const T value)
+{
+	std::size_t count = (std::size_t)this->rows * this->columns;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		*(this->values + i) = value;
+	}
+}
+
+template <typename T>
+void DynamicMatrix<T>::Negate()
+{
+	std::size_t count = (std::size_t)this->rows * this->columns;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		*(this->values + i) = -*(this->values + i);
+	}
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::Transpose(const DynamicMatrix<T>& matrix)
+{
+	const uint_t TILE = 32;
+
+	DynamicMatrix<T> ret(matrix.columns, matrix.rows);
+
+	// Tiled so both the reads and the writes stay within a few cache lines
+	for (uint_t ii = 0; ii < matrix.rows; ii += TILE)
+	{
+		for (uint_t jj = 0; jj < matrix.columns; jj += TILE)
+		{
+			uint_t iEnd = ii + TILE < matrix.rows ? ii + TILE : matrix.rows;
+			uint_t jEnd = jj + TILE < matrix.columns ? jj + TILE : matrix.columns;
+
+			for (uint_t i = ii; i < iEnd; i++)
+			{
+				for (uint_t j = jj; j < jEnd; j++)
+				{
+					*(ret.values + (std::size_t)j * matrix.rows + i) = *(matrix.values + (std::size_t)i * matrix.columns + j);
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::CreateIdentity(uint_t size)
+{
+	DynamicMatrix<T> identity(size, size);
+
+	for (uint_t i = 0; i < size; i++)
+	{
+		*(identity.values + (std::size_t)i * size + i) = (T)1;
+	}
+
+	return identity;
+}
+
+template <typename T>
+void DynamicMatrix<T>::Multiply(const DynamicMatrix<T>& matrixA, const DynamicMatrix<T>& matrixB, DynamicMatrix<T>& result)
+{
+	if (matrixA.columns != matrixB.rows)
+	{
+		throw MatrixInvalidDimension();
+	}
+
+	if (&result == &matrixA || &result == &matrixB)
+	{
+		DynamicMatrix<T> tmp;
+		Multiply(matrixA, matrixB, tmp);
+		Swap(result, tmp);
+
+		return;
+	}
+
+	const uint_t NR = GemmTraits<T>::NR;
+	const uint_t m = matrixA.rows;
+	const uint_t n = matrixB.columns;
+	const uint_t k = matrixA.columns;
+
+	// Every element of C is written by the first K panel, so C is only allocated, not cleared
+	if (result.rows != m || result.columns != n)
+	{
+		result.Allocate(m, n);
+	}
+
+	if (m == 0 || n == 0 || k == 0)
+	{
+		result.Fill((T)0);
+
+		return;
+	}
+
+	const std::size_t packedASize = (std::size_t)(GEMM_MC + GEMM_MR) * GEMM_KC;
+	uint_t blockRows = (m + GEMM_MC - 1) / GEMM_MC;
+	uint_t workers = GetWorkerCount();
+
+	// ParallelFor runs at most one chunk per worker, each chunk takes its own A buffer slot
+	uint_t slots = workers < blockRows ? workers : blockRows;
+	T* packedB = AllocateAligned<T>((std::size_t)GEMM_KC * (GEMM_NC + NR));
+	T* packedA = AllocateAligned<T>(packedASize * slots);
+	std::atomic<uint_t> nextSlot(0);
+
+	for (uint_t jc = 0; jc < n; jc += GEMM_NC)
+	{
+		uint_t nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+
+		for (uint_t pc = 0; pc < k; pc += GEMM_KC)
+		{
+			uint_t kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+
+			PackB(matrixB.values + (std::size_t)pc * n + jc, n, kc, nc, packedB);
+			nextSlot = 0;
+
+			// Row blocks of C are disjoint, each worker packs its own A blocks
+			ParallelFor(0, blockRows, 1, [&](uint_t blockBegin, uint_t blockEnd)
+			{
+				T* blockA = packedA + packedASize * nextSlot.fetch_add(1);
+
+				for (uint_t block = blockBegin; block < blockEnd; block++)
+				{
+					uint_t ic = block * GEMM_MC;
+					uint_t mc = m - ic < GEMM_MC ? m - ic : GEMM_MC;
+
+					PackA(matrixA.values + (std::size_t)ic * k + pc, k, mc, kc, blockA);
+
+					for (uint_t jr = 0; jr < nc; jr += NR)
+					{
+						uint_t nr = nc - jr < NR ? nc - jr : NR;
+
+						for (uint_t ir = 0; ir < mc; ir += GEMM_MR)
+						{
+							uint_t mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+
+							MicroKernel(kc, blockA + ir * kc, packedB + jr * kc, result.values + (std::size_t)(ic + ir) * n + jc + jr, n, mr, nr, pc == 0);
+						}
+					}
+				}
+			});
+		}
+	}
+
+	FreeAligned(packedA);
+	FreeAligned(packedB);
+}
+
+template <typename T>
+void DynamicMatrix<T>::MultiplyReference(const DynamicMatrix<T>& matrixA, const DynamicMatrix<T>& matrixB, DynamicMatrix<T>& result)
+{
+	if (matrixA.columns != matrixB.rows)
+	{
+		throw MatrixInvalidDimension();
+	}
+
+	DynamicMatrix<T> ret(matrixA.rows, matrixB.columns);
+
+	for (uint_t i = 0; i < matrixA.rows; i++)
+	{
+		for (uint_t j = 0; j < matrixB.columns; j++)
+		{
+			T sum = (T)0;
+
+			for (uint_t x = 0; x < matrixA.columns; x++)
+			{
+				sum += *(matrixA.values + (std::size_t)i * matrixA.columns + x) * *(matrixB.values + (std::size_t)x * matrixB.columns + j);
+			}
+
+			*(ret.values + (std::size_t)i * ret.columns + j) = sum;
+		}
+	}
+
+	Swap(result, ret);
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator=(DynamicMatrix<T> m)
+{
+	Swap(*this, m);
+
+	return *this;
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator+=(const DynamicMatrix<T>& m)
+{
+	if (this->rows != m.rows || this->columns != m.columns)
+	{
+		throw MatrixInvalidDimension();
+	}
+
+	std::size_t count = (std::size_t)this->rows * this->columns;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		*(this->values + i) += *(m.values + i);
+	}
+
+	return *this;
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator-=(const DynamicMatrix<T>& m)
+{
+	if (this->rows != m.rows || this->columns != m.columns)
+	{
+		throw MatrixInvalidDimension();
+	}
+
+	std::size_t count = (std::size_t)this->rows * this->columns;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		*(this->values + i) -= *(m.values + i);
+	}
+
+	return *this;
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator*=(T scalar)
+{
+	std::size_t count = (std::size_t)this->rows * this->columns;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		*(this->values + i) *= scalar;
+	}
+
+	return *this;
+}
+
+/* Enforce numeric types */
+template class DynamicMatrix<float>;
+template class DynamicMatrix<double>;
@@ -0,0 +1,198 @@
+#pragma once
+#include "matrix.h"
+#include "math3dexceptions.h"
+#include <iostream>
+
+namespace math3d
+{
+	//
+	// Runtime sized, heap backed, row major matrix. Storage is 64 byte aligned so rows
+	// can be streamed with aligned SIMD loads. Products go through a cache blocked,
+	// packed GEMM that spreads row blocks of the result over all hardware threads.
+	//
+	template <typename T>
+	class DynamicMatrix
+	{
+	protected:
+		T* values;
+		uint_t rows;
+		uint_t columns;
+
+		void Allocate(uint_t rows, uint_t columns);
+		void Release();
+
+	public:
+		DynamicMatrix();
+		DynamicMatrix(uint_t rows, uint_t columns);
+		DynamicMatrix(uint_t rows, uint_t columns, const T* values);
+		DynamicMatrix(const DynamicMatrix<T>& m);
+		DynamicMatrix(DynamicMatrix<T>&& m) noexcept;
+		~DynamicMatrix();
+
+		template <uintm_t R, uintm_t C>
+		DynamicMatrix(const Matrix<T, R, C>& m) : values(nullptr), rows(0), columns(0)
+		{
+			this->Allocate(R, C);
+			this->SetBlock(0, 0, m);
+		}
+
+		void Resize(uint_t rows, uint_t columns);
+		void Fill(const T value);
+		void Negate();
+
+		static DynamicMatrix<T> Transpose(const DynamicMatrix<T>& matrix);
+		static DynamicMatrix<T> CreateIdentity(uint_t size);
+
+		/* result = matrixA * matrixB, blocked and multithreaded */
+		static void Multiply(const DynamicMatrix<T>& matrixA, const DynamicMatrix<T>& matrixB, DynamicMatrix<T>& result);
+		/* Plain triple loop, kept as the reference the blocked path is validated and measured against */
+		static void MultiplyReference(const DynamicMatrix<T>& matrixA, const DynamicMatrix<T>& matrixB, DynamicMatrix<T>& result);
+
+		DynamicMatrix<T>& operator=(DynamicMatrix<T> m);
+		DynamicMatrix<T>& operator+=(const DynamicMatrix<T>& m);
+		DynamicMatrix<T>& operator-=(const DynamicMatrix<T>& m);
+		DynamicMatrix<T>& operator*=(T scalar);
+
+		template <uintm_t R, uintm_t C>
+		Matrix<T, R, C> GetBlock(const uint_t row, const uint_t column) const
+		{
+			if (row + R > this->rows || column + C > this->columns)
+			{
+				throw MatrixInvalidIndex();
+			}
+
+			Matrix<T, R, C> block;
+			T* blockValues = block.GetData();
+
+			for (uint_t i = 0; i < R; i++)
+			{
+				for (uint_t j = 0; j < C; j++)
+				{
+					*(blockValues + i * C + j) = *(this->values + (std::size_t)(row + i) * this->columns + column + j);
+				}
+			}
+
+			return block;
+		}
+
+		template <uintm_t R, uintm_t C>
+		void SetBlock(const uint_t row, const uint_t column, const Matrix<T, R, C>& block)
+		{
+			if (row + R > this->rows || column + C > this->columns)
+			{
+				throw MatrixInvalidIndex();
+			}
+
+			const T* blockValues = block.GetData();
+
+			for (uint_t i = 0; i < R; i++)
+			{
+				for (uint_t j = 0; j < C; j++)
+				{
+					*(this->values + (std::size_t)(row + i) * this->columns + column + j) = *(blockValues + i * C + j);
+				}
+			}
+		}
+
+		inline bool IsSquare() const
+		{
+			return (this->rows == this->columns);
+		}
+
+		inline uint_t GetNumberOfRows() const
+		{
+			return this->rows;
+		}
+
+		inline uint_t GetNumberOfColumns() const
+		{
+			return this->columns;
+		}
+
+		inline T GetValueAt(const uint_t row, const uint_t column) const
+		{
+			if (row >= this->rows || column >= this->columns)
+			{
+				throw MatrixInvalidIndex();
+			}
+
+			return *(this->values + (std::size_t)row * this->columns + column);
+		}
+
+		inline void SetValueAt(const uint_t row, const uint_t column, const T value)
+		{
+			if (row >= this->rows || column >= this->columns)
+			{
+				throw MatrixInvalidIndex();
+			}
+
+			*(this->values + (std::size_t)row * this->columns + column) = value;
+		}
+
+		inline const T* GetData() const
+		{
+			return this->values;
+		}
+
+		inline T* GetData()
+		{
+			return this->values;
+		}
+
+		friend void Swap(DynamicMatrix<T>& matrixA, DynamicMatrix<T>& matrixB)
+		{
+			std::swap(matrixA.values, matrixB.values);
+			std::swap(matrixA.rows, matrixB.rows);
+			std::swap(matrixA.columns, matrixB.columns);
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const DynamicMatrix<T>& m)
+		{
+			out << '\n';
+
+			for (uint_t i = 0; i < m.rows; i++)
+			{
+				out << "|\t";
+				for (uint_t j = 0; j < m.columns; j++)
+				{
+					out << *(m.values + (std::size_t)i * m.columns + j) << "\t";
+				}
+				out << "|\n";
+			}
+
+			out << '\n';
+
+			return out;
+		}
+	};
+
+	template <typename T>
+	DynamicMatrix<T> operator+(DynamicMatrix<T> matrixA, const DynamicMatrix<T>& matrixB)
+	{
+		return matrixA += matrixB;
+	}
+
+	template <typename T>
+	DynamicMatrix<T> operator-(DynamicMatrix<T> matrixA, const DynamicMatrix<T>& matrixB)
+	{
+		return matrixA -= matrixB;
+	}
+
+	template <typename T>
+	DynamicMatrix<T> operator*(DynamicMatrix<T> matrix, T scalar)
+	{
+		return matrix *= scalar;
+	}
+
+	template <typename T>
+	DynamicMatrix<T> operator*(const DynamicMatrix<T>& matrixA, const DynamicMatrix<T>& matrixB)
+	{
+		DynamicMatrix<T> result;
+		DynamicMatrix<T>::Multiply(matrixA, matrixB, result);
+
+		return result;
+	}
+
+	typedef DynamicMatrix<float> DynamicMatrixf;
+	typedef DynamicMatrix<double> DynamicMatrixd;
+}
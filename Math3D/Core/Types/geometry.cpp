@@ -0,0 +1,336 @@
+#include "geometry.h"
+#include "math3dutil.h"
+#include "math3dhelpers.h"
+#include <cfloat>
+
+using namespace math3d;
+
+//
+// Ray
+//
+
+Ray::Ray() : origin(), direction(), inverseDirection() {}
+
+Ray::Ray(const Vector3& origin, const Vector3& direction) : origin(origin), direction(direction)
+{
+	const float* d = direction.GetData();
+
+	// Division by zero is intended, the slab tests rely on the resulting infinities
+	this->inverseDirection = CreateVector3(1.0f / d[0], 1.0f / d[1], 1.0f / d[2]);
+}
+
+Ray::Ray(const Ray& ray) : origin(ray.origin), direction(ray.direction), inverseDirection(ray.inverseDirection) {}
+
+Vector3 Ray::GetPoint(float t) const
+{
+	return this->origin + this->direction * t;
+}
+
+Ray& Ray::operator=(const Ray& ray)
+{
+	this->origin = ray.origin;
+	this->direction = ray.direction;
+	this->inverseDirection = ray.inverseDirection;
+
+	return *this;
+}
+
+//
+// Plane
+//
+
+Plane::Plane() : normal(), distance(0.0f) {}
+
+Plane::Plane(const Vector3& normal, float distance) : normal(normal), distance(distance) {}
+
+Plane::Plane(const Vector3& normal, const Vector3& point) : normal(normal)
+{
+	this->distance = -Vector3::DotProduct(normal, point);
+}
+
+Plane::Plane(const Plane& plane) : normal(plane.normal), distance(plane.distance) {}
+
+/* Assumes a normalized plane normal */
+float Plane::SignedDistance(const Vector3& point) const
+{
+	return Vector3::DotProduct(this->normal, point) + this->distance;
+}
+
+Plane Plane::CreateFromPoints(const Vector3& pointA, const Vector3& pointB, const Vector3& pointC)
+{
+	Vector3 normal = Vector3::CrossProduct(pointB - pointA, pointC - pointA);
+	normal.Normalize();
+
+	return Plane(normal, pointA);
+}
+
+Plane& Plane::operator=(const Plane& plane)
+{
+	this->normal = plane.normal;
+	this->distance = plane.distance;
+
+	return *this;
+}
+
+//
+// AABB
+//
+
+AABB::AABB() : min(), max() {}
+
+AABB::AABB(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+AABB::AABB(const AABB& box) : min(box.min), max(box.max) {}
+
+void AABB::Expand(const Vector3& point)
+{
+	const float* p = point.GetData();
+	const float* boxMin = this->min.GetData();
+	const float* boxMax = this->max.GetData();
+
+	this->min = CreateVector3(p[0] < boxMin[0] ? p[0] : boxMin[0], p[1] < boxMin[1] ? p[1] : boxMin[1], p[2] < boxMin[2] ? p[2] : boxMin[2]);
+	this->max = CreateVector3(p[0] > boxMax[0] ? p[0] : boxMax[0], p[1] > boxMax[1] ? p[1] : boxMax[1], p[2] > boxMax[2] ? p[2] : boxMax[2]);
+}
+
+void AABB::Expand(const AABB& box)
+{
+	this->Expand(box.min);
+	this->Expand(box.max);
+}
+
+bool AABB::IsValid() const
+{
+	const float* boxMin = this->min.GetData();
+	const float* boxMax = this->max.GetData();
+
+	return boxMin[0] <= boxMax[0] && boxMin[1] <= boxMax[1] && boxMin[2] <= boxMax[2];
+}
+
+bool AABB::Contains(const Vector3& point) const
+{
+	const float* p = point.GetData();
+	const float* boxMin = this->min.GetData();
+	const float* boxMax = this->max.GetData();
+
+	return p[0] >= boxMin[0] && p[0] <= boxMax[0]
+		&& p[1] >= boxMin[1] && p[1] <= boxMax[1]
+		&& p[2] >= boxMin[2] && p[2] <= boxMax[2];
+}
+
+bool AABB::Overlaps(const AABB& box) const
+{
+	const float* minA = this->min.GetData();
+	const float* maxA = this->max.GetData();
+	const float* minB = box.min.GetData();
+	const float* maxB = box.max.GetData();
+
+	return minA[0] <= maxB[0] && maxA[0] >= minB[0]
+		&& minA[1] <= maxB[1] && maxA[1] >= minB[1]
+		&& minA[2] <= maxB[2] && maxA[2] >= minB[2];
+}
+
+float AABB::SurfaceArea() const
+{
+	if (!this->IsValid())
+	{
+		return 0.0f;
+	}
+
+	const float* boxMin = this->min.GetData();
+	const float* boxMax = this->max.GetData();
+
+	float dx = boxMax[0] - boxMin[0];
+	float dy = boxMax[1] - boxMin[1];
+	float dz = boxMax[2] - boxMin[2];
+
+	return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+Vector3 AABB::GetCenter() const
+{
+	return (this->min + this->max) * 0.5f;
+}
+
+Vector3 AABB::GetExtents() const
+{
+	return (this->max - this->min) * 0.5f;
+}
+
+/* Inverted box, expanding it by any point or box yields that point or box */
+AABB AABB::CreateEmpty()
+{
+	return AABB(CreateVector3(FLT_MAX, FLT_MAX, FLT_MAX), CreateVector3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+}
+
+AABB AABB::Union(const AABB& boxA, const AABB& boxB)
+{
+	AABB ret(boxA);
+	ret.Expand(boxB);
+
+	return ret;
+}
+
+AABB& AABB::operator=(const AABB& box)
+{
+	this->min = box.min;
+	this->max = box.max;
+
+	return *this;
+}
+
+//
+// Sphere
+//
+
+Sphere::Sphere() : center(), radius(0.0f) {}
+
+Sphere::Sphere(const Vector3& center, float radius) : center(center), radius(radius) {}
+
+Sphere::Sphere(const Sphere& sphere) : center(sphere.center), radius(sphere.radius) {}
+
+bool Sphere::Contains(const Vector3& point) const
+{
+	Vector3 diff = point - this->center;
+
+	return Vector3::DotProduct(diff, diff) <= this->radius * this->radius;
+}
+
+AABB Sphere::GetBounds() const
+{
+	Vector3 extents = CreateVector3(this->radius, this->radius, this->radius);
+
+	return AABB(this->center - extents, this->center + extents);
+}
+
+Sphere& Sphere::operator=(const Sphere& sphere)
+{
+	this->center = sphere.center;
+	this->radius = sphere.radius;
+
+	return *this;
+}
+
+//
+// Triangle
+//
+
+Triangle::Triangle() {}
+
+Triangle::Triangle(const Vector3& vertexA, const Vector3& vertexB, const Vector3& vertexC)
+{
+	this->vertices[0] = vertexA;
+	this->vertices[1] = vertexB;
+	this->vertices[2] = vertexC;
+}
+
+Triangle::Triangle(const Triangle& triangle)
+{
+	for (uint_t i = 0; i < 3; i++)
+	{
+		this->vertices[i] = triangle.vertices[i];
+	}
+}
+
+Vector3 Triangle::GetNormal() const
+{
+	Vector3 normal = Vector3::CrossProduct(this->vertices[1] - this->vertices[0], this->vertices[2] - this->vertices[0]);
+	normal.Normalize();
+
+	return normal;
+}
+
+Vector3 Triangle::GetCentroid() const
+{
+	return (this->vertices[0] + this->vertices[1] + this->vertices[2]) * (1.0f / 3.0f);
+}
+
+float Triangle::Area() const
+{
+	return Vector3::CrossProduct(this->vertices[1] - this->vertices[0], this->vertices[2] - this->vertices[0]).Magnitude() * 0.5f;
+}
+
+AABB Triangle::GetBounds() const
+{
+	AABB bounds(this->vertices[0], this->vertices[0]);
+	bounds.Expand(this->vertices[1]);
+	bounds.Expand(this->vertices[2]);
+
+	return bounds;
+}
+
+Triangle& Triangle::operator=(const Triangle& triangle)
+{
+	for (uint_t i = 0; i < 3; i++)
+	{
+		this->vertices[i] = triangle.vertices[i];
+	}
+
+	return *this;
+}
+
+//
+// OBB
+//
+
+OBB::OBB() : center(), halfExtents(), orientation(1.0f, 0.0f, 0.0f, 0.0f) {}
+
+OBB::OBB(const Vector3& center, const Vector3& halfExtents, const Quaternion& orientation) : center(center), halfExtents(halfExtents), orientation(orientation) {}
+
+OBB::OBB(const OBB& box) : center(box.center), halfExtents(box.halfExtents), orientation(box.orientation) {}
+
+bool OBB::Contains(const Vector3& point) const
+{
+	Matrix3x3 axes = this->orientation.GetRotationMatrix();
+
+	const float* m = axes.GetData();
+	const float* extents = this->halfExtents.GetData();
+	Vector3 offset = point - this->center;
+	const float* d = offset.GetData();
+
+	// Columns of the rotation matrix are the box axes in world space
+	for (uint_t i = 0; i < 3; i++)
+	{
+		float projection = d[0] * m[i] + d[1] * m[3 + i] + d[2] * m[6 + i];
+
+		if (Abs(projection) > extents[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+float OBB::Volume() const
+{
+	const float* extents = this->halfExtents.GetData();
+
+	return 8.0f * extents[0] * extents[1] * extents[2];
+}
+
+AABB OBB::GetBounds() const
+{
+	Matrix3x3 axes = this->orientation.GetRotationMatrix();
+
+	const float* m = axes.GetData();
+	const float* extents = this->halfExtents.GetData();
+	float radius[3];
+
+	for (uint_t i = 0; i < 3; i++)
+	{
+		radius[i] = Abs(m[i * 3]) * extents[0] + Abs(m[i * 3 + 1]) * extents[1] + Abs(m[i * 3 + 2]) * extents[2];
+	}
+
+	Vector3 reach = CreateVector3(radius[0], radius[1], radius[2]);
+
+	return AABB(this->center - reach, this->center + reach);
+}
+
+OBB& OBB::operator=(const OBB& box)
+{
+	this->center = box.center;
+	this->halfExtents = box.halfExtents;
+	this->orientation = box.orientation;
+
+	return *this;
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include "math3dhelpers.h"
+#include "quaternion.h"
+#include <iostream>
+
+namespace math3d
+{
+	class Ray
+	{
+	private:
+		Vector3 origin;
+		Vector3 direction;
+		Vector3 inverseDirection;
+
+	public:
+		Ray();
+		Ray(const Vector3& origin, const Vector3& direction);
+		Ray(const Ray& ray);
+		~Ray() = default;
+
+		Vector3 GetPoint(float t) const;
+
+		Ray& operator=(const Ray& ray);
+
+		inline const Vector3& GetOrigin() const
+		{
+			return this->origin;
+		}
+
+		inline const Vector3& GetDirection() const
+		{
+			return this->direction;
+		}
+
+		/* Precomputed per component reciprocal of the direction, used by the slab tests */
+		inline const Vector3& GetInverseDirection() const
+		{
+			return this->inverseDirection;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const Ray& ray)
+		{
+			out << "Ray(" << ray.origin << ", " << ray.direction << ")\n";
+
+			return out;
+		}
+	};
+
+	class Plane
+	{
+	private:
+		Vector3 normal;
+		float distance;
+
+	public:
+		Plane();
+		Plane(const Vector3& normal, float distance);
+		Plane(const Vector3& normal, const Vector3& point);
+		Plane(const Plane& plane);
+		~Plane() = default;
+
+		float SignedDistance(const Vector3& point) const;
+
+		static Plane CreateFromPoints(const Vector3& pointA, const Vector3& pointB, const Vector3& pointC);
+
+		Plane& operator=(const Plane& plane);
+
+		inline const Vector3& GetNormal() const
+		{
+			return this->normal;
+		}
+
+		inline float GetDistance() const
+		{
+			return this->distance;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const Plane& plane)
+		{
+			out << "Plane(" << plane.normal << ", " << plane.distance << ")\n";
+
+			return out;
+		}
+	};
+
+	class AABB
+	{
+	private:
+		Vector3 min;
+		Vector3 max;
+
+	public:
+		AABB();
+		AABB(const Vector3& min, const Vector3& max);
+		AABB(const AABB& box);
+		~AABB() = default;
+
+		void Expand(const Vector3& point);
+		void Expand(const AABB& box);
+		bool IsValid() const;
+		bool Contains(const Vector3& point) const;
+		bool Overlaps(const AABB& box) const;
+		float SurfaceArea() const;
+		Vector3 GetCenter() const;
+		Vector3 GetExtents() const;
+
+		static AABB CreateEmpty();
+		static AABB Union(const AABB& boxA, const AABB& boxB);
+
+		AABB& operator=(const AABB& box);
+
+		inline const Vector3& GetMin() const
+		{
+			return this->min;
+		}
+
+		inline const Vector3& GetMax() const
+		{
+			return this->max;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const AABB& box)
+		{
+			out << "AABB(" << box.min << ", " << box.max << ")\n";
+
+			return out;
+		}
+	};
+
+	class Sphere
+	{
+	private:
+		Vector3 center;
+		float radius;
+
+	public:
+		Sphere();
+		Sphere(const Vector3& center, float radius);
+		Sphere(const Sphere& sphere);
+		~Sphere() = default;
+
+		bool Contains(const Vector3& point) const;
+		AABB GetBounds() const;
+
+		Sphere& operator=(const Sphere& sphere);
+
+		inline const Vector3& GetCenter() const
+		{
+			return this->center;
+		}
+
+		inline float GetRadius() const
+		{
+			return this->radius;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const Sphere& sphere)
+		{
+			out << "Sphere(" << sphere.center << ", " << sphere.radius << ")\n";
+
+			return out;
+		}
+	};
+
+	class Triangle
+	{
+	private:
+		Vector3 vertices[3];
+
+	public:
+		Triangle();
+		Triangle(const Vector3& vertexA, const Vector3& vertexB, const Vector3& vertexC);
+		Triangle(const Triangle& triangle);
+		~Triangle() = default;
+
+		Vector3 GetNormal() const;
+		Vector3 GetCentroid() const;
+		float Area() const;
+		AABB GetBounds() const;
+
+		Triangle& operator=(const Triangle& triangle);
+
+		inline const Vector3& GetVertexAt(const uint_t index) const
+		{
+			if (index >= 3)
+			{
+				throw VectorInvalidIndex();
+			}
+
+			return *(this->vertices + index);
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const Triangle& triangle)
+		{
+			out << "Triangle(" << triangle.vertices[0] << ", " << triangle.vertices[1] << ", " << triangle.vertices[2] << ")\n";
+
+			return out;
+		}
+	};
+
+	class OBB
+	{
+	private:
+		Vector3 center;
+		Vector3 halfExtents;
+		Quaternion orientation;
+
+	public:
+		OBB();
+		OBB(const Vector3& center, const Vector3& halfExtents, const Quaternion& orientation);
+		OBB(const OBB& box);
+		~OBB() = default;
+
+		bool Contains(const Vector3& point) const;
+		float Volume() const;
+		AABB GetBounds() const;
+
+		OBB& operator=(const OBB& box);
+
+		inline const Vector3& GetCenter() const
+		{
+			return this->center;
+		}
+
+		inline const Vector3& GetHalfExtents() const
+		{
+			return this->halfExtents;
+		}
+
+		/* Rotation from box local axes to world */
+		inline const Quaternion& GetOrientation() const
+		{
+			return this->orientation;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const OBB& box)
+		{
+			out << "OBB(" << box.center << ", " << box.halfExtents << ", " << box.orientation << ")\n";
+
+			return out;
+		}
+	};
+}
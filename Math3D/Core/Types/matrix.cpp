@@ -39,6 +39,8 @@ Matrix<T, R, C>::Matrix(const Matrix<T, R, C>& m)
 template <typename T, uintm_t R, uintm_t C>
 Matrix<T, 1, C> Matrix<T, R, C>::GetRow(const uint_t row) const
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_GET_ROW);
+
 	if (row >= R)
 	{
 		throw MatrixInvalidIndex();
@@ -57,6 +59,8 @@ Matrix<T, 1, C> Matrix<T, R, C>::GetRow(const uint_t row) const
 template <typename T, uintm_t R, uintm_t C>
 Matrix<T, R, 1> Matrix<T, R, C>::GetColumn(const uint_t column) const
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_GET_COLUMN);
+
 	if (column >= C)
 	{
 		throw MatrixInvalidIndex();
@@ -87,6 +91,8 @@ void Matrix<T, R, C>::Negate()
 template <typename T, uintm_t R, uintm_t C>
 Matrix<T, C, R> Matrix<T, R, C>::Transpose(const Matrix<T, R, C>& matrix)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_TRANSPOSE);
+
 	Matrix<T, C, R> ret;
 
 	uint_t counter = 0;
@@ -124,6 +130,8 @@ Matrix<T, R, C> Matrix<T, R, C>::Negate(const Matrix<T, R, C>& matrix)
 template <typename T, uintm_t R, uintm_t C>
 Matrix<T, C, R> Matrix<T, R, C>::ReverseMatrix(const Matrix<T, R, C>& matrix)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_REVERSE);
+
 	T det = matrix.Determinant();
 
 	if (!matrix.IsSquare() || IsNearlyEqual(det, (T)0))
@@ -141,6 +149,8 @@ Matrix<T, C, R> Matrix<T, R, C>::ReverseMatrix(const Matrix<T, R, C>& matrix)
 template <typename T, uintm_t R, uintm_t C>
 Matrix<T, R, C> Matrix<T, R, C>::CofactorMatrix(const Matrix<T, R, C>& matrix)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_COFACTOR);
+
 	if (!matrix.IsSquare())
 	{
 		throw MatrixNoSquare();
@@ -239,6 +249,9 @@ Matrix<T, R, C-1> Matrix<T, R, C>::GetWithRemovedColumn(const uint_t column) con
 template <typename T, uintm_t R, uintm_t C>
 T Matrix<T, R, C>::Determinant() const
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_DETERMINANT);
+	MATH3D_INSTRUMENT_RECURSION(COUNTER_MATRIX_DETERMINANT);
+
 	if (!this->IsSquare())
 	{
 		throw MatrixNoSquare();
@@ -363,6 +376,7 @@ Matrix<T, R, C>& Matrix<T, R, C>::operator*=(uint_t scalar)
 
 /* Enforce numeric types */
 // We only allow float Matrices for now
+template class Matrix<float, 1, 1>;
 template class Matrix<float, 1, 2>;
 template class Matrix<float, 1, 3>;
 template class Matrix<float, 1, 4>;
@@ -34,6 +34,7 @@ namespace math3d
 		static Matrix<T, C, R> AdjugateMatrix(const Matrix<T, R, C>& matrix);
 		static Matrix<T, R, C> CreateIdentity();
 
+		Matrix<T, R, C>& operator=(const Matrix<T, R, C>& m) = default;
 		Matrix<T, R, C>& operator+=(const Matrix<T, R, C>& m);
 		Matrix<T, R, C>& operator-=(const Matrix<T, R, C>& m);
 		Matrix<T, R, C>& operator*=(double scalar);
@@ -81,6 +82,17 @@ namespace math3d
 			*(values + row * C + column) = value;
 		}
 
+		/* Unchecked row major access to the underlying values, meant for hot loops */
+		inline const T* GetData() const
+		{
+			return this->values;
+		}
+
+		inline T* GetData()
+		{
+			return this->values;
+		}
+
 		friend void Swap(Matrix<T, R, C>& matrixA, Matrix<T, R, C>& matrixB)
 		{
 			std::swap(matrixA.values, matrixB.values);
@@ -88,7 +100,7 @@ namespace math3d
 
 		friend std::ostream& operator<<(std::ostream& out, const Matrix<T, R, C>& m)
 		{
-			out << std::endl;
+			out << '\n';
 
 			for (int i = 0; i < R; i++)
 			{
@@ -97,10 +109,10 @@ namespace math3d
 				{
 					out << *(m.values + i*C + j) << "\t";
 				}
-				out << "|" << std::endl;
+				out << "|\n";
 			}
 
-			out << std::endl;
+			out << '\n';
 
 			return out;
 		}
@@ -145,6 +157,8 @@ namespace math3d
 	template <typename T, uint_t R, uint_t C, uint_t RO, uint_t CO>
 	Matrix<T, R, CO> operator*(const Matrix<T, R, C>& matrixA, const Matrix<T, RO, CO>& matrixB)
 	{
+		MATH3D_INSTRUMENT_CALL(COUNTER_MATRIX_MULTIPLY);
+
 		if (C != RO)
 		{
 			throw MatrixInvalidDimension();
@@ -0,0 +1,178 @@
+#pragma once
+#include "matrix.h"
+#include <tuple>
+#include <type_traits>
+
+namespace math3d
+{
+	//
+	// Product of a chain of fixed size matrices, MultiplyChain(A, B, C, D).
+	// The parenthesization with the fewest multiplications is chosen at compile time from the
+	// template dimensions (classic matrix chain ordering DP) and the evaluation tree is expanded
+	// into nested calls, so nothing is decided at runtime. Mismatched inner dimensions fail to compile.
+	//
+
+	template <typename M>
+	struct MatrixTraits;
+
+	template <typename T, uintm_t R, uintm_t C>
+	struct MatrixTraits<Matrix<T, R, C>>
+	{
+		typedef T ValueType;
+		static constexpr uint_t rows = R;
+		static constexpr uint_t columns = C;
+	};
+
+	template <uint_t N>
+	struct MatrixChainPlan
+	{
+		unsigned long long cost[N][N];
+		uint_t split[N][N];
+
+		/* dims holds N + 1 entries, matrix i is dims[i] x dims[i + 1] */
+		constexpr MatrixChainPlan(const uint_t* dims) : cost(), split()
+		{
+			for (uint_t length = 1; length < N; length++)
+			{
+				for (uint_t i = 0; i + length < N; i++)
+				{
+					uint_t j = i + length;
+
+					this->cost[i][j] = ~0ull;
+
+					for (uint_t k = i; k < j; k++)
+					{
+						unsigned long long candidate = this->cost[i][k] + this->cost[k + 1][j] + (unsigned long long)dims[i] * dims[k + 1] * dims[j + 1];
+
+						if (candidate < this->cost[i][j])
+						{
+							this->cost[i][j] = candidate;
+							this->split[i][j] = k;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	template <typename... Matrices>
+	struct MatrixChain
+	{
+		static constexpr uint_t count = sizeof...(Matrices);
+
+		typedef typename std::tuple_element<0, std::tuple<Matrices...>>::type FirstType;
+		typedef typename std::tuple_element<count - 1, std::tuple<Matrices...>>::type LastType;
+		typedef typename MatrixTraits<FirstType>::ValueType ValueType;
+		typedef Matrix<ValueType, MatrixTraits<FirstType>::rows, MatrixTraits<LastType>::columns> ResultType;
+
+		static constexpr MatrixChainPlan<count> GetPlan()
+		{
+			const uint_t dims[] = { MatrixTraits<Matrices>::rows..., MatrixTraits<LastType>::columns };
+
+			return MatrixChainPlan<count>(dims);
+		}
+
+		static constexpr bool IsValid()
+		{
+			const uint_t rows[] = { MatrixTraits<Matrices>::rows... };
+			const uint_t columns[] = { MatrixTraits<Matrices>::columns... };
+
+			for (uint_t i = 0; i + 1 < count; i++)
+			{
+				if (columns[i] != rows[i + 1])
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		static constexpr uint_t GetSplit(uint_t first, uint_t last)
+		{
+			return GetPlan().split[first][last];
+		}
+
+		/* Scalar multiplications of the chosen order */
+		static constexpr unsigned long long GetOptimalCost()
+		{
+			return GetPlan().cost[0][count - 1];
+		}
+
+		/* Scalar multiplications of the plain left to right evaluation, for comparison */
+		static constexpr unsigned long long GetLeftToRightCost()
+		{
+			const uint_t dims[] = { MatrixTraits<Matrices>::rows..., MatrixTraits<LastType>::columns };
+			unsigned long long cost = 0;
+
+			for (uint_t i = 1; i < count; i++)
+			{
+				cost += (unsigned long long)dims[0] * dims[i] * dims[i + 1];
+			}
+
+			return cost;
+		}
+	};
+
+	/* Straight product on the raw storage, all trip counts are template constants */
+	template <typename T, uintm_t R, uintm_t K, uintm_t C>
+	Matrix<T, R, C> MultiplyFixed(const Matrix<T, R, K>& matrixA, const Matrix<T, K, C>& matrixB)
+	{
+		Matrix<T, R, C> ret;
+
+		const T* a = matrixA.GetData();
+		const T* b = matrixB.GetData();
+		T* result = ret.GetData();
+
+		for (uint_t i = 0; i < R; i++)
+		{
+			for (uint_t j = 0; j < C; j++)
+			{
+				T sum = a[i * K] * b[j];
+
+				for (uint_t k = 1; k < K; k++)
+				{
+					sum += a[i * K + k] * b[k * C + j];
+				}
+
+				result[i * C + j] = sum;
+			}
+		}
+
+		return ret;
+	}
+
+	/* Evaluates the sub chain [First, Last] of Chain, split where the plan says */
+	template <typename Chain, uint_t First, uint_t Last, bool Leaf = (First == Last)>
+	struct MatrixChainEvaluator
+	{
+		static constexpr uint_t split = Chain::GetSplit(First, Last);
+
+		template <typename Tuple>
+		static auto Evaluate(const Tuple& operands)
+		{
+			return MultiplyFixed(MatrixChainEvaluator<Chain, First, split>::Evaluate(operands), MatrixChainEvaluator<Chain, split + 1, Last>::Evaluate(operands));
+		}
+	};
+
+	template <typename Chain, uint_t First, uint_t Last>
+	struct MatrixChainEvaluator<Chain, First, Last, true>
+	{
+		template <typename Tuple>
+		static const auto& Evaluate(const Tuple& operands)
+		{
+			return std::get<First>(operands);
+		}
+	};
+
+	template <typename... Matrices>
+	typename MatrixChain<Matrices...>::ResultType MultiplyChain(const Matrices&... matrices)
+	{
+		typedef MatrixChain<Matrices...> Chain;
+
+		static_assert(Chain::count >= 2, "MultiplyChain needs at least two matrices");
+		static_assert(Chain::IsValid(), "MultiplyChain inner dimensions do not match");
+
+		return MatrixChainEvaluator<Chain, 0, Chain::count - 1>::Evaluate(std::forward_as_tuple(matrices...));
+	}
+}
@@ -41,6 +41,8 @@ void Quaternion::Inverse()
 
 void Quaternion::Normalize()
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_NORMALIZE);
+
 	if (this->IsUnit())
 	{
 		return;
@@ -71,6 +73,8 @@ float Quaternion::DotProduct(const Quaternion& quat) const
 
 Vector3 Quaternion::RotateVector(Vector3 vec)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_ROTATE_VECTOR);
+
 	Quaternion rotated = *this * Quaternion(0.0, vec[0], vec[1], vec[2]) * Quaternion::Inverse(*this);
 	rotated.ClearNearlyZeroComponents();
 
@@ -81,6 +85,8 @@ Vector3 Quaternion::RotateVector(Vector3 vec)
 
 Quaternion Quaternion::Slerp(const Quaternion& quat, const float alpha) const
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_SLERP);
+
 	Quaternion quatA = Quaternion::Normalize(*this);
 	Quaternion quatB = Quaternion::Normalize(quat);
 
@@ -91,8 +97,32 @@ Quaternion Quaternion::Slerp(const Quaternion& quat, const float alpha) const
 	return ret;
 }
 
+/* Matrix of the rotation v' = q v q^-1, the quaternion is assumed to be unit */
+Matrix3x3 Quaternion::GetRotationMatrix() const
+{
+	float xx = this->x * this->x;
+	float yy = this->y * this->y;
+	float zz = this->z * this->z;
+	float xy = this->x * this->y;
+	float xz = this->x * this->z;
+	float yz = this->y * this->z;
+	float wx = this->w * this->x;
+	float wy = this->w * this->y;
+	float wz = this->w * this->z;
+
+	float values[9] = {
+		1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz), 2.0f * (xz + wy),
+		2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx),
+		2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy)
+	};
+
+	return Matrix3x3(values);
+}
+
 Quaternion Quaternion::Normalize(const Quaternion& quat)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_NORMALIZE);
+
 	if (quat.IsUnit())
 	{
 		return quat;
@@ -150,8 +180,58 @@ Quaternion Quaternion::CreateRotationAboutAxis(float angle, Vector3 axis)
 	return rotation;
 }
 
+/* Expects a proper rotation (orthonormal, determinant +1), picks the best conditioned branch (Shepperd) */
+Quaternion Quaternion::CreateFromRotationMatrix(const Matrix3x3& matrix)
+{
+	const float* m = matrix.GetData();
+
+	float trace = m[0] + m[4] + m[8];
+	Quaternion rotation;
+
+	if (trace > 0.0f)
+	{
+		float s = 0.5f / sqrt(trace + 1.0f);
+
+		rotation.w = 0.25f / s;
+		rotation.x = (m[7] - m[5]) * s;
+		rotation.y = (m[2] - m[6]) * s;
+		rotation.z = (m[3] - m[1]) * s;
+	}
+	else if (m[0] > m[4] && m[0] > m[8])
+	{
+		float s = 2.0f * sqrt(1.0f + m[0] - m[4] - m[8]);
+
+		rotation.w = (m[7] - m[5]) / s;
+		rotation.x = 0.25f * s;
+		rotation.y = (m[1] + m[3]) / s;
+		rotation.z = (m[2] + m[6]) / s;
+	}
+	else if (m[4] > m[8])
+	{
+		float s = 2.0f * sqrt(1.0f + m[4] - m[0] - m[8]);
+
+		rotation.w = (m[2] - m[6]) / s;
+		rotation.x = (m[1] + m[3]) / s;
+		rotation.y = 0.25f * s;
+		rotation.z = (m[5] + m[7]) / s;
+	}
+	else
+	{
+		float s = 2.0f * sqrt(1.0f + m[8] - m[0] - m[4]);
+
+		rotation.w = (m[3] - m[1]) / s;
+		rotation.x = (m[2] + m[6]) / s;
+		rotation.y = (m[5] + m[7]) / s;
+		rotation.z = 0.25f * s;
+	}
+
+	return rotation;
+}
+
 Vector3 Quaternion::RotateVectorBy(Vector3 vec, Quaternion quat)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_ROTATE_VECTOR);
+
 	Quaternion rotated = quat * Quaternion(0.0, vec[0], vec[1], vec[2]) * Quaternion::Inverse(quat);
 	rotated.ClearNearlyZeroComponents();
 
@@ -162,6 +242,8 @@ Vector3 Quaternion::RotateVectorBy(Vector3 vec, Quaternion quat)
 
 Quaternion Quaternion::Slerp(const Quaternion& quatA, const Quaternion& quatB, const float alpha)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_SLERP);
+
 	Quaternion quaternionA = Quaternion::Normalize(quatA);
 	Quaternion quaternionB = Quaternion::Normalize(quatB);
 
@@ -208,6 +290,8 @@ Quaternion& Quaternion::operator-=(const Quaternion& quat)
 
 Quaternion& Quaternion::operator*=(const Quaternion& quat)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_QUATERNION_MULTIPLY);
+
 	double w = (this->w * quat.w) - (this->x * quat.x) - (this->y * quat.y) - (this->z * quat.z);
 	double x = (this->w * quat.x) + (this->x * quat.w) + (this->y * quat.z) - (this->z * quat.y);
 	double y = (this->w * quat.y) + (this->y * quat.w) - (this->x * quat.z) + (this->z * quat.x);
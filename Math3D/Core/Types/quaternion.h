@@ -30,12 +30,14 @@ namespace math3d
 		float DotProduct(const Quaternion& quat) const;
 		Vector3 RotateVector(Vector3 vec);
 		Quaternion Slerp(const Quaternion& quat, const float alpha) const;
+		Matrix3x3 GetRotationMatrix() const;
 
 		static Quaternion Normalize(const Quaternion& quat);
 		static Quaternion Conjugate(const Quaternion& quat);
 		static Quaternion Inverse(const Quaternion& quat);
 		static double DotProduct(const Quaternion& quatA, const Quaternion& quatB);
 		static Quaternion CreateRotationAboutAxis(float angle, Vector3 axis);
+		static Quaternion CreateFromRotationMatrix(const Matrix3x3& matrix);
 		static Vector3 RotateVectorBy(Vector3 vec, Quaternion quat);
 		static Quaternion Slerp(const Quaternion& quatA, const Quaternion& quatB, const float A);
 
@@ -65,29 +67,29 @@ namespace math3d
 			this->z = val;
 		}
 
-		inline double GetW()
+		inline double GetW() const
 		{
 			return this->w;
 		}
 
-		inline double GetX()
+		inline double GetX() const
 		{
 			return this->x;
 		}
 
-		inline double GetY()
+		inline double GetY() const
 		{
 			return this->y;
 		}
 
-		inline double GetZ()
+		inline double GetZ() const
 		{
 			return this->z;
 		}
 
 		friend std::ostream& operator<<(std::ostream& out, const Quaternion& quat)
 		{
-			out << "Q(" << quat.w << ", " << quat.x << ", " << quat.y << ", " << quat.z << ")" << std::endl;
+			out << "Q(" << quat.w << ", " << quat.x << ", " << quat.y << ", " << quat.z << ")\n";
 
 			return out;
 		}
@@ -0,0 +1,280 @@
+#include "sparsematrix.h"
+#include "math3dutil.h"
+#include "math3dparallel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace math3d;
+
+static const uint_t SPARSE_ROW_GRAIN = 2048;
+/* Smallest |det| / Hadamard bound of a diagonal block the block Jacobi preconditioner inverts */
+static const float SPARSE_BLOCK_SINGULAR_TOLERANCE = 1e-6f;
+
+//
+// Buckets triplets by row (counting sort), then sorts each row by column and merges
+// duplicates in place. Writes the compacted row offsets and returns the triplet order.
+//
+static void BuildRowOrder(uint_t rows, uint_t columns, const uint_t* tripletRows, const uint_t* tripletColumns, uint_t tripletCount, std::vector<uint_t>& rowOffsets, std::vector<uint_t>& order)
+{
+	rowOffsets.assign(rows + 1, 0);
+
+	for (uint_t i = 0; i < tripletCount; i++)
+	{
+		if (tripletRows[i] >= rows || tripletColumns[i] >= columns)
+		{
+			throw MatrixInvalidIndex();
+		}
+
+		rowOffsets[tripletRows[i] + 1]++;
+	}
+
+	for (uint_t i = 0; i < rows; i++)
+	{
+		rowOffsets[i + 1] += rowOffsets[i];
+	}
+
+	std::vector<uint_t> cursor(rowOffsets.begin(), rowOffsets.end() - 1);
+	order.resize(tripletCount);
+
+	for (uint_t i = 0; i < tripletCount; i++)
+	{
+		order[cursor[tripletRows[i]]++] = i;
+	}
+
+	for (uint_t i = 0; i < rows; i++)
+	{
+		std::sort(order.begin() + rowOffsets[i], order.begin() + rowOffsets[i + 1], [&](uint_t a, uint_t b)
+		{
+			return tripletColumns[a] < tripletColumns[b] || (tripletColumns[a] == tripletColumns[b] && a < b);
+		});
+	}
+}
+
+template <typename T>
+SparseMatrix<T>::SparseMatrix() : rowOffsets(1, 0), rows(0), columns(0) {}
+
+template <typename T>
+SparseMatrix<T>::SparseMatrix(uint_t rows, uint_t columns, const uint_t* tripletRows, const uint_t* tripletColumns, const T* tripletValues, uint_t tripletCount) : rows(rows), columns(columns)
+{
+	std::vector<uint_t> tripletOffsets;
+	std::vector<uint_t> order;
+
+	BuildRowOrder(rows, columns, tripletRows, tripletColumns, tripletCount, tripletOffsets, order);
+
+	this->rowOffsets.assign(rows + 1, 0);
+	this->columnIndices.reserve(tripletCount);
+	this->values.reserve(tripletCount);
+
+	for (uint_t i = 0; i < rows; i++)
+	{
+		for (uint_t j = tripletOffsets[i]; j < tripletOffsets[i + 1]; j++)
+		{
+			uint_t triplet = order[j];
+			uint_t column = tripletColumns[triplet];
+
+			if (this->columnIndices.size() > this->rowOffsets[i] && this->columnIndices.back() == column)
+			{
+				this->values.back() += tripletValues[triplet];
+				continue;
+			}
+
+			this->columnIndices.push_back(column);
+			this->values.push_back(tripletValues[triplet]);
+		}
+
+		this->rowOffsets[i + 1] = (uint_t)this->values.size();
+	}
+}
+
+template <typename T>
+void SparseMatrix<T>::Multiply(const T* vec, T* result) const
+{
+	const uint_t* offsets = this->rowOffsets.data();
+	const uint_t* indices = this->columnIndices.data();
+	const T* vals = this->values.data();
+
+	ParallelFor(0, this->rows, SPARSE_ROW_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			T sum = (T)0;
+
+			for (uint_t j = offsets[i]; j < offsets[i + 1]; j++)
+			{
+				sum += vals[j] * vec[indices[j]];
+			}
+
+			result[i] = sum;
+		}
+	});
+}
+
+template <typename T>
+void SparseMatrix<T>::GetDiagonal(T* diagonal) const
+{
+	uint_t count = this->rows < this->columns ? this->rows : this->columns;
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		diagonal[i] = this->GetValueAt(i, i);
+	}
+}
+
+template <typename T>
+T SparseMatrix<T>::GetValueAt(const uint_t row, const uint_t column) const
+{
+	if (row >= this->rows || column >= this->columns)
+	{
+		throw MatrixInvalidIndex();
+	}
+
+	const uint_t* first = this->columnIndices.data() + this->rowOffsets[row];
+	const uint_t* last = this->columnIndices.data() + this->rowOffsets[row + 1];
+	const uint_t* found = std::lower_bound(first, last, column);
+
+	if (found == last || *found != column)
+	{
+		return (T)0;
+	}
+
+	return this->values[found - this->columnIndices.data()];
+}
+
+BlockSparseMatrix3x3::BlockSparseMatrix3x3() : blockRowOffsets(1, 0), blockRows(0), blockColumns(0) {}
+
+BlockSparseMatrix3x3::BlockSparseMatrix3x3(uint_t blockRows, uint_t blockColumns, const uint_t* tripletRows, const uint_t* tripletColumns, const Matrix3x3* tripletBlocks, uint_t tripletCount) : blockRows(blockRows), blockColumns(blockColumns)
+{
+	std::vector<uint_t> tripletOffsets;
+	std::vector<uint_t> order;
+
+	BuildRowOrder(blockRows, blockColumns, tripletRows, tripletColumns, tripletCount, tripletOffsets, order);
+
+	this->blockRowOffsets.assign(blockRows + 1, 0);
+	this->blockColumnIndices.reserve(tripletCount);
+	this->blocks.reserve(tripletCount * 9);
+
+	for (uint_t i = 0; i < blockRows; i++)
+	{
+		for (uint_t j = tripletOffsets[i]; j < tripletOffsets[i + 1]; j++)
+		{
+			uint_t triplet = order[j];
+			uint_t column = tripletColumns[triplet];
+			const float* block = tripletBlocks[triplet].GetData();
+
+			if (this->blockColumnIndices.size() > this->blockRowOffsets[i] && this->blockColumnIndices.back() == column)
+			{
+				float* merged = this->blocks.data() + this->blocks.size() - 9;
+
+				for (uint_t k = 0; k < 9; k++)
+				{
+					merged[k] += block[k];
+				}
+
+				continue;
+			}
+
+			this->blockColumnIndices.push_back(column);
+			this->blocks.insert(this->blocks.end(), block, block + 9);
+		}
+
+		this->blockRowOffsets[i + 1] = (uint_t)this->blockColumnIndices.size();
+	}
+}
+
+void BlockSparseMatrix3x3::Multiply(const float* vec, float* result) const
+{
+	const uint_t* offsets = this->blockRowOffsets.data();
+	const uint_t* indices = this->blockColumnIndices.data();
+	const float* vals = this->blocks.data();
+
+	ParallelFor(0, this->blockRows, SPARSE_ROW_GRAIN, [=](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			float x = 0.0f;
+			float y = 0.0f;
+			float z = 0.0f;
+
+			for (uint_t j = offsets[i]; j < offsets[i + 1]; j++)
+			{
+				const float* block = vals + j * 9;
+				const float* v = vec + indices[j] * 3;
+
+				x += block[0] * v[0] + block[1] * v[1] + block[2] * v[2];
+				y += block[3] * v[0] + block[4] * v[1] + block[5] * v[2];
+				z += block[6] * v[0] + block[7] * v[1] + block[8] * v[2];
+			}
+
+			result[i * 3] = x;
+			result[i * 3 + 1] = y;
+			result[i * 3 + 2] = z;
+		}
+	});
+}
+
+void BlockSparseMatrix3x3::GetInverseDiagonalBlocks(float* inverseBlocks) const
+{
+	for (uint_t i = 0; i < this->blockRows; i++)
+	{
+		Matrix3x3 block = this->GetBlockAt(i, i);
+		const float* m = block.GetData();
+		float* inv = inverseBlocks + i * 9;
+
+		// Closed form adjugate, the generic cofactor path is far too slow per block
+		float c00 = m[4] * m[8] - m[5] * m[7];
+		float c01 = m[5] * m[6] - m[3] * m[8];
+		float c02 = m[3] * m[7] - m[4] * m[6];
+		float det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+
+		// Relative to Hadamard's bound |det| <= |row0| |row1| |row2|, so well conditioned blocks
+		// of any scale are inverted. NaN blocks fail the comparison and fall back as well.
+		float r0 = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+		float r1 = std::sqrt(m[3] * m[3] + m[4] * m[4] + m[5] * m[5]);
+		float r2 = std::sqrt(m[6] * m[6] + m[7] * m[7] + m[8] * m[8]);
+
+		if (!(Abs(det) > SPARSE_BLOCK_SINGULAR_TOLERANCE * (r0 * r1 * r2)))
+		{
+			for (uint_t k = 0; k < 9; k++)
+			{
+				inv[k] = (k % 4 == 0) ? 1.0f : 0.0f;
+			}
+
+			continue;
+		}
+
+		float invDet = 1.0f / det;
+
+		inv[0] = c00 * invDet;
+		inv[1] = (m[2] * m[7] - m[1] * m[8]) * invDet;
+		inv[2] = (m[1] * m[5] - m[2] * m[4]) * invDet;
+		inv[3] = c01 * invDet;
+		inv[4] = (m[0] * m[8] - m[2] * m[6]) * invDet;
+		inv[5] = (m[2] * m[3] - m[0] * m[5]) * invDet;
+		inv[6] = c02 * invDet;
+		inv[7] = (m[1] * m[6] - m[0] * m[7]) * invDet;
+		inv[8] = (m[0] * m[4] - m[1] * m[3]) * invDet;
+	}
+}
+
+Matrix3x3 BlockSparseMatrix3x3::GetBlockAt(const uint_t blockRow, const uint_t blockColumn) const
+{
+	if (blockRow >= this->blockRows || blockColumn >= this->blockColumns)
+	{
+		throw MatrixInvalidIndex();
+	}
+
+	const uint_t* first = this->blockColumnIndices.data() + this->blockRowOffsets[blockRow];
+	const uint_t* last = this->blockColumnIndices.data() + this->blockRowOffsets[blockRow + 1];
+	const uint_t* found = std::lower_bound(first, last, blockColumn);
+
+	if (found == last || *found != blockColumn)
+	{
+		return Matrix3x3();
+	}
+
+	return Matrix3x3(this->blocks.data() + (found - this->blockColumnIndices.data()) * 9);
+}
+
+/* Enforce numeric types */
+template class SparseMatrix<float>;
+template class SparseMatrix<double>;
@@ -0,0 +1,112 @@
+#pragma once
+#include "math3dhelpers.h"
+#include "math3dexceptions.h"
+#include <vector>
+
+namespace math3d
+{
+	//
+	// Compressed sparse row matrix. Built once from (row, column, value) triplets,
+	// duplicates are summed. Products run over row ranges on all hardware threads.
+	//
+	template <typename T>
+	class SparseMatrix
+	{
+	protected:
+		std::vector<uint_t> rowOffsets;
+		std::vector<uint_t> columnIndices;
+		std::vector<T> values;
+		uint_t rows;
+		uint_t columns;
+
+	public:
+		SparseMatrix();
+		SparseMatrix(uint_t rows, uint_t columns, const uint_t* tripletRows, const uint_t* tripletColumns, const T* tripletValues, uint_t tripletCount);
+		SparseMatrix(const SparseMatrix<T>& m) = default;
+		~SparseMatrix() = default;
+
+		/* result = this * vec, vec has GetNumberOfColumns() entries, result GetNumberOfRows() */
+		void Multiply(const T* vec, T* result) const;
+		void GetDiagonal(T* diagonal) const;
+		T GetValueAt(const uint_t row, const uint_t column) const;
+
+		SparseMatrix<T>& operator=(const SparseMatrix<T>& m) = default;
+
+		inline uint_t GetNumberOfRows() const
+		{
+			return this->rows;
+		}
+
+		inline uint_t GetNumberOfColumns() const
+		{
+			return this->columns;
+		}
+
+		inline uint_t GetNumberOfNonZeros() const
+		{
+			return (uint_t)this->values.size();
+		}
+
+		inline const uint_t* GetRowOffsets() const
+		{
+			return this->rowOffsets.data();
+		}
+
+		inline const uint_t* GetColumnIndices() const
+		{
+			return this->columnIndices.data();
+		}
+
+		inline const T* GetValues() const
+		{
+			return this->values.data();
+		}
+	};
+
+	//
+	// Block compressed sparse row matrix with dense 3x3 blocks, the natural layout for
+	// systems over Vector3 unknowns (cloth, mesh smoothing). One column index per block
+	// instead of per scalar and 9 contiguous values per block.
+	//
+	class BlockSparseMatrix3x3
+	{
+	protected:
+		std::vector<uint_t> blockRowOffsets;
+		std::vector<uint_t> blockColumnIndices;
+		std::vector<float> blocks;
+		uint_t blockRows;
+		uint_t blockColumns;
+
+	public:
+		BlockSparseMatrix3x3();
+		BlockSparseMatrix3x3(uint_t blockRows, uint_t blockColumns, const uint_t* tripletRows, const uint_t* tripletColumns, const Matrix3x3* tripletBlocks, uint_t tripletCount);
+		BlockSparseMatrix3x3(const BlockSparseMatrix3x3& m) = default;
+		~BlockSparseMatrix3x3() = default;
+
+		/* result = this * vec, both are flat x y z arrays of 3 * block count entries */
+		void Multiply(const float* vec, float* result) const;
+		/* Inverted diagonal blocks, 9 floats per block row, zero and numerically singular blocks (scale independent test) map to identity */
+		void GetInverseDiagonalBlocks(float* inverseBlocks) const;
+		Matrix3x3 GetBlockAt(const uint_t blockRow, const uint_t blockColumn) const;
+
+		BlockSparseMatrix3x3& operator=(const BlockSparseMatrix3x3& m) = default;
+
+		inline uint_t GetNumberOfBlockRows() const
+		{
+			return this->blockRows;
+		}
+
+		inline uint_t GetNumberOfBlockColumns() const
+		{
+			return this->blockColumns;
+		}
+
+		inline uint_t GetNumberOfBlocks() const
+		{
+			return (uint_t)this->blockColumnIndices.size();
+		}
+	};
+
+	typedef SparseMatrix<float> SparseMatrixf;
+	typedef SparseMatrix<double> SparseMatrixd;
+}
@@ -45,6 +45,8 @@ Vector<T, S>::Vector(const Vector<T, S>& v)
 template <typename T, uint_t S>
 T Vector<T, S>::Magnitude() const
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_VECTOR_MAGNITUDE);
+
 	T len = (T)0;
 
 	for (int i = 0; i < S; i++)
@@ -58,6 +60,8 @@ T Vector<T, S>::Magnitude() const
 template <typename T, uint_t S>
 void Vector<T, S>::Normalize()
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_VECTOR_NORMALIZE);
+
 	T len = this->Magnitude();
 
 	for (int i = 0; i < S; i++)
@@ -75,6 +79,8 @@ bool Vector<T, S>::IsNormalized() const
 template <typename T, uint_t S>
 Vector<T, S> Vector<T, S>::Normalize(const Vector<T, S>& vec)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_VECTOR_NORMALIZE);
+
 	T len = vec.Magnitude();
 	Vector<T, S> ret;
 
@@ -89,6 +95,8 @@ Vector<T, S> Vector<T, S>::Normalize(const Vector<T, S>& vec)
 template <typename T, uint_t S>
 T Vector<T, S>::DotProduct(const Vector<T, S>& vector) const
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_VECTOR_DOT_PRODUCT);
+
 	T dot = 0;
 
 	for (uint_t i = 0; i < S; i++)
@@ -102,6 +110,8 @@ T Vector<T, S>::DotProduct(const Vector<T, S>& vector) const
 template <typename T, uint_t S>
 T Vector<T, S>::DotProduct(const Vector<T, S>& vectorA, const Vector<T, S>& vectorB)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_VECTOR_DOT_PRODUCT);
+
 	T dot = 0;
 
 	for (uint_t i = 0; i < S; i++)
@@ -115,6 +125,8 @@ T Vector<T, S>::DotProduct(const Vector<T, S>& vectorA, const Vector<T, S>& vect
 template <typename T, uint_t S>
 Vector<T, S> Vector<T, S>::CrossProduct(const Vector<T, S>& vectorA, const Vector<T, S>& vectorB)
 {
+	MATH3D_INSTRUMENT_CALL(COUNTER_VECTOR_CROSS_PRODUCT);
+
 	if (S > 3 || S <= 1)
 	{
 		throw VectorInvalidSize();
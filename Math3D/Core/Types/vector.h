@@ -54,6 +54,17 @@ namespace math3d
 			*(values + index) = value;
 		}
 
+		/* Unchecked access to the underlying components, meant for hot loops */
+		inline const T* GetData() const
+		{
+			return this->values;
+		}
+
+		inline T* GetData()
+		{
+			return this->values;
+		}
+
 		friend void Swap(Vector<T, S>& vectorA, Vector<T, S>& vectorB)
 		{
 			std::swap(vectorA.values, vectorB.values);
@@ -61,7 +72,7 @@ namespace math3d
 
 		friend std::ostream& operator<<(std::ostream& out, const Vector& v)
 		{
-			out << std::endl;
+			out << '\n';
 
 			out << "V(";
 			for (int i = 0; i < S; i++)
@@ -73,7 +84,7 @@ namespace math3d
 				}
 			}
 
-			out << ")" << std::endl;
+			out << ")\n";
 
 			return out;
 		}
@@ -0,0 +1,497 @@
+#include "math3dbenchmark.h"
+#include "animation.h"
+#include "bvh.h"
+#include "convexhull.h"
+#include "dynamicmatrix.h"
+#include "kdtree.h"
+#include "math3dmorton.h"
+#include "math3dsort.h"
+#include "sweepandprune.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <utility>
+
+using namespace math3d;
+
+BenchmarkHarness::BenchmarkHarness(uint_t repetitions, unsigned int seed) : repetitions(repetitions > 0 ? repetitions : 1), random(seed)
+{
+	this->SetWorkerCounts({ 1, 0 });
+}
+
+void BenchmarkHarness::SetWorkerCounts(const std::vector<uint_t>& counts)
+{
+	uint_t hardware = std::thread::hardware_concurrency();
+
+	this->workerCounts.clear();
+
+	for (uint_t count : counts)
+	{
+		count = count == 0 ? (hardware == 0 ? 1 : hardware) : count;
+
+		if (std::find(this->workerCounts.begin(), this->workerCounts.end(), count) == this->workerCounts.end())
+		{
+			this->workerCounts.push_back(count);
+		}
+	}
+}
+
+void BenchmarkHarness::GenerateUniform(std::vector<float>& values, uint_t count, float minimum, float maximum)
+{
+	std::uniform_real_distribution<float> distribution(minimum, maximum);
+
+	values.resize(count);
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		values[i] = distribution(this->random);
+	}
+}
+
+void BenchmarkHarness::Record(const char* name, const char* unit, double items, uint_t workers, std::vector<double>& seconds)
+{
+	BenchmarkReport report;
+
+	std::sort(seconds.begin(), seconds.end());
+
+	report.name = name;
+	report.unit = unit;
+	report.items = items;
+	report.workers = workers;
+	report.bestSeconds = seconds.front();
+	report.medianSeconds = seconds[seconds.size() / 2];
+
+	this->reports.push_back(report);
+}
+
+void BenchmarkHarness::Print(std::ostream& out) const
+{
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::left << std::setw(32) << "case" << std::right << std::setw(8) << "workers" << std::setw(12) << "items"
+		<< std::setw(12) << "best s" << std::setw(12) << "median s" << std::setw(14) << "rate" << '\n';
+
+	for (const BenchmarkReport& report : this->reports)
+	{
+		out << std::left << std::setw(32) << report.name << std::right << std::setw(8) << report.workers;
+		out << std::setw(12) << std::setprecision(0) << std::fixed << report.items;
+		out << std::setprecision(4) << std::setw(12) << report.bestSeconds << std::setw(12) << report.medianSeconds;
+		out << std::setprecision(2) << std::setw(10) << report.GetRate() * 1e-6 << " M" << report.unit << "/s\n";
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+void BenchmarkHarness::Clear()
+{
+	this->reports.clear();
+}
+
+void math3d::BenchmarkBVH(BenchmarkHarness& harness, uint_t triangleCount, uint_t queryCount)
+{
+	std::vector<float> corners;
+	std::vector<float> offsets;
+	std::vector<Vector3> vertices(triangleCount * 3);
+	std::vector<uint_t> indices(triangleCount * 3);
+
+	// Triangles about 1% of the cube wide, the density of a finely tessellated scene
+	harness.GenerateUniform(corners, triangleCount * 3, -100.0f, 100.0f);
+	harness.GenerateUniform(offsets, triangleCount * 9, -1.0f, 1.0f);
+
+	for (uint_t i = 0; i < triangleCount * 3; i++)
+	{
+		const float* corner = corners.data() + (i / 3) * 3;
+		const float* offset = offsets.data() + i * 3;
+
+		vertices[i] = CreateVector3(corner[0] + offset[0], corner[1] + offset[1], corner[2] + offset[2]);
+		indices[i] = i;
+	}
+
+	BVH bvh;
+
+	harness.Run("BVH build SAH", "tri", triangleCount, [&]()
+	{
+		bvh = BVH(vertices.data(), triangleCount * 3, indices.data(), triangleCount, 4, BVH_BUILD_SAH);
+	});
+
+	harness.Run("BVH build linear", "tri", triangleCount, [&]()
+	{
+		BVH linear(vertices.data(), triangleCount * 3, indices.data(), triangleCount, 4, BVH_BUILD_LINEAR);
+	});
+
+	std::vector<float> origins;
+	std::vector<float> targets;
+	std::vector<Ray> rays(queryCount);
+	std::vector<Vector3> points(queryCount);
+	std::vector<BVHHit> hits(queryCount);
+	std::vector<BVHNearest> nearest(queryCount);
+	std::unique_ptr<bool[]> hitMask(new bool[queryCount]);
+
+	harness.GenerateUniform(origins, queryCount * 3, -100.0f, 100.0f);
+	harness.GenerateUniform(targets, queryCount * 3, -100.0f, 100.0f);
+
+	for (uint_t i = 0; i < queryCount; i++)
+	{
+		const float* o = origins.data() + i * 3;
+		const float* t = targets.data() + i * 3;
+
+		rays[i] = Ray(CreateVector3(o[0], o[1], o[2]), CreateVector3(t[0] - o[0], t[1] - o[1], t[2] - o[2]));
+		points[i] = CreateVector3(o[0], o[1], o[2]);
+	}
+
+	harness.Run("BVH closest hit", "ray", queryCount, [&]()
+	{
+		bvh.Intersect(rays.data(), queryCount, hits.data(), hitMask.get());
+	});
+
+	harness.Run("BVH any hit", "ray", queryCount, [&]()
+	{
+		bvh.IntersectAny(rays.data(), queryCount, hitMask.get());
+	});
+
+	harness.Run("BVH nearest point", "query", queryCount, [&]()
+	{
+		bvh.FindNearestPoint(points.data(), queryCount, nearest.data());
+	});
+}
+
+template <typename T>
+static void BenchmarkProduct(BenchmarkHarness& harness, uint_t size, const char* blockedName, const char* referenceName)
+{
+	std::vector<float> values;
+	DynamicMatrix<T> matrixA(size, size);
+	DynamicMatrix<T> matrixB(size, size);
+	DynamicMatrix<T> result;
+	double flops = 2.0 * size * size * size;
+
+	harness.GenerateUniform(values, size * size * 2, -1.0f, 1.0f);
+
+	for (uint_t i = 0; i < size * size; i++)
+	{
+		matrixA.GetData()[i] = (T)values[i];
+		matrixB.GetData()[i] = (T)values[size * size + i];
+	}
+
+	harness.Run(blockedName, "flop", flops, [&]()
+	{
+		DynamicMatrix<T>::Multiply(matrixA, matrixB, result);
+	});
+
+	harness.Run(referenceName, "flop", flops, [&]()
+	{
+		DynamicMatrix<T>::MultiplyReference(matrixA, matrixB, result);
+	});
+}
+
+void math3d::BenchmarkDynamicMatrix(BenchmarkHarness& harness, uint_t size)
+{
+	BenchmarkProduct<float>(harness, size, "GEMM float blocked", "GEMM float naive");
+	BenchmarkProduct<double>(harness, size, "GEMM double blocked", "GEMM double naive");
+}
+
+void math3d::BenchmarkAnimation(BenchmarkHarness& harness, uint_t trackCount, uint_t keyCount, uint_t frameCount)
+{
+	std::vector<float> values;
+	std::vector<float> times(keyCount);
+	std::vector<Vector3> vectors(keyCount);
+	std::vector<Quaternion> rotations(keyCount);
+	AnimationClip clip;
+
+	for (uint_t track = 0; track < trackCount; track++)
+	{
+		harness.GenerateUniform(values, keyCount * 8, -1.0f, 1.0f);
+
+		// 30 keys per second, jittered so tracks do not share key times
+		for (uint_t key = 0; key < keyCount; key++)
+		{
+			const float* v = values.data() + key * 8;
+
+			times[key] = (key + 0.25f * v[7]) / 30.0f;
+			vectors[key] = CreateVector3(v[0], v[1], v[2]);
+			rotations[key] = Quaternion::Normalize(Quaternion(v[3] + 2.0f, v[4], v[5], v[6]));
+		}
+
+		clip.AddVectorTrack(times.data(), vectors.data(), keyCount);
+		clip.AddRotationTrack(times.data(), rotations.data(), keyCount);
+	}
+
+	float step = clip.GetDuration() / frameCount;
+	double items = 2.0 * trackCount * frameCount;
+	AnimationSampler sampler(clip);
+	AnimationPose pose;
+
+	harness.Run("Animation sample cursor", "track", items, [&]()
+	{
+		sampler.Reset();
+	}, [&]()
+	{
+		for (uint_t frame = 0; frame < frameCount; frame++)
+		{
+			sampler.Sample(frame * step, pose);
+		}
+	});
+
+	harness.Run("Animation sample binary search", "track", items, [&]()
+	{
+		for (uint_t frame = 0; frame < frameCount; frame++)
+		{
+			for (uint_t track = 0; track < trackCount; track++)
+			{
+				pose.vectors[track] = clip.SampleVectorTrack(track, frame * step);
+				pose.rotations[track] = clip.SampleRotationTrack(track, frame * step);
+			}
+		}
+	});
+
+	AnimationPose poses[2];
+	AnimationPose blended;
+	const float weights[2] = { 0.3f, 0.7f };
+
+	sampler.Sample(0.25f * clip.GetDuration(), poses[0]);
+	sampler.Sample(0.75f * clip.GetDuration(), poses[1]);
+
+	harness.Run("Animation blend two poses", "track", items, [&]()
+	{
+		for (uint_t frame = 0; frame < frameCount; frame++)
+		{
+			BlendPoses(poses, weights, 2, blended);
+		}
+	});
+}
+
+/* count points uniform in [-1, 1]^3 */
+static void GeneratePoints(BenchmarkHarness& harness, uint_t count, std::vector<Vector3>& points)
+{
+	std::vector<float> values;
+
+	harness.GenerateUniform(values, count * 3, -1.0f, 1.0f);
+	points.resize(count);
+
+	for (uint_t i = 0; i < count; i++)
+	{
+		points[i] = CreateVector3(values[i * 3], values[i * 3 + 1], values[i * 3 + 2]);
+	}
+}
+
+void math3d::BenchmarkKDTree(BenchmarkHarness& harness, uint_t pointCount, uint_t queryCount)
+{
+	const uint_t k = 8;
+
+	std::vector<Vector3> points;
+	std::vector<Vector3> queries;
+	std::vector<uint_t> indices((std::size_t)queryCount * k);
+	std::vector<float> distances((std::size_t)queryCount * k);
+	std::vector<uint_t> offsets;
+	std::vector<uint_t> neighbors;
+	KDTree tree;
+
+	GeneratePoints(harness, pointCount, points);
+	GeneratePoints(harness, queryCount, queries);
+
+	harness.Run("KDTree build", "point", pointCount, [&]()
+	{
+		tree = KDTree(points.data(), pointCount);
+	});
+
+	harness.Run("KDTree nearest", "query", queryCount, [&]()
+	{
+		tree.FindNearest(queries.data(), queryCount, indices.data(), distances.data());
+	});
+
+	harness.Run("KDTree 8 nearest", "query", queryCount, [&]()
+	{
+		tree.FindKNearest(queries.data(), queryCount, k, indices.data(), distances.data());
+	});
+
+	// 16 expected points in the ball, the cube [-1, 1]^3 has volume 8
+	float radius = (float)std::cbrt(16.0 * 8.0 / (pointCount * 4.0 / 3.0 * 3.14159265358979));
+
+	harness.Run("KDTree radius ~16", "query", queryCount, [&]()
+	{
+		tree.FindInRadius(queries.data(), queryCount, radius, offsets, neighbors);
+	});
+}
+
+void math3d::BenchmarkSweepAndPrune(BenchmarkHarness& harness, uint_t maxBoxCount, uint_t minBoxCount, uint_t bruteForceCount)
+{
+	for (uint_t count = minBoxCount; count > 0 && count <= maxBoxCount; count = count <= maxBoxCount / 10 ? count * 10 : 0)
+	{
+		std::vector<Vector3> centers;
+		std::vector<float> moves;
+		std::vector<AABB> boxes(count);
+		std::vector<AABB> moved(count);
+		Vector3 extent = CreateVector3(0.5f, 0.5f, 0.5f);
+
+		// Unit boxes in a cube of volume count, a box overlaps the 8 others in the 2 wide cube around it
+		float side = (float)std::cbrt((double)count);
+
+		GeneratePoints(harness, count, centers);
+		harness.GenerateUniform(moves, count * 3, -0.01f, 0.01f);
+
+		for (uint_t i = 0; i < count; i++)
+		{
+			Vector3 center = (centers[i] + CreateVector3(1.0f, 1.0f, 1.0f)) * (side * 0.5f);
+			Vector3 offset = CreateVector3(moves[i * 3], moves[i * 3 + 1], moves[i * 3 + 2]);
+
+			boxes[i] = AABB(center - extent, center + extent);
+			moved[i] = AABB(center + offset - extent, center + offset + extent);
+		}
+
+		SweepAndPrune sap;
+
+		sap.Update(boxes.data(), count);
+
+		std::vector<uint_t> pairs((std::size_t)sap.FindPairs(nullptr, 0) * 2 + 2);
+		uint_t capacity = (uint_t)(pairs.size() / 2);
+		std::string suffix = " " + std::to_string(count);
+
+		harness.Run(("SAP rebuild" + suffix).c_str(), "box", count, [&]()
+		{
+			SweepAndPrune rebuilt;
+
+			rebuilt.Update(boxes.data(), count);
+		});
+
+		harness.Run(("SAP update 1% move" + suffix).c_str(), "box", count, [&]()
+		{
+			sap.Update(boxes.data(), count);
+		}, [&]()
+		{
+			sap.Update(moved.data(), count);
+		});
+
+		sap.Update(boxes.data(), count);
+
+		harness.Run(("SAP pairs" + suffix).c_str(), "box", count, [&]()
+		{
+			sap.FindPairs(pairs.data(), capacity);
+		});
+
+		if (count <= bruteForceCount)
+		{
+			harness.Run(("Brute force pairs" + suffix).c_str(), "box", count, [&]()
+			{
+				FindPairsBruteForce(boxes.data(), count, pairs.data(), capacity);
+			});
+		}
+	}
+}
+
+void math3d::BenchmarkMortonSort(BenchmarkHarness& harness, uint_t pointCount)
+{
+	std::vector<Vector3> points;
+	std::vector<uint_t> codes30(pointCount);
+	std::vector<uintc_t> codes63(pointCount);
+	std::vector<uint_t> keys(pointCount);
+	std::vector<uintc_t> wideKeys(pointCount);
+	std::vector<uint_t> values(pointCount);
+	std::vector<uint_t> scratchKeys(pointCount);
+	std::vector<uintc_t> scratchWideKeys(pointCount);
+	std::vector<uint_t> scratchValues(pointCount);
+	std::vector<std::pair<uintc_t, uint_t>> pairs(pointCount);
+	Vector3 boundsMin = CreateVector3(-1.0f, -1.0f, -1.0f);
+	Vector3 boundsMax = CreateVector3(1.0f, 1.0f, 1.0f);
+
+	GeneratePoints(harness, pointCount, points);
+
+	harness.Run("Morton encode 30 bit", "point", pointCount, [&]()
+	{
+		EncodeMorton30(points.data(), pointCount, boundsMin, boundsMax, codes30.data());
+	});
+
+	harness.Run("Morton encode 63 bit", "point", pointCount, [&]()
+	{
+		EncodeMorton63(points.data(), pointCount, boundsMin, boundsMax, codes63.data());
+	});
+
+	auto resetValues = [&]()
+	{
+		for (uint_t i = 0; i < pointCount; i++)
+		{
+			values[i] = i;
+		}
+	};
+
+	harness.Run("Radix sort 32 bit keys", "point", pointCount, [&]()
+	{
+		keys = codes30;
+		resetValues();
+	}, [&]()
+	{
+		RadixSortPairs(keys.data(), values.data(), scratchKeys.data(), scratchValues.data(), pointCount);
+	});
+
+	harness.Run("Radix sort 64 bit keys", "point", pointCount, [&]()
+	{
+		wideKeys = codes63;
+		resetValues();
+	}, [&]()
+	{
+		RadixSortPairs(wideKeys.data(), values.data(), scratchWideKeys.data(), scratchValues.data(), pointCount);
+	});
+
+	harness.Run("std::sort 64 bit keys", "point", pointCount, [&]()
+	{
+		for (uint_t i = 0; i < pointCount; i++)
+		{
+			pairs[i] = std::make_pair(codes63[i], i);
+		}
+	}, [&]()
+	{
+		std::sort(pairs.begin(), pairs.end());
+	});
+}
+
+void math3d::BenchmarkConvexHull(BenchmarkHarness& harness, uint_t pointCount, uint_t spherePointCount)
+{
+	std::vector<Vector3> cube;
+	std::vector<Vector3> ball;
+	std::vector<Vector3> sphere;
+	std::vector<Vector3> candidates;
+
+	GeneratePoints(harness, pointCount, cube);
+
+	// Rejection sampling of the cube, about half the candidates fall in the ball
+	while (ball.size() < pointCount)
+	{
+		GeneratePoints(harness, pointCount, candidates);
+
+		for (const Vector3& point : candidates)
+		{
+			if (ball.size() < pointCount && point.DotProduct(point) <= 1.0f)
+			{
+				ball.push_back(point);
+			}
+		}
+	}
+
+	// Ball points pushed out to the unit sphere
+	for (uint_t i = 0; sphere.size() < spherePointCount; i++)
+	{
+		float length = ball[i % pointCount].Magnitude();
+
+		if (length > 0.0f)
+		{
+			sphere.push_back(ball[i % pointCount] * (1.0f / length));
+		}
+	}
+
+	harness.Run("ConvexHull cube", "point", pointCount, [&]()
+	{
+		ConvexHull hull(cube.data(), pointCount);
+	});
+
+	harness.Run("ConvexHull ball", "point", pointCount, [&]()
+	{
+		ConvexHull hull(ball.data(), pointCount);
+	});
+
+	harness.Run("ConvexHull sphere surface", "point", spherePointCount, [&]()
+	{
+		ConvexHull hull(sphere.data(), spherePointCount);
+	});
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include "math3dhelpers.h"
+#include "math3dparallel.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace math3d
+{
+	struct BenchmarkReport
+	{
+		std::string name;
+		/* What one item is ("tri", "ray", "flop"...), rates are items per second */
+		std::string unit;
+		double items;
+		/* Pool size during the run, see SetWorkerCount */
+		uint_t workers;
+		double bestSeconds;
+		double medianSeconds;
+
+		inline double GetRate() const
+		{
+			return this->bestSeconds > 0.0 ? this->items / this->bestSeconds : 0.0;
+		}
+	};
+
+	//
+	// Times library operations on generated data, every case once per worker count (1 and
+	// GetWorkerCount() by default) so single thread and scaling figures come from the same
+	// binary. Each case runs repetitions times and records the best and the median time; a
+	// setup function, when given, runs before every repetition outside the timed region.
+	//
+	class BenchmarkHarness
+	{
+	private:
+		uint_t repetitions;
+		std::vector<uint_t> workerCounts;
+		std::mt19937 random;
+		std::vector<BenchmarkReport> reports;
+
+		void Record(const char* name, const char* unit, double items, uint_t workers, std::vector<double>& seconds);
+
+	public:
+		BenchmarkHarness(uint_t repetitions = 3, unsigned int seed = 1);
+		BenchmarkHarness(const BenchmarkHarness& harness) = default;
+		~BenchmarkHarness() = default;
+
+		/* Worker counts every case runs with, 0 stands for the hardware thread count */
+		void SetWorkerCounts(const std::vector<uint_t>& counts);
+
+		/* count values uniform in [minimum, maximum] */
+		void GenerateUniform(std::vector<float>& values, uint_t count, float minimum, float maximum);
+
+		template <typename Setup, typename Func>
+		void Run(const char* name, const char* unit, double items, Setup setup, Func func)
+		{
+			uint_t previous = GetWorkerCount();
+
+			for (uint_t workers : this->workerCounts)
+			{
+				std::vector<double> seconds;
+
+				SetWorkerCount(workers);
+
+				for (uint_t r = 0; r < this->repetitions; r++)
+				{
+					setup();
+
+					auto start = std::chrono::steady_clock::now();
+
+					func();
+
+					seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+				}
+
+				this->Record(name, unit, items, GetWorkerCount(), seconds);
+			}
+
+			SetWorkerCount(previous);
+		}
+
+		template <typename Func>
+		void Run(const char* name, const char* unit, double items, Func func)
+		{
+			this->Run(name, unit, items, []() {}, func);
+		}
+
+		/* One aligned row per report: workers, best and median time, rate in millions of items per second */
+		void Print(std::ostream& out) const;
+		void Clear();
+
+		BenchmarkHarness& operator=(const BenchmarkHarness& harness) = default;
+
+		inline std::mt19937& GetRandom()
+		{
+			return this->random;
+		}
+
+		inline const std::vector<BenchmarkReport>& GetReports() const
+		{
+			return this->reports;
+		}
+	};
+
+	//
+	// BVH over triangleCount small random triangles in a cube: SAH and linear build time, then
+	// batched closest hit, any hit and nearest point queries against the SAH tree.
+	//
+	void BenchmarkBVH(BenchmarkHarness& harness, uint_t triangleCount = 1 << 20, uint_t queryCount = 1 << 20);
+
+	//
+	// DynamicMatrix products of two random size x size matrices in float and double, blocked
+	// GEMM against MultiplyReference (the naive triple loop). Items are floating point
+	// operations (2 size^3), so the rate column reads as MFLOP/s.
+	//
+	void BenchmarkDynamicMatrix(BenchmarkHarness& harness, uint_t size = 1024);
+
+	//
+	// Forward playback of a clip with trackCount vector and trackCount rotation tracks of
+	// keyCount keys over frameCount frames: cursor cached AnimationSampler against stateless
+	// binary search sampling, and BlendPoses of two poses. Items are sampled tracks.
+	//
+	void BenchmarkAnimation(BenchmarkHarness& harness, uint_t trackCount = 1024, uint_t keyCount = 30, uint_t frameCount = 1000);
+
+	//
+	// KDTree over pointCount uniform points: build, then batched nearest, 8 nearest and radius
+	// queries (radius sized for about 16 neighbors) at queryCount uniform positions.
+	//
+	void BenchmarkKDTree(BenchmarkHarness& harness, uint_t pointCount = 10000000, uint_t queryCount = 1 << 20);
+
+	//
+	// SweepAndPrune over unit boxes packed uniformly in a cube (about 8 overlaps per box), at
+	// minBoxCount and every tenfold count up to maxBoxCount: full rebuild, update after moving
+	// every box by 1% of its size, pair search, and FindPairsBruteForce up to bruteForceCount
+	// boxes. Items are boxes.
+	//
+	void BenchmarkSweepAndPrune(BenchmarkHarness& harness, uint_t maxBoxCount = 100000, uint_t minBoxCount = 1000, uint_t bruteForceCount = 10000);
+
+	//
+	// 30 and 63 bit Morton codes of pointCount uniform points, then RadixSortPairs of the codes
+	// with their point indices against std::sort of the same 64 bit pairs. Items are points.
+	//
+	void BenchmarkMortonSort(BenchmarkHarness& harness, uint_t pointCount = 10000000);
+
+	//
+	// ConvexHull build over pointCount points uniform in a cube (the prefilter drops nearly all
+	// of them) and in a ball, and over spherePointCount points on a sphere, all of them hull
+	// vertices. Items are input points.
+	//
+	void BenchmarkConvexHull(BenchmarkHarness& harness, uint_t pointCount = 1000000, uint_t spherePointCount = 100000);
+}
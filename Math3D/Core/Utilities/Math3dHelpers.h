@@ -10,6 +10,20 @@ namespace math3d
 	typedef Matrix<float, 3, 3> Matrix3x3;
 	typedef Matrix<float, 4, 4> Matrix4x4;
 
+	inline Vector2 CreateVector2(float x, float y)
+	{
+		float vals[2] = { x, y };
+
+		return Vector2(vals);
+	}
+
+	inline Vector3 CreateVector3(float x, float y, float z)
+	{
+		float vals[3] = { x, y, z };
+
+		return Vector3(vals);
+	}
+
 	/*class Vector2 : public Vector<double>
 	{
 	public:
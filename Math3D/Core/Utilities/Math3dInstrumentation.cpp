@@ -0,0 +1,143 @@
+#include "math3dinstrumentation.h"
+
+using namespace math3d;
+
+static const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+	"matrix_multiply",
+	"matrix_get_row",
+	"matrix_get_column",
+	"matrix_transpose",
+	"matrix_determinant",
+	"matrix_cofactor",
+	"matrix_reverse",
+	"vector_magnitude",
+	"vector_normalize",
+	"vector_dot_product",
+	"vector_cross_product",
+	"quaternion_multiply",
+	"quaternion_normalize",
+	"quaternion_slerp",
+	"quaternion_rotate_vector",
+	"sdf_line_segment",
+	"sdf_circle",
+	"sdf_sphere",
+	"exceptions_thrown"
+};
+
+/* Lock free list of every block ever created, blocks are recycled but never freed */
+static std::atomic<InstrumentationBlock*> blockList(nullptr);
+
+static void ClearBlock(InstrumentationBlock& block)
+{
+	for (uint_t i = 0; i < COUNTER_COUNT; i++)
+	{
+		block.calls[i].store(0, std::memory_order_relaxed);
+		block.maxRecursionDepth[i].store(0, std::memory_order_relaxed);
+		block.samples[i].store(0, std::memory_order_relaxed);
+		block.sampledNanoseconds[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+static InstrumentationBlock* ClaimBlock()
+{
+	// Reuse the block of a finished thread first. Pool workers keep theirs for their lifetime,
+	// blocks only free up when SetWorkerCount restarts the pool or another thread exits
+	for (InstrumentationBlock* block = blockList.load(std::memory_order_acquire); block != nullptr; block = block->next)
+	{
+		bool expected = false;
+
+		if (!block->inUse.load(std::memory_order_relaxed) && block->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+		{
+			return block;
+		}
+	}
+
+	InstrumentationBlock* block = new InstrumentationBlock();
+
+	ClearBlock(*block);
+
+	for (uint_t i = 0; i < COUNTER_COUNT; i++)
+	{
+		block->recursionDepth[i] = 0;
+	}
+
+	block->inUse.store(true, std::memory_order_relaxed);
+	block->next = blockList.load(std::memory_order_relaxed);
+
+	while (!blockList.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+
+	return block;
+}
+
+namespace
+{
+	/* Releases the block when its thread exits so the counts survive and the memory is reused */
+	struct ThreadBlockOwner
+	{
+		InstrumentationBlock* block;
+
+		ThreadBlockOwner() : block(ClaimBlock()) {}
+
+		~ThreadBlockOwner()
+		{
+			this->block->inUse.store(false, std::memory_order_release);
+		}
+	};
+}
+
+InstrumentationBlock& math3d::GetInstrumentationBlock()
+{
+	static thread_local ThreadBlockOwner owner;
+
+	return *owner.block;
+}
+
+InstrumentationSnapshot math3d::TakeInstrumentationSnapshot()
+{
+	InstrumentationSnapshot snapshot = {};
+
+	for (InstrumentationBlock* block = blockList.load(std::memory_order_acquire); block != nullptr; block = block->next)
+	{
+		for (uint_t i = 0; i < COUNTER_COUNT; i++)
+		{
+			uintc_t depth = block->maxRecursionDepth[i].load(std::memory_order_relaxed);
+
+			snapshot.calls[i] += block->calls[i].load(std::memory_order_relaxed);
+			snapshot.samples[i] += block->samples[i].load(std::memory_order_relaxed);
+			snapshot.sampledNanoseconds[i] += block->sampledNanoseconds[i].load(std::memory_order_relaxed);
+			snapshot.maxRecursionDepth[i] = depth > snapshot.maxRecursionDepth[i] ? depth : snapshot.maxRecursionDepth[i];
+		}
+	}
+
+	return snapshot;
+}
+
+void math3d::ResetInstrumentation()
+{
+	for (InstrumentationBlock* block = blockList.load(std::memory_order_acquire); block != nullptr; block = block->next)
+	{
+		ClearBlock(*block);
+	}
+}
+
+const char* math3d::GetInstrumentationCounterName(InstrumentationCounter counter)
+{
+	return counter < COUNTER_COUNT ? COUNTER_NAMES[counter] : "unknown";
+}
+
+void math3d::ExportInstrumentation(std::ostream& out, const InstrumentationSnapshot& snapshot)
+{
+	out << "counter,calls,max_depth,samples,avg_ns\n";
+
+	for (uint_t i = 0; i < COUNTER_COUNT; i++)
+	{
+		InstrumentationCounter counter = (InstrumentationCounter)i;
+
+		out << COUNTER_NAMES[i] << ',' << snapshot.calls[i] << ',' << snapshot.maxRecursionDepth[i] << ','
+			<< snapshot.samples[i] << ',' << snapshot.GetAverageNanoseconds(counter) << '\n';
+	}
+
+	out.flush();
+}
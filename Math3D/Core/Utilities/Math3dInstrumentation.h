@@ -0,0 +1,173 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+//
+// Opt-in instrumentation of the hot paths, compiled in only when MATH3D_ENABLE_INSTRUMENTATION
+// is defined for the whole library. Disabled, the macros expand to nothing.
+// Every thread owns a counter block that only it writes, snapshots sum the blocks without locking.
+//
+#ifdef MATH3D_ENABLE_INSTRUMENTATION
+#define MATH3D_INSTRUMENT_CALL(counter) math3d::InstrumentationScope instrumentationScope(counter)
+#define MATH3D_INSTRUMENT_RECURSION(counter) math3d::RecursionScope recursionScope(counter)
+#define MATH3D_INSTRUMENT_EVENT(counter) math3d::RecordInstrumentationEvent(counter)
+#else
+#define MATH3D_INSTRUMENT_CALL(counter) ((void)0)
+#define MATH3D_INSTRUMENT_RECURSION(counter) ((void)0)
+#define MATH3D_INSTRUMENT_EVENT(counter) ((void)0)
+#endif
+
+namespace math3d
+{
+	typedef unsigned int uint_t;
+	typedef unsigned long long uintc_t;
+
+	enum InstrumentationCounter : uint_t
+	{
+		COUNTER_MATRIX_MULTIPLY,
+		COUNTER_MATRIX_GET_ROW,
+		COUNTER_MATRIX_GET_COLUMN,
+		COUNTER_MATRIX_TRANSPOSE,
+		COUNTER_MATRIX_DETERMINANT,
+		COUNTER_MATRIX_COFACTOR,
+		COUNTER_MATRIX_REVERSE,
+		COUNTER_VECTOR_MAGNITUDE,
+		COUNTER_VECTOR_NORMALIZE,
+		COUNTER_VECTOR_DOT_PRODUCT,
+		COUNTER_VECTOR_CROSS_PRODUCT,
+		COUNTER_QUATERNION_MULTIPLY,
+		COUNTER_QUATERNION_NORMALIZE,
+		COUNTER_QUATERNION_SLERP,
+		COUNTER_QUATERNION_ROTATE_VECTOR,
+		COUNTER_SDF_LINE_SEGMENT,
+		COUNTER_SDF_CIRCLE,
+		COUNTER_SDF_SPHERE,
+		COUNTER_EXCEPTIONS_THROWN,
+		COUNTER_COUNT
+	};
+
+	/* One call in INSTRUMENTATION_SAMPLE_RATE per thread and counter is timed, must be a power of two */
+	const uint_t INSTRUMENTATION_SAMPLE_RATE = 64;
+
+	struct InstrumentationSnapshot
+	{
+		uintc_t calls[COUNTER_COUNT];
+		uintc_t maxRecursionDepth[COUNTER_COUNT];
+		uintc_t samples[COUNTER_COUNT];
+		uintc_t sampledNanoseconds[COUNTER_COUNT];
+
+		/* Mean duration of the sampled calls, 0 when nothing was sampled */
+		double GetAverageNanoseconds(InstrumentationCounter counter) const
+		{
+			return this->samples[counter] == 0 ? 0.0 : (double)this->sampledNanoseconds[counter] / this->samples[counter];
+		}
+	};
+
+	/* Per thread storage, written by its owning thread only with relaxed stores */
+	struct InstrumentationBlock
+	{
+		std::atomic<uintc_t> calls[COUNTER_COUNT];
+		std::atomic<uintc_t> maxRecursionDepth[COUNTER_COUNT];
+		std::atomic<uintc_t> samples[COUNTER_COUNT];
+		std::atomic<uintc_t> sampledNanoseconds[COUNTER_COUNT];
+		uintc_t recursionDepth[COUNTER_COUNT];
+		std::atomic<bool> inUse;
+		InstrumentationBlock* next;
+	};
+
+	constexpr bool IsInstrumentationEnabled()
+	{
+#ifdef MATH3D_ENABLE_INSTRUMENTATION
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/* Block of the calling thread, claimed on first use and handed to a later thread when this one exits */
+	InstrumentationBlock& GetInstrumentationBlock();
+
+	/* Sum of all thread blocks (maximum for the recursion depth), safe to call while other threads run */
+	InstrumentationSnapshot TakeInstrumentationSnapshot();
+	/* Clears every block, updates racing with the reset may survive it */
+	void ResetInstrumentation();
+	const char* GetInstrumentationCounterName(InstrumentationCounter counter);
+	/* One CSV line per counter: name,calls,max_depth,samples,avg_ns */
+	void ExportInstrumentation(std::ostream& out, const InstrumentationSnapshot& snapshot);
+
+	inline void IncrementRelaxed(std::atomic<uintc_t>& value, uintc_t amount)
+	{
+		value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	inline void RecordInstrumentationEvent(InstrumentationCounter counter)
+	{
+		IncrementRelaxed(GetInstrumentationBlock().calls[counter], 1);
+	}
+
+	/* Counts the call and times it when it falls on the sampling interval */
+	class InstrumentationScope
+	{
+	private:
+		InstrumentationBlock& block;
+		InstrumentationCounter counter;
+		bool sampled;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		InstrumentationScope(InstrumentationCounter counter) : block(GetInstrumentationBlock()), counter(counter)
+		{
+			uintc_t calls = this->block.calls[counter].load(std::memory_order_relaxed);
+
+			this->block.calls[counter].store(calls + 1, std::memory_order_relaxed);
+			this->sampled = (calls & (INSTRUMENTATION_SAMPLE_RATE - 1)) == 0;
+
+			if (this->sampled)
+			{
+				this->start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~InstrumentationScope()
+		{
+			if (this->sampled)
+			{
+				auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->start);
+
+				IncrementRelaxed(this->block.samples[this->counter], 1);
+				IncrementRelaxed(this->block.sampledNanoseconds[this->counter], (uintc_t)elapsed.count());
+			}
+		}
+
+		InstrumentationScope(const InstrumentationScope&) = delete;
+		InstrumentationScope& operator=(const InstrumentationScope&) = delete;
+	};
+
+	/* Tracks the current and maximum nesting of a recursive function on this thread */
+	class RecursionScope
+	{
+	private:
+		InstrumentationBlock& block;
+		InstrumentationCounter counter;
+
+	public:
+		RecursionScope(InstrumentationCounter counter) : block(GetInstrumentationBlock()), counter(counter)
+		{
+			uintc_t depth = ++this->block.recursionDepth[counter];
+
+			if (depth > this->block.maxRecursionDepth[counter].load(std::memory_order_relaxed))
+			{
+				this->block.maxRecursionDepth[counter].store(depth, std::memory_order_relaxed);
+			}
+		}
+
+		~RecursionScope()
+		{
+			this->block.recursionDepth[this->counter]--;
+		}
+
+		RecursionScope(const RecursionScope&) = delete;
+		RecursionScope& operator=(const RecursionScope&) = delete;
+	};
+}
@@ -0,0 +1,84 @@
+#include "math3dmorton.h"
+#include "math3dparallel.h"
+
+using namespace math3d;
+
+static const uint_t MORTON_GRAIN = 65536;
+
+/* Grid cell of value along one axis, clamped to [0, cells - 1] */
+static inline uint_t Quantize(float value, float minimum, float scale, uint_t cells)
+{
+	float cell = (value - minimum) * scale;
+
+	if (!(cell > 0.0f))
+	{
+		return 0;
+	}
+
+	return cell >= (float)(cells - 1) ? cells - 1 : (uint_t)cell;
+}
+
+/* Cells per unit length along each axis, 0 for flat axes so every point lands in cell 0 */
+static void GetGridScale(const Vector3& boundsMin, const Vector3& boundsMax, uint_t cells, float* scale)
+{
+	for (uint_t axis = 0; axis < 3; axis++)
+	{
+		float extent = boundsMax.GetData()[axis] - boundsMin.GetData()[axis];
+
+		scale[axis] = extent > 0.0f ? (float)cells / extent : 0.0f;
+	}
+}
+
+void math3d::EncodeMorton30(const Vector3* points, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uint_t* codes)
+{
+	const uint_t cells = 1u << 10;
+	const float* minimum = boundsMin.GetData();
+	float scale[3];
+
+	GetGridScale(boundsMin, boundsMax, cells, scale);
+
+	ParallelFor(0, count, MORTON_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			const float* p = points[i].GetData();
+
+			codes[i] = EncodeMorton30(Quantize(p[0], minimum[0], scale[0], cells), Quantize(p[1], minimum[1], scale[1], cells),
+				Quantize(p[2], minimum[2], scale[2], cells));
+		}
+	});
+}
+
+//
+// Shared loop of the 63 bit overloads, getPoint(i) returns the three coordinates of point i.
+//
+template <typename GetPoint>
+static void EncodeMorton63Points(GetPoint getPoint, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uintc_t* codes)
+{
+	const uint_t cells = 1u << 21;
+	const float* minimum = boundsMin.GetData();
+	float scale[3];
+
+	GetGridScale(boundsMin, boundsMax, cells, scale);
+
+	ParallelFor(0, count, MORTON_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		for (uint_t i = begin; i < end; i++)
+		{
+			const float* p = getPoint(i);
+
+			codes[i] = EncodeMorton63(Quantize(p[0], minimum[0], scale[0], cells), Quantize(p[1], minimum[1], scale[1], cells),
+				Quantize(p[2], minimum[2], scale[2], cells));
+		}
+	});
+}
+
+void math3d::EncodeMorton63(const Vector3* points, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uintc_t* codes)
+{
+	EncodeMorton63Points([points](uint_t i) { return points[i].GetData(); }, count, boundsMin, boundsMax, codes);
+}
+
+void math3d::EncodeMorton63(const float* coordinates, size_t stride, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uintc_t* codes)
+{
+	EncodeMorton63Points([coordinates, stride](uint_t i) { return coordinates + i * stride; }, count, boundsMin, boundsMax, codes);
+}
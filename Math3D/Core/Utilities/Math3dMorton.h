@@ -0,0 +1,113 @@
+#pragma once
+#include "math3dhelpers.h"
+
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define MATH3D_BMI2
+#endif
+
+namespace math3d
+{
+	//
+	// Morton (Z order) codes interleave x, y, z bits as ...z1y1x1z0y0x0. With BMI2 every axis is
+	// a single pdep, otherwise the bits are spread with shift and mask steps. pdep is microcoded
+	// on AMD before Zen 3, where the shift version is the faster of the two.
+	//
+	inline uint_t EncodeMorton30(uint_t x, uint_t y, uint_t z)
+	{
+#ifdef MATH3D_BMI2
+		return _pdep_u32(x, 0x09249249u) | _pdep_u32(y, 0x12492492u) | _pdep_u32(z, 0x24924924u);
+#else
+		uint_t axes[3] = { x, y, z };
+		uint_t code = 0;
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			uint_t v = axes[axis] & 0x3FFu;
+
+			v = (v | (v << 16)) & 0x030000FFu;
+			v = (v | (v << 8)) & 0x0300F00Fu;
+			v = (v | (v << 4)) & 0x030C30C3u;
+			v = (v | (v << 2)) & 0x09249249u;
+			code |= v << axis;
+		}
+
+		return code;
+#endif
+	}
+
+	inline uintc_t EncodeMorton63(uint_t x, uint_t y, uint_t z)
+	{
+#ifdef MATH3D_BMI2
+		return _pdep_u64(x, 0x1249249249249249ull) | _pdep_u64(y, 0x2492492492492492ull) | _pdep_u64(z, 0x4924924924924924ull);
+#else
+		uint_t axes[3] = { x, y, z };
+		uintc_t code = 0;
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			uintc_t v = axes[axis] & 0x1FFFFFull;
+
+			v = (v | (v << 32)) & 0x001F00000000FFFFull;
+			v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+			v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+			v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+			v = (v | (v << 2)) & 0x1249249249249249ull;
+			code |= v << axis;
+		}
+
+		return code;
+#endif
+	}
+
+	inline void DecodeMorton30(uint_t code, uint_t& x, uint_t& y, uint_t& z)
+	{
+		uint_t axes[3];
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			uint_t v = (code >> axis) & 0x09249249u;
+
+			v = (v ^ (v >> 2)) & 0x030C30C3u;
+			v = (v ^ (v >> 4)) & 0x0300F00Fu;
+			v = (v ^ (v >> 8)) & 0x030000FFu;
+			v = (v ^ (v >> 16)) & 0x000003FFu;
+			axes[axis] = v;
+		}
+
+		x = axes[0];
+		y = axes[1];
+		z = axes[2];
+	}
+
+	inline void DecodeMorton63(uintc_t code, uint_t& x, uint_t& y, uint_t& z)
+	{
+		uint_t axes[3];
+
+		for (uint_t axis = 0; axis < 3; axis++)
+		{
+			uintc_t v = (code >> axis) & 0x1249249249249249ull;
+
+			v = (v ^ (v >> 2)) & 0x10C30C30C30C30C3ull;
+			v = (v ^ (v >> 4)) & 0x100F00F00F00F00Full;
+			v = (v ^ (v >> 8)) & 0x001F0000FF0000FFull;
+			v = (v ^ (v >> 16)) & 0x001F00000000FFFFull;
+			v = (v ^ (v >> 32)) & 0x00000000001FFFFFull;
+			axes[axis] = (uint_t)v;
+		}
+
+		x = axes[0];
+		y = axes[1];
+		z = axes[2];
+	}
+
+	//
+	// Batched codes of points quantized on a 1024^3 (30 bit) or 2097152^3 (63 bit) grid over
+	// [boundsMin, boundsMax], points outside the bounds are clamped. Parallel over chunks, see
+	// BenchmarkMortonSort for timings.
+	//
+	void EncodeMorton30(const Vector3* points, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uint_t* codes);
+	void EncodeMorton63(const Vector3* points, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uintc_t* codes);
+	/* Point i at coordinates + i * stride (x, y, z consecutive), for centroids kept in plain float arrays */
+	void EncodeMorton63(const float* coordinates, size_t stride, uint_t count, const Vector3& boundsMin, const Vector3& boundsMax, uintc_t* codes);
+}
@@ -0,0 +1,258 @@
+#include "math3dparallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace math3d;
+
+namespace
+{
+	//
+	// Workers sleep on a condition variable between dispatches and check in once they are done
+	// with a job, so the job fields can be reused as soon as the caller returns. Only the first
+	// taskCount - 1 workers take part in a job, the others go back to sleep right away.
+	//
+	class WorkerPool
+	{
+	private:
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+		uint_t generation;
+		uint_t participants;
+		uint_t activeWorkers;
+		bool stopping;
+
+		void (*task)(void*, uint_t);
+		void* context;
+		uint_t taskCount;
+		std::atomic<uint_t> nextTask;
+		std::atomic<bool> failed;
+		std::exception_ptr exception;
+
+		void RunTasks()
+		{
+			for (uint_t i = this->nextTask.fetch_add(1); i < this->taskCount; i = this->nextTask.fetch_add(1))
+			{
+				if (this->failed.load(std::memory_order_relaxed))
+				{
+					continue;
+				}
+
+				try
+				{
+					this->task(this->context, i);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+
+					if (!this->exception)
+					{
+						this->exception = std::current_exception();
+					}
+
+					this->failed = true;
+				}
+			}
+		}
+
+		/* seen is the generation current at spawn time, older jobs are none of this worker's business */
+		void WorkerLoop(uint_t index, uint_t seen)
+		{
+
+			while (true)
+			{
+				{
+					std::unique_lock<std::mutex> lock(this->mutex);
+
+					this->wake.wait(lock, [&]() { return this->stopping || this->generation != seen; });
+
+					if (this->stopping)
+					{
+						return;
+					}
+
+					seen = this->generation;
+
+					if (index >= this->participants)
+					{
+						continue;
+					}
+				}
+
+				this->RunTasks();
+
+				std::lock_guard<std::mutex> lock(this->mutex);
+
+				if (--this->activeWorkers == 0)
+				{
+					this->done.notify_one();
+				}
+			}
+		}
+
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->stopping = true;
+			}
+
+			this->wake.notify_all();
+
+			for (std::thread& thread : this->threads)
+			{
+				thread.join();
+			}
+
+			this->threads.clear();
+			this->stopping = false;
+		}
+
+	public:
+		std::atomic<uint_t> workerCount;
+		std::atomic<bool> busy;
+
+		WorkerPool() : generation(0), participants(0), activeWorkers(0), stopping(false), task(nullptr), context(nullptr), taskCount(0),
+			nextTask(0), failed(false), workerCount(0), busy(false)
+		{
+			uint_t hardware = std::thread::hardware_concurrency();
+
+			this->workerCount = hardware == 0 ? 1 : hardware;
+		}
+
+		~WorkerPool()
+		{
+			this->Stop();
+		}
+
+		void Acquire()
+		{
+			while (this->busy.exchange(true, std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		void Resize(uint_t count)
+		{
+			this->Acquire();
+			this->Stop();
+			this->workerCount = count;
+			this->busy.store(false, std::memory_order_release);
+		}
+
+		/* Caller owns busy */
+		void Dispatch(uint_t taskCount, void (*task)(void*, uint_t), void* context)
+		{
+			if (this->threads.size() + 1 < this->workerCount)
+			{
+				uint_t current;
+
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					current = this->generation;
+				}
+
+				for (uint_t i = (uint_t)this->threads.size(); i + 1 < this->workerCount; i++)
+				{
+					this->threads.emplace_back(&WorkerPool::WorkerLoop, this, i, current);
+				}
+			}
+
+			uint_t helpers = taskCount - 1 < (uint_t)this->threads.size() ? taskCount - 1 : (uint_t)this->threads.size();
+
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+
+				this->task = task;
+				this->context = context;
+				this->taskCount = taskCount;
+				this->nextTask = 0;
+				this->failed = false;
+				this->exception = nullptr;
+				this->participants = helpers;
+				this->activeWorkers = helpers;
+				this->generation++;
+			}
+
+			if (helpers > 0)
+			{
+				this->wake.notify_all();
+			}
+
+			this->RunTasks();
+
+			std::unique_lock<std::mutex> lock(this->mutex);
+
+			this->done.wait(lock, [&]() { return this->activeWorkers == 0; });
+
+			std::exception_ptr exception = this->exception;
+
+			this->exception = nullptr;
+			lock.unlock();
+
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+	};
+
+	WorkerPool& GetWorkerPool()
+	{
+		static WorkerPool pool;
+
+		return pool;
+	}
+
+	/* Releases the pool on every exit path of a dispatch */
+	struct PoolGuard
+	{
+		WorkerPool& pool;
+
+		~PoolGuard()
+		{
+			this->pool.busy.store(false, std::memory_order_release);
+		}
+	};
+}
+
+uint_t math3d::GetWorkerCount()
+{
+	return GetWorkerPool().workerCount.load(std::memory_order_relaxed);
+}
+
+void math3d::SetWorkerCount(uint_t count)
+{
+	if (count == 0)
+	{
+		count = std::thread::hardware_concurrency();
+		count = count == 0 ? 1 : count;
+	}
+
+	GetWorkerPool().Resize(count);
+}
+
+void math3d::ParallelDispatch(uint_t taskCount, void (*task)(void*, uint_t), void* context)
+{
+	WorkerPool& pool = GetWorkerPool();
+
+	if (taskCount > 1 && pool.workerCount > 1 && !pool.busy.exchange(true, std::memory_order_acquire))
+	{
+		PoolGuard guard = { pool };
+
+		pool.Dispatch(taskCount, task, context);
+
+		return;
+	}
+
+	for (uint_t i = 0; i < taskCount; i++)
+	{
+		task(context, i);
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "vector.h"
+#include <vector>
+
+namespace math3d
+{
+	/* Threads running ParallelFor and ParallelSum chunks, the calling thread included */
+	uint_t GetWorkerCount();
+
+	//
+	// Resizes the worker pool to count threads including the caller, 0 restores
+	// std::thread::hardware_concurrency(). Waits for a running dispatch to finish first.
+	//
+	void SetWorkerCount(uint_t count);
+
+	//
+	// Runs task(context, i) for every i in [0, taskCount) on a pool of persistent worker
+	// threads, started on first use, and takes tasks on the calling thread as well. Returns
+	// once every task is done and rethrows the first exception a task threw, tasks not started
+	// by then are skipped. A call made while the pool is busy, nested in a task or from another
+	// thread, runs all of its tasks on the calling thread instead of waiting for the pool.
+	//
+	void ParallelDispatch(uint_t taskCount, void (*task)(void*, uint_t), void* context);
+
+	//
+	// Splits [begin, end) in contiguous chunks of at least grainSize elements and runs
+	// func(chunkBegin, chunkEnd) on each chunk, one chunk per worker. func is shared by the
+	// workers, not copied. An exception thrown by func is rethrown on the calling thread.
+	//
+	template <typename Func>
+	void ParallelFor(uint_t begin, uint_t end, uint_t grainSize, Func func)
+	{
+		if (end <= begin)
+		{
+			return;
+		}
+
+		uint_t count = end - begin;
+		uint_t grain = grainSize == 0 ? 1 : grainSize;
+		uint_t workers = (count + grain - 1) / grain;
+		uint_t maxWorkers = GetWorkerCount();
+
+		workers = workers < maxWorkers ? workers : maxWorkers;
+
+		if (workers <= 1)
+		{
+			func(begin, end);
+
+			return;
+		}
+
+		struct ChunkRange
+		{
+			Func* func;
+			uint_t begin;
+			uint_t end;
+			uint_t chunk;
+		};
+
+		uint_t chunk = (count + workers - 1) / workers;
+		ChunkRange range = { &func, begin, end, chunk };
+
+		ParallelDispatch((count + chunk - 1) / chunk, [](void* context, uint_t task)
+		{
+			const ChunkRange& range = *(const ChunkRange*)context;
+			uint_t chunkBegin = range.begin + task * range.chunk;
+			uint_t chunkEnd = range.end - chunkBegin > range.chunk ? chunkBegin + range.chunk : range.end;
+
+			(*range.func)(chunkBegin, chunkEnd);
+		}, &range);
+	}
+
+	//
+	// Same chunking as ParallelFor, func(chunkBegin, chunkEnd) returns the partial result
+	// of its chunk. Partials are summed in chunk order so results only depend on the
+	// worker count, not on scheduling.
+	//
+	template <typename T, typename Func>
+	T ParallelSum(uint_t begin, uint_t end, uint_t grainSize, Func func)
+	{
+		if (end <= begin)
+		{
+			return (T)0;
+		}
+
+		uint_t count = end - begin;
+		uint_t grain = grainSize == 0 ? 1 : grainSize;
+		uint_t workers = (count + grain - 1) / grain;
+		uint_t maxWorkers = GetWorkerCount();
+
+		workers = workers < maxWorkers ? workers : maxWorkers;
+
+		if (workers <= 1)
+		{
+			return func(begin, end);
+		}
+
+		struct ChunkRange
+		{
+			Func* func;
+			T* partials;
+			uint_t begin;
+			uint_t end;
+			uint_t chunk;
+		};
+
+		uint_t chunk = (count + workers - 1) / workers;
+		std::vector<T> partials((count + chunk - 1) / chunk, (T)0);
+		ChunkRange range = { &func, partials.data(), begin, end, chunk };
+
+		ParallelDispatch((uint_t)partials.size(), [](void* context, uint_t task)
+		{
+			const ChunkRange& range = *(const ChunkRange*)context;
+			uint_t chunkBegin = range.begin + task * range.chunk;
+			uint_t chunkEnd = range.end - chunkBegin > range.chunk ? chunkBegin + range.chunk : range.end;
+
+			range.partials[task] = (*range.func)(chunkBegin, chunkEnd);
+		}, &range);
+
+		T sum = (T)0;
+		for (const T& partial : partials)
+		{
+			sum += partial;
+		}
+
+		return sum;
+	}
+}
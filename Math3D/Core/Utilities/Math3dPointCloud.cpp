@@ -0,0 +1,652 @@
+#include "math3dpointcloud.h"
+#include "math3dparallel.h"
+#include "math3dexceptions.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace math3d;
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 arrays are treated as tightly packed floats");
+
+static const uint_t POINTCLOUD_GRAIN = 16384;
+/* Text bodies are split in chunks of at least this many bytes for line indexing */
+static const size_t POINTCLOUD_INDEX_BYTES = 1 << 20;
+
+PointCloudFile::PointCloudFile() : data(nullptr), size(0), format(POINTCLOUD_XYZ), vertexCount(0), vertexStride(0), bodyOffset(0) {}
+
+PointCloudFile::PointCloudFile(const char* path) : PointCloudFile()
+{
+	this->Open(path);
+}
+
+PointCloudFile::~PointCloudFile()
+{
+	this->Close();
+}
+
+void PointCloudFile::Map(const char* path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw FileOpenFailed();
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		throw FileOpenFailed();
+	}
+
+	this->size = (size_t)fileSize.QuadPart;
+
+	if (this->size == 0)
+	{
+		CloseHandle(file);
+
+		return;
+	}
+
+	// The view keeps the mapping alive, both handles can be closed right away
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	CloseHandle(file);
+
+	if (mapping == nullptr)
+	{
+		throw FileOpenFailed();
+	}
+
+	this->data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+
+	if (this->data == nullptr)
+	{
+		this->size = 0;
+		throw FileOpenFailed();
+	}
+#else
+	int descriptor = open(path, O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		throw FileOpenFailed();
+	}
+
+	struct stat status;
+
+	if (fstat(descriptor, &status) != 0)
+	{
+		close(descriptor);
+		throw FileOpenFailed();
+	}
+
+	this->size = (size_t)status.st_size;
+
+	if (this->size == 0)
+	{
+		close(descriptor);
+
+		return;
+	}
+
+	void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+	close(descriptor);
+
+	if (mapped == MAP_FAILED)
+	{
+		this->size = 0;
+		throw FileOpenFailed();
+	}
+
+	madvise(mapped, this->size, MADV_SEQUENTIAL);
+	this->data = (const char*)mapped;
+#endif
+}
+
+void PointCloudFile::Unmap()
+{
+	if (this->data != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(this->data);
+#else
+		munmap((void*)this->data, this->size);
+#endif
+	}
+
+	this->data = nullptr;
+	this->size = 0;
+}
+
+static bool ParseScalarType(const std::string& name, PointCloudScalar& type, uint_t& size)
+{
+	static const char* NAMES[] = { "char", "int8", "uchar", "uint8", "short", "int16", "ushort", "uint16", "int", "int32", "uint", "uint32", "float", "float32", "double", "float64" };
+	static const uint_t SIZES[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+	for (uint_t i = 0; i < 16; i++)
+	{
+		if (name == NAMES[i])
+		{
+			type = (PointCloudScalar)(i / 2);
+			size = SIZES[i / 2];
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static std::vector<std::string> SplitHeaderLine(const char* begin, const char* end)
+{
+	std::vector<std::string> tokens;
+
+	while (begin < end)
+	{
+		while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+		{
+			begin++;
+		}
+
+		const char* tokenEnd = begin;
+
+		while (tokenEnd < end && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r')
+		{
+			tokenEnd++;
+		}
+
+		if (tokenEnd > begin)
+		{
+			tokens.emplace_back(begin, tokenEnd);
+		}
+
+		begin = tokenEnd;
+	}
+
+	return tokens;
+}
+
+void PointCloudFile::ParseHeader()
+{
+	this->properties.clear();
+
+	if (this->size < 4 || std::memcmp(this->data, "ply", 3) != 0 || (this->data[3] != '\n' && this->data[3] != '\r'))
+	{
+		// XYZ text, columns past the position are ignored
+		this->format = POINTCLOUD_XYZ;
+		this->bodyOffset = 0;
+		this->properties.push_back({ "x", SCALAR_FLOAT32, 0 });
+		this->properties.push_back({ "y", SCALAR_FLOAT32, 1 });
+		this->properties.push_back({ "z", SCALAR_FLOAT32, 2 });
+
+		return;
+	}
+
+	const char* end = this->data + this->size;
+	const char* line = this->data;
+	bool hasFormat = false;
+	bool hasVertex = false;
+	bool inVertex = false;
+	uint_t stride = 0;
+
+	while (true)
+	{
+		const char* lineEnd = (const char*)std::memchr(line, '\n', end - line);
+
+		if (lineEnd == nullptr)
+		{
+			throw PointCloudInvalidFormat();
+		}
+
+		std::vector<std::string> tokens = SplitHeaderLine(line, lineEnd);
+
+		line = lineEnd + 1;
+
+		if (tokens.empty() || tokens[0] == "ply" || tokens[0] == "comment" || tokens[0] == "obj_info")
+		{
+			continue;
+		}
+
+		if (tokens[0] == "end_header")
+		{
+			break;
+		}
+
+		if (tokens[0] == "format" && tokens.size() >= 2)
+		{
+			if (tokens[1] == "ascii")
+			{
+				this->format = POINTCLOUD_PLY_ASCII;
+			}
+			else if (tokens[1] == "binary_little_endian")
+			{
+				this->format = POINTCLOUD_PLY_BINARY_LITTLE_ENDIAN;
+			}
+			else if (tokens[1] == "binary_big_endian")
+			{
+				this->format = POINTCLOUD_PLY_BINARY_BIG_ENDIAN;
+			}
+			else
+			{
+				throw PointCloudInvalidFormat();
+			}
+
+			hasFormat = true;
+		}
+		else if (tokens[0] == "element" && tokens.size() >= 3)
+		{
+			// Records of elements ahead of the vertices would have to be skipped, lists make their size unknown
+			if (!hasVertex && tokens[1] != "vertex")
+			{
+				throw PointCloudInvalidFormat();
+			}
+
+			inVertex = tokens[1] == "vertex";
+
+			if (inVertex)
+			{
+				hasVertex = true;
+				this->vertexCount = (uint_t)std::strtoul(tokens[2].c_str(), nullptr, 10);
+			}
+		}
+		else if (tokens[0] == "property" && inVertex)
+		{
+			PointCloudScalar type;
+			uint_t typeSize;
+
+			if (tokens.size() != 3 || !ParseScalarType(tokens[1], type, typeSize))
+			{
+				throw PointCloudInvalidFormat();
+			}
+
+			uint_t offset = this->format == POINTCLOUD_PLY_ASCII ? (uint_t)this->properties.size() : stride;
+
+			this->properties.push_back({ tokens[2], type, offset });
+			stride += typeSize;
+		}
+	}
+
+	if (!hasFormat || !hasVertex)
+	{
+		throw PointCloudInvalidFormat();
+	}
+
+	this->bodyOffset = line - this->data;
+	this->vertexStride = stride;
+
+	if (this->IsBinary() && (this->size - this->bodyOffset) / (stride > 0 ? stride : 1) < this->vertexCount)
+	{
+		throw PointCloudInvalidFormat();
+	}
+}
+
+static inline bool IsPointLine(const char* line, const char* end)
+{
+	while (line < end && (*line == ' ' || *line == '\t' || *line == '\r'))
+	{
+		line++;
+	}
+
+	return line < end && *line != '\n' && *line != '#';
+}
+
+void PointCloudFile::IndexLines()
+{
+	const char* body = this->data + this->bodyOffset;
+	const char* end = this->data + this->size;
+	size_t bodySize = end - body;
+	uint_t chunkCount = (uint_t)(bodySize / POINTCLOUD_INDEX_BYTES) + 1;
+	uint_t workers = GetWorkerCount();
+
+	chunkCount = chunkCount < workers ? chunkCount : workers;
+
+	size_t chunkSize = (bodySize + chunkCount - 1) / chunkCount;
+	std::vector<uint_t> counts(chunkCount + 1, 0);
+	uint_t* chunkCounts = counts.data();
+	size_t* offsets = nullptr;
+
+	// A line belongs to the chunk holding its first character, count pass then fill pass at prefix offsets
+	auto scan = [=, &offsets](uint_t chunk, bool fill)
+	{
+		const char* first = body + std::min(chunk * chunkSize, bodySize);
+		const char* last = body + std::min((chunk + 1) * chunkSize, bodySize);
+		const char* line = first;
+		uint_t found = 0;
+
+		if (line > body && line[-1] != '\n')
+		{
+			const char* newline = (const char*)std::memchr(line, '\n', end - line);
+
+			line = newline != nullptr ? newline + 1 : end;
+		}
+
+		while (line < last)
+		{
+			if (IsPointLine(line, end))
+			{
+				if (fill)
+				{
+					offsets[chunkCounts[chunk] + found] = line - this->data;
+				}
+
+				found++;
+			}
+
+			const char* newline = (const char*)std::memchr(line, '\n', end - line);
+
+			line = newline != nullptr ? newline + 1 : end;
+		}
+
+		return found;
+	};
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t begin, uint_t finish)
+	{
+		for (uint_t chunk = begin; chunk < finish; chunk++)
+		{
+			chunkCounts[chunk + 1] = scan(chunk, false);
+		}
+	});
+
+	for (uint_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		chunkCounts[chunk + 1] += chunkCounts[chunk];
+	}
+
+	this->lineOffsets.resize(chunkCounts[chunkCount]);
+	offsets = this->lineOffsets.data();
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t begin, uint_t finish)
+	{
+		for (uint_t chunk = begin; chunk < finish; chunk++)
+		{
+			scan(chunk, true);
+		}
+	});
+
+	if (this->format == POINTCLOUD_XYZ)
+	{
+		this->vertexCount = (uint_t)this->lineOffsets.size();
+	}
+	else if (this->lineOffsets.size() < this->vertexCount)
+	{
+		throw PointCloudInvalidFormat();
+	}
+	else
+	{
+		// Lines past the vertices belong to the following elements
+		this->lineOffsets.resize(this->vertexCount);
+	}
+}
+
+void PointCloudFile::Open(const char* path)
+{
+	this->Close();
+	this->Map(path);
+
+	try
+	{
+		this->ParseHeader();
+
+		if (!this->IsBinary())
+		{
+			this->IndexLines();
+		}
+	}
+	catch (...)
+	{
+		this->Close();
+		throw;
+	}
+}
+
+void PointCloudFile::Close()
+{
+	this->Unmap();
+	this->format = POINTCLOUD_XYZ;
+	this->vertexCount = 0;
+	this->vertexStride = 0;
+	this->bodyOffset = 0;
+	this->properties.clear();
+	this->lineOffsets.clear();
+	this->lineOffsets.shrink_to_fit();
+}
+
+const PointCloudProperty* PointCloudFile::FindProperty(const char* name) const
+{
+	for (const PointCloudProperty& property : this->properties)
+	{
+		if (property.name == name)
+		{
+			return &property;
+		}
+	}
+
+	return nullptr;
+}
+
+PointCloudView PointCloudFile::GetView(const char* name) const
+{
+	const PointCloudProperty* property = this->FindProperty(name);
+
+	if (property == nullptr || !this->IsBinary())
+	{
+		throw PointCloudMissingProperty();
+	}
+
+	PointCloudView view;
+
+	view.data = (const unsigned char*)this->data + this->bodyOffset + property->offset;
+	view.stride = this->vertexStride;
+	view.type = property->type;
+	view.swapBytes = this->format == POINTCLOUD_PLY_BINARY_BIG_ENDIAN;
+
+	return view;
+}
+
+template <typename T>
+static void ConvertProperty(const unsigned char* source, uint_t stride, bool swapBytes, float* values, uint_t valueStride, uint_t begin, uint_t end)
+{
+	for (uint_t i = begin; i < end; i++)
+	{
+		unsigned char bytes[sizeof(T)];
+		T value;
+
+		std::memcpy(bytes, source + (size_t)i * stride, sizeof(T));
+
+		if (swapBytes)
+		{
+			std::reverse(bytes, bytes + sizeof(T));
+		}
+
+		std::memcpy(&value, bytes, sizeof(T));
+		values[(size_t)i * valueStride] = (float)value;
+	}
+}
+
+static void ConvertView(const PointCloudView& view, float* values, uint_t valueStride, uint_t begin, uint_t end)
+{
+	switch (view.type)
+	{
+	case SCALAR_INT8: ConvertProperty<signed char>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_UINT8: ConvertProperty<unsigned char>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_INT16: ConvertProperty<short>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_UINT16: ConvertProperty<unsigned short>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_INT32: ConvertProperty<int>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_UINT32: ConvertProperty<uint_t>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_FLOAT32: ConvertProperty<float>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	case SCALAR_FLOAT64: ConvertProperty<double>(view.data, view.stride, view.swapBytes, values, valueStride, begin, end); break;
+	}
+}
+
+/* Parses one number, from_chars does not take a leading '+' */
+static inline bool ParseText(const char* begin, const char* end, float& value)
+{
+	if (begin < end && *begin == '+')
+	{
+		begin++;
+	}
+
+	std::from_chars_result result = std::from_chars(begin, end, value);
+
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+//
+// Every output gets vertexCount values, valueStride floats apart. Binary records convert in
+// parallel chunks with all columns of a chunk handled together, so each record is read once.
+// Text lines are tokenized up to the last requested column.
+//
+void PointCloudFile::ReadColumns(const PointCloudProperty* const* columns, float* const* outputs, uint_t columnCount, uint_t valueStride) const
+{
+	uint_t count = this->vertexCount;
+
+	if (this->IsBinary())
+	{
+		std::vector<PointCloudView> views(columnCount);
+
+		for (uint_t k = 0; k < columnCount; k++)
+		{
+			views[k] = this->GetView(columns[k]->name.c_str());
+		}
+
+		const PointCloudView* viewData = views.data();
+
+		ParallelFor(0, count, POINTCLOUD_GRAIN, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t k = 0; k < columnCount; k++)
+			{
+				ConvertView(viewData[k], outputs[k], valueStride, begin, end);
+			}
+		});
+
+		return;
+	}
+
+	uint_t lastColumn = 0;
+
+	for (uint_t k = 0; k < columnCount; k++)
+	{
+		lastColumn = columns[k]->offset > lastColumn ? columns[k]->offset : lastColumn;
+	}
+
+	const char* fileData = this->data;
+	const char* fileEnd = this->data + this->size;
+	const size_t* offsets = this->lineOffsets.data();
+	std::atomic<bool> failed(false);
+
+	ParallelFor(0, count, POINTCLOUD_GRAIN, [&](uint_t begin, uint_t end)
+	{
+		bool chunkFailed = false;
+
+		for (uint_t i = begin; i < end; i++)
+		{
+			const char* cursor = fileData + offsets[i];
+
+			for (uint_t column = 0; column <= lastColumn; column++)
+			{
+				while (cursor < fileEnd && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+				{
+					cursor++;
+				}
+
+				const char* tokenEnd = cursor;
+
+				while (tokenEnd < fileEnd && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r' && *tokenEnd != '\n')
+				{
+					tokenEnd++;
+				}
+
+				for (uint_t k = 0; k < columnCount; k++)
+				{
+					if (columns[k]->offset == column)
+					{
+						float& value = outputs[k][(size_t)i * valueStride];
+
+						if (!ParseText(cursor, tokenEnd, value))
+						{
+							value = NAN;
+							chunkFailed = true;
+						}
+					}
+				}
+
+				cursor = tokenEnd;
+			}
+		}
+
+		if (chunkFailed)
+		{
+			failed.store(true, std::memory_order_relaxed);
+		}
+	});
+
+	if (failed.load())
+	{
+		throw PointCloudInvalidFormat();
+	}
+}
+
+void PointCloudFile::ReadProperty(const char* name, float* values) const
+{
+	const PointCloudProperty* property = this->FindProperty(name);
+
+	if (property == nullptr)
+	{
+		throw PointCloudMissingProperty();
+	}
+
+	this->ReadColumns(&property, &values, 1, 1);
+}
+
+void PointCloudFile::ReadPositions(float* x, float* y, float* z) const
+{
+	const PointCloudProperty* columns[3] = { this->FindProperty("x"), this->FindProperty("y"), this->FindProperty("z") };
+	float* outputs[3] = { x, y, z };
+
+	if (columns[0] == nullptr || columns[1] == nullptr || columns[2] == nullptr)
+	{
+		throw PointCloudMissingProperty();
+	}
+
+	this->ReadColumns(columns, outputs, 3, 1);
+}
+
+void PointCloudFile::ReadPositions(Vector3* positions) const
+{
+	const PointCloudProperty* columns[3] = { this->FindProperty("x"), this->FindProperty("y"), this->FindProperty("z") };
+
+	if (columns[0] == nullptr || columns[1] == nullptr || columns[2] == nullptr)
+	{
+		throw PointCloudMissingProperty();
+	}
+
+	if (this->vertexCount == 0)
+	{
+		return;
+	}
+
+	float* values = positions->GetData();
+	float* outputs[3] = { values, values + 1, values + 2 };
+
+	this->ReadColumns(columns, outputs, 3, 3);
+}
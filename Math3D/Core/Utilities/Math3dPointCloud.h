@@ -0,0 +1,145 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace math3d
+{
+	enum PointCloudFormat
+	{
+		POINTCLOUD_XYZ,
+		POINTCLOUD_PLY_ASCII,
+		POINTCLOUD_PLY_BINARY_LITTLE_ENDIAN,
+		POINTCLOUD_PLY_BINARY_BIG_ENDIAN
+	};
+
+	enum PointCloudScalar
+	{
+		SCALAR_INT8,
+		SCALAR_UINT8,
+		SCALAR_INT16,
+		SCALAR_UINT16,
+		SCALAR_INT32,
+		SCALAR_UINT32,
+		SCALAR_FLOAT32,
+		SCALAR_FLOAT64
+	};
+
+	struct PointCloudProperty
+	{
+		std::string name;
+		PointCloudScalar type;
+		/* Byte offset inside a binary vertex record, column index in text formats */
+		uint_t offset;
+	};
+
+	//
+	// Zero copy strided view of one property of a binary file, reads straight from the mapping.
+	// Valid while the file stays open.
+	//
+	struct PointCloudView
+	{
+		const unsigned char* data;
+		uint_t stride;
+		PointCloudScalar type;
+		bool swapBytes;
+
+		/* Value of vertex index widened (or narrowed from double) to float */
+		inline float Get(uint_t index) const
+		{
+			const unsigned char* source = this->data + (size_t)index * this->stride;
+			unsigned char bytes[8];
+			uint_t size = this->type == SCALAR_FLOAT64 ? 8 : this->type >= SCALAR_INT32 ? 4 : this->type >= SCALAR_INT16 ? 2 : 1;
+
+			for (uint_t i = 0; i < size; i++)
+			{
+				bytes[i] = source[this->swapBytes ? size - 1 - i : i];
+			}
+
+			switch (this->type)
+			{
+			case SCALAR_INT8: { signed char v; std::memcpy(&v, bytes, 1); return (float)v; }
+			case SCALAR_UINT8: return (float)bytes[0];
+			case SCALAR_INT16: { short v; std::memcpy(&v, bytes, 2); return (float)v; }
+			case SCALAR_UINT16: { unsigned short v; std::memcpy(&v, bytes, 2); return (float)v; }
+			case SCALAR_INT32: { int v; std::memcpy(&v, bytes, 4); return (float)v; }
+			case SCALAR_UINT32: { uint_t v; std::memcpy(&v, bytes, 4); return (float)v; }
+			case SCALAR_FLOAT32: { float v; std::memcpy(&v, bytes, 4); return v; }
+			default: { double v; std::memcpy(&v, bytes, 8); return (float)v; }
+			}
+		}
+	};
+
+	//
+	// Point cloud file mapped into memory instead of read. Binary PLY vertex properties are
+	// exposed in place as strided views, bulk reads convert the interleaved records into SoA
+	// float arrays (narrowing doubles, swapping big endian data) over parallel chunks.
+	// Text formats (ASCII PLY, XYZ with one point per line, '#' comments) are indexed by line
+	// in parallel on open and parsed with from_chars on read. The vertex element has to come
+	// first in a PLY file and cannot hold list properties.
+	//
+	class PointCloudFile
+	{
+	private:
+		const char* data;
+		size_t size;
+		PointCloudFormat format;
+		uint_t vertexCount;
+		/* Binary vertex record size in bytes */
+		uint_t vertexStride;
+		size_t bodyOffset;
+		std::vector<PointCloudProperty> properties;
+		/* Offset of every point line of a text format */
+		std::vector<size_t> lineOffsets;
+
+		void Map(const char* path);
+		void Unmap();
+		void ParseHeader();
+		void IndexLines();
+		void ReadColumns(const PointCloudProperty* const* columns, float* const* outputs, uint_t columnCount, uint_t valueStride) const;
+
+	public:
+		PointCloudFile();
+		PointCloudFile(const char* path);
+		~PointCloudFile();
+
+		/* Throws FileOpenFailed when the file cannot be mapped, PointCloudInvalidFormat when it cannot be parsed */
+		void Open(const char* path);
+		void Close();
+
+		/* Null when the file has no such vertex property */
+		const PointCloudProperty* FindProperty(const char* name) const;
+		/* Binary files only, throws PointCloudMissingProperty otherwise */
+		PointCloudView GetView(const char* name) const;
+
+		/* vertexCount floats of one property */
+		void ReadProperty(const char* name, float* values) const;
+		/* SoA positions from the x, y and z properties */
+		void ReadPositions(float* x, float* y, float* z) const;
+		void ReadPositions(Vector3* positions) const;
+
+		PointCloudFile(const PointCloudFile&) = delete;
+		PointCloudFile& operator=(const PointCloudFile&) = delete;
+
+		inline PointCloudFormat GetFormat() const
+		{
+			return this->format;
+		}
+
+		inline uint_t GetVertexCount() const
+		{
+			return this->vertexCount;
+		}
+
+		inline const std::vector<PointCloudProperty>& GetProperties() const
+		{
+			return this->properties;
+		}
+
+		inline bool IsBinary() const
+		{
+			return this->format == POINTCLOUD_PLY_BINARY_LITTLE_ENDIAN || this->format == POINTCLOUD_PLY_BINARY_BIG_ENDIAN;
+		}
+	};
+}
@@ -0,0 +1,125 @@
+#include "math3dsort.h"
+#include "math3dparallel.h"
+#include <utility>
+#include <vector>
+
+using namespace math3d;
+
+static const uint_t RADIX_BITS = 8;
+static const uint_t RADIX_BUCKETS = 1 << RADIX_BITS;
+static const uint_t RADIX_CHUNK_GRAIN = 65536;
+
+template <typename Key>
+static void SortPairs(Key* keys, uint_t* values, Key* scratchKeys, uint_t* scratchValues, uint_t count)
+{
+	if (count <= 1)
+	{
+		return;
+	}
+
+	// Fixed chunking so every chunk keeps its histogram and scatter offsets across the phases
+	uint_t chunkCount = (count + RADIX_CHUNK_GRAIN - 1) / RADIX_CHUNK_GRAIN;
+	uint_t workers = GetWorkerCount();
+
+	chunkCount = chunkCount < workers ? chunkCount : workers;
+
+	uint_t chunkSize = (count + chunkCount - 1) / chunkCount;
+	std::vector<uint_t> histograms(chunkCount * RADIX_BUCKETS);
+	Key* sourceKeys = keys;
+	uint_t* sourceValues = values;
+	Key* targetKeys = scratchKeys;
+	uint_t* targetValues = scratchValues;
+
+	for (uint_t shift = 0; shift < sizeof(Key) * 8; shift += RADIX_BITS)
+	{
+		uint_t* counts = histograms.data();
+
+		ParallelFor(0, chunkCount, 1, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t chunk = begin; chunk < end; chunk++)
+			{
+				uint_t* histogram = counts + chunk * RADIX_BUCKETS;
+				uint_t first = chunk * chunkSize;
+				uint_t last = first + chunkSize < count ? first + chunkSize : count;
+
+				for (uint_t b = 0; b < RADIX_BUCKETS; b++)
+				{
+					histogram[b] = 0;
+				}
+
+				for (uint_t i = first; i < last; i++)
+				{
+					histogram[(uint_t)(sourceKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+				}
+			}
+		});
+
+		// Digit major, chunk minor exclusive scan keeps the sort stable
+		uint_t sum = 0;
+		bool uniform = false;
+
+		for (uint_t b = 0; b < RADIX_BUCKETS; b++)
+		{
+			uint_t digitTotal = 0;
+
+			for (uint_t chunk = 0; chunk < chunkCount; chunk++)
+			{
+				uint_t bucketCount = counts[chunk * RADIX_BUCKETS + b];
+
+				counts[chunk * RADIX_BUCKETS + b] = sum;
+				sum += bucketCount;
+				digitTotal += bucketCount;
+			}
+
+			uniform = uniform || digitTotal == count;
+		}
+
+		if (uniform)
+		{
+			continue;
+		}
+
+		ParallelFor(0, chunkCount, 1, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t chunk = begin; chunk < end; chunk++)
+			{
+				uint_t* offsets = counts + chunk * RADIX_BUCKETS;
+				uint_t first = chunk * chunkSize;
+				uint_t last = first + chunkSize < count ? first + chunkSize : count;
+
+				for (uint_t i = first; i < last; i++)
+				{
+					uint_t slot = offsets[(uint_t)(sourceKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+
+					targetKeys[slot] = sourceKeys[i];
+					targetValues[slot] = sourceValues[i];
+				}
+			}
+		});
+
+		std::swap(sourceKeys, targetKeys);
+		std::swap(sourceValues, targetValues);
+	}
+
+	if (sourceKeys != keys)
+	{
+		ParallelFor(0, count, RADIX_CHUNK_GRAIN, [=](uint_t begin, uint_t end)
+		{
+			for (uint_t i = begin; i < end; i++)
+			{
+				keys[i] = sourceKeys[i];
+				values[i] = sourceValues[i];
+			}
+		});
+	}
+}
+
+void math3d::RadixSortPairs(uint_t* keys, uint_t* values, uint_t* scratchKeys, uint_t* scratchValues, uint_t count)
+{
+	SortPairs(keys, values, scratchKeys, scratchValues, count);
+}
+
+void math3d::RadixSortPairs(uintc_t* keys, uint_t* values, uintc_t* scratchKeys, uint_t* scratchValues, uint_t count)
+{
+	SortPairs(keys, values, scratchKeys, scratchValues, count);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <cstring>
+
+namespace math3d
+{
+	/* Order preserving mapping of a float to an unsigned key, negative values sort before positive ones */
+	inline uint_t FloatToSortKey(float value)
+	{
+		uint_t bits;
+
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		return bits ^ ((bits >> 31) != 0 ? 0xFFFFFFFFu : 0x80000000u);
+	}
+
+	//
+	// Stable LSD radix sort of (key, value) pairs by key, 8 bit digits. Every pass builds per
+	// chunk histograms and scatters the chunks in parallel, passes where all keys share the
+	// digit are skipped. The scratch arrays hold count elements, results end up in keys/values.
+	// Every pass is bound by the scattered stores, BenchmarkMortonSort compares it to std::sort.
+	//
+	void RadixSortPairs(uint_t* keys, uint_t* values, uint_t* scratchKeys, uint_t* scratchValues, uint_t count);
+	/* 64 bit keys (e.g. 63 bit Morton codes), unused high digits cost one histogram pass each */
+	void RadixSortPairs(uintc_t* keys, uint_t* values, uintc_t* scratchKeys, uint_t* scratchValues, uint_t count);
+}
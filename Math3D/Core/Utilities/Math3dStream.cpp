@@ -0,0 +1,367 @@
+#include "math3dstream.h"
+#include "math3dexceptions.h"
+#include "math3dparallel.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+using namespace math3d;
+
+static const uint_t STREAM_BUFFER_COUNT = 3;
+static const uint_t STREAM_STAGE_GRAIN = 65536;
+
+namespace
+{
+	/* Blocking FIFO of buffer indices, -1 marks the end of the stream */
+	class BufferQueue
+	{
+	private:
+		std::mutex mutex;
+		std::condition_variable ready;
+		std::deque<int> items;
+
+	public:
+		void Push(int item)
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->items.push_back(item);
+			}
+
+			this->ready.notify_one();
+		}
+
+		int Pop()
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+
+			this->ready.wait(lock, [this]() { return !this->items.empty(); });
+
+			int item = this->items.front();
+
+			this->items.pop_front();
+
+			return item;
+		}
+	};
+
+	inline double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/* The point kernels read components 0-2 and write up to lastComponent */
+	inline void CheckElementWidth(uint_t width, uint_t lastComponent)
+	{
+		if (width < 3 || lastComponent >= width)
+		{
+			throw StreamInvalidWidth();
+		}
+	}
+}
+
+StreamPipeline::StreamPipeline(uint_t elementWidth, size_t memoryBudget) : elementWidth(elementWidth > 0 ? elementWidth : 1)
+{
+	size_t capacity = memoryBudget / (STREAM_BUFFER_COUNT * this->elementWidth * sizeof(float));
+
+	this->chunkCapacity = capacity == 0 ? 1 : capacity > 0x7FFFFFFF ? 0x7FFFFFFF : (uint_t)capacity;
+	this->ResetStatistics();
+}
+
+void StreamPipeline::AddStage(const std::string& name, StreamKernel kernel)
+{
+	// Empty call so a kernel can reject the element width before anything is streamed
+	kernel(nullptr, 0, this->elementWidth);
+
+	this->stages.push_back({ name, kernel, 0.0, 0 });
+}
+
+void StreamPipeline::ResetStatistics()
+{
+	for (StreamStage& stage : this->stages)
+	{
+		stage.seconds = 0.0;
+		stage.elements = 0;
+	}
+
+	this->readSeconds = 0.0;
+	this->writeSeconds = 0.0;
+	this->inputStallSeconds = 0.0;
+	this->wallSeconds = 0.0;
+	this->chunks = 0;
+}
+
+void StreamPipeline::Run(StreamSource source, StreamSink sink)
+{
+	uint_t width = this->elementWidth;
+	uint_t capacity = this->chunkCapacity;
+	std::vector<float> buffers[STREAM_BUFFER_COUNT];
+	uint_t counts[STREAM_BUFFER_COUNT] = {};
+	BufferQueue freeBuffers;
+	BufferQueue filledBuffers;
+	BufferQueue processedBuffers;
+	std::atomic<bool> cancelled(false);
+	std::exception_ptr readError;
+	std::exception_ptr stageError;
+	std::exception_ptr writeError;
+	double readTime = 0.0;
+	double writeTime = 0.0;
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint_t b = 0; b < STREAM_BUFFER_COUNT; b++)
+	{
+		buffers[b].resize((size_t)capacity * width);
+		freeBuffers.Push((int)b);
+	}
+
+	std::thread reader([&]()
+	{
+		while (true)
+		{
+			int b = freeBuffers.Pop();
+			uint_t count = 0;
+
+			if (!cancelled.load(std::memory_order_relaxed))
+			{
+				auto readStart = std::chrono::steady_clock::now();
+
+				try
+				{
+					count = source(buffers[b].data(), capacity);
+				}
+				catch (...)
+				{
+					readError = std::current_exception();
+					count = 0;
+				}
+
+				readTime += SecondsSince(readStart);
+			}
+
+			if (count == 0)
+			{
+				filledBuffers.Push(-1);
+
+				return;
+			}
+
+			counts[b] = count < capacity ? count : capacity;
+			filledBuffers.Push(b);
+		}
+	});
+
+	std::thread writer([&]()
+	{
+		while (true)
+		{
+			int b = processedBuffers.Pop();
+
+			if (b < 0)
+			{
+				return;
+			}
+
+			// After a failure the buffers keep cycling so the reader and the stages can drain
+			if (!writeError)
+			{
+				auto writeStart = std::chrono::steady_clock::now();
+
+				try
+				{
+					sink(buffers[b].data(), counts[b]);
+				}
+				catch (...)
+				{
+					writeError = std::current_exception();
+					cancelled.store(true, std::memory_order_relaxed);
+				}
+
+				writeTime += SecondsSince(writeStart);
+			}
+
+			freeBuffers.Push(b);
+		}
+	});
+
+	while (true)
+	{
+		auto waitStart = std::chrono::steady_clock::now();
+		int b = filledBuffers.Pop();
+
+		this->inputStallSeconds += SecondsSince(waitStart);
+
+		if (b < 0)
+		{
+			processedBuffers.Push(-1);
+			break;
+		}
+
+		// After a stage failure the chunks go straight back to the reader until it stops
+		if (stageError)
+		{
+			freeBuffers.Push(b);
+			continue;
+		}
+
+		float* elements = buffers[b].data();
+		uint_t count = counts[b];
+
+		try
+		{
+			for (StreamStage& stage : this->stages)
+			{
+				const StreamKernel& kernel = stage.kernel;
+				auto stageStart = std::chrono::steady_clock::now();
+
+				ParallelFor(0, count, STREAM_STAGE_GRAIN, [&](uint_t begin, uint_t end)
+				{
+					kernel(elements + (size_t)begin * width, end - begin, width);
+				});
+
+				stage.seconds += SecondsSince(stageStart);
+				stage.elements += count;
+			}
+		}
+		catch (...)
+		{
+			stageError = std::current_exception();
+			cancelled.store(true, std::memory_order_relaxed);
+			freeBuffers.Push(b);
+			continue;
+		}
+
+		this->chunks++;
+		processedBuffers.Push(b);
+	}
+
+	reader.join();
+	writer.join();
+
+	this->readSeconds += readTime;
+	this->writeSeconds += writeTime;
+	this->wallSeconds += SecondsSince(start);
+
+	if (readError)
+	{
+		std::rethrow_exception(readError);
+	}
+
+	if (stageError)
+	{
+		std::rethrow_exception(stageError);
+	}
+
+	if (writeError)
+	{
+		std::rethrow_exception(writeError);
+	}
+}
+
+void StreamPipeline::PrintStatistics(std::ostream& out) const
+{
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::fixed << std::setprecision(3);
+
+	for (const StreamStage& stage : this->stages)
+	{
+		out << std::left << std::setw(24) << stage.name << std::right << std::setw(10) << stage.seconds << " s"
+			<< std::setw(12) << std::setprecision(1) << stage.GetThroughput() * 1e-6 << " M/s\n" << std::setprecision(3);
+	}
+
+	out << std::left << std::setw(24) << "read" << std::right << std::setw(10) << this->readSeconds << " s\n";
+	out << std::left << std::setw(24) << "write" << std::right << std::setw(10) << this->writeSeconds << " s\n";
+	out << std::left << std::setw(24) << "input stall" << std::right << std::setw(10) << this->inputStallSeconds << " s\n";
+	out << std::left << std::setw(24) << "wall" << std::right << std::setw(10) << this->wallSeconds << " s, " << this->chunks << " chunks of "
+		<< this->chunkCapacity << " elements\n";
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+StreamKernel math3d::CreateTransformKernel(const Matrix4x4& matrix)
+{
+	float m[16];
+
+	for (uint_t i = 0; i < 16; i++)
+	{
+		m[i] = matrix.GetData()[i];
+	}
+
+	bool affine = m[12] == 0.0f && m[13] == 0.0f && m[14] == 0.0f && m[15] == 1.0f;
+
+	return [=](float* elements, uint_t count, uint_t width)
+	{
+		CheckElementWidth(width, 2);
+
+		for (uint_t i = 0; i < count; i++)
+		{
+			float* p = elements + (size_t)i * width;
+			float x = p[0];
+			float y = p[1];
+			float z = p[2];
+			float inverseW = affine ? 1.0f : 1.0f / (m[12] * x + m[13] * y + m[14] * z + m[15]);
+
+			p[0] = (m[0] * x + m[1] * y + m[2] * z + m[3]) * inverseW;
+			p[1] = (m[4] * x + m[5] * y + m[6] * z + m[7]) * inverseW;
+			p[2] = (m[8] * x + m[9] * y + m[10] * z + m[11]) * inverseW;
+		}
+	};
+}
+
+StreamKernel math3d::CreateRotationKernel(const Quaternion& rotation)
+{
+	Matrix3x3 matrix = rotation.GetRotationMatrix();
+	float m[9];
+
+	for (uint_t i = 0; i < 9; i++)
+	{
+		m[i] = matrix.GetData()[i];
+	}
+
+	return [=](float* elements, uint_t count, uint_t width)
+	{
+		CheckElementWidth(width, 2);
+
+		for (uint_t i = 0; i < count; i++)
+		{
+			float* p = elements + (size_t)i * width;
+			float x = p[0];
+			float y = p[1];
+			float z = p[2];
+
+			p[0] = m[0] * x + m[1] * y + m[2] * z;
+			p[1] = m[3] * x + m[4] * y + m[5] * z;
+			p[2] = m[6] * x + m[7] * y + m[8] * z;
+		}
+	};
+}
+
+StreamKernel math3d::CreateSphereSDFKernel(const Vector3& center, float radius, uint_t distanceComponent)
+{
+	float cx = center.GetData()[0];
+	float cy = center.GetData()[1];
+	float cz = center.GetData()[2];
+
+	return [=](float* elements, uint_t count, uint_t width)
+	{
+		CheckElementWidth(width, distanceComponent);
+
+		for (uint_t i = 0; i < count; i++)
+		{
+			float* p = elements + (size_t)i * width;
+			float dx = p[0] - cx;
+			float dy = p[1] - cy;
+			float dz = p[2] - cz;
+
+			p[distanceComponent] = std::sqrt(dx * dx + dy * dy + dz * dz) - radius;
+		}
+	};
+}
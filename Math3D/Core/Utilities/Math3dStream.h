@@ -0,0 +1,117 @@
+#pragma once
+#include "math3dhelpers.h"
+#include "quaternion.h"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace math3d
+{
+	//
+	// Processes count elements of width floats in place, called concurrently on disjoint ranges.
+	// AddStage calls it once with count 0, a kernel that cannot handle the width throws there.
+	//
+	typedef std::function<void(float* elements, uint_t count, uint_t width)> StreamKernel;
+	/* Fills up to capacity elements, returns how many were written, 0 ends the stream */
+	typedef std::function<uint_t(float* elements, uint_t capacity)> StreamSource;
+	typedef std::function<void(const float* elements, uint_t count)> StreamSink;
+
+	struct StreamStage
+	{
+		std::string name;
+		StreamKernel kernel;
+		double seconds;
+		uintc_t elements;
+
+		/* Elements per second over the whole run */
+		inline double GetThroughput() const
+		{
+			return this->seconds > 0.0 ? (double)this->elements / this->seconds : 0.0;
+		}
+	};
+
+	//
+	// Streams arbitrarily large inputs through a chain of stages with a fixed memory budget.
+	// The budget is split in three chunk buffers that rotate between a reader thread (source),
+	// the compute stages (each one a ParallelFor over the chunk) and a writer thread (sink), so
+	// reading chunk n + 1 and writing chunk n - 1 overlap with the stages running on chunk n.
+	// Chunks reach the sink in source order. An exception from the source, a stage or the sink
+	// stops the stream, the pipeline drains and joins its threads, then Run rethrows it.
+	// PrintStatistics reports per stage throughput and how much of the reading, stage and
+	// writing time the overlap hid.
+	//
+	class StreamPipeline
+	{
+	private:
+		uint_t elementWidth;
+		uint_t chunkCapacity;
+		std::vector<StreamStage> stages;
+		double readSeconds;
+		double writeSeconds;
+		/* Time the stages waited on the reader, non zero means the stream is input bound */
+		double inputStallSeconds;
+		double wallSeconds;
+		uintc_t chunks;
+
+	public:
+		/* memoryBudget in bytes for the three chunk buffers, a chunk holds at least one element */
+		StreamPipeline(uint_t elementWidth, size_t memoryBudget);
+		StreamPipeline(const StreamPipeline& pipeline) = default;
+		~StreamPipeline() = default;
+
+		void AddStage(const std::string& name, StreamKernel kernel);
+		/* Streams the source to the sink through every stage and accumulates the statistics */
+		void Run(StreamSource source, StreamSink sink);
+		void ResetStatistics();
+		/* One line per stage and one for the reader, writer and wall time */
+		void PrintStatistics(std::ostream& out) const;
+
+		StreamPipeline& operator=(const StreamPipeline& pipeline) = default;
+
+		inline uint_t GetChunkCapacity() const
+		{
+			return this->chunkCapacity;
+		}
+
+		inline uint_t GetElementWidth() const
+		{
+			return this->elementWidth;
+		}
+
+		inline const std::vector<StreamStage>& GetStages() const
+		{
+			return this->stages;
+		}
+
+		inline double GetReadSeconds() const
+		{
+			return this->readSeconds;
+		}
+
+		inline double GetWriteSeconds() const
+		{
+			return this->writeSeconds;
+		}
+
+		inline double GetInputStallSeconds() const
+		{
+			return this->inputStallSeconds;
+		}
+
+		inline double GetWallSeconds() const
+		{
+			return this->wallSeconds;
+		}
+	};
+
+	//
+	// Stage kernels on the first components of each element: points in components 0-2 are
+	// transformed by a matrix (with the perspective divide) or rotated by a unit quaternion, the
+	// sphere SDF writes the signed distance of the point to component distanceComponent. They
+	// throw StreamInvalidWidth for elements narrower than 3 floats or without distanceComponent.
+	//
+	StreamKernel CreateTransformKernel(const Matrix4x4& matrix);
+	StreamKernel CreateRotationKernel(const Quaternion& rotation);
+	StreamKernel CreateSphereSDFKernel(const Vector3& center, float radius, uint_t distanceComponent);
+}
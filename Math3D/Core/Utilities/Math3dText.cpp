@@ -0,0 +1,341 @@
+#include "math3dtext.h"
+#include "math3dparallel.h"
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace math3d;
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion arrays are treated as tightly packed w, x, y, z floats");
+
+/* Records per format chunk and bytes per parse chunk */
+static const uint_t FORMAT_GRAIN = 4096;
+static const size_t PARSE_GRAIN = 1 << 20;
+/* Longest shortest round trip float, "-1.00000005e-38" */
+static const size_t FLOAT_TEXT_SIZE = 15;
+
+/* Each value with its separator and at most one '[' and ']' of a nested row, plus the outer brackets and the newline */
+static inline size_t GetRecordSizeBound(uint_t width)
+{
+	return (size_t)width * (FLOAT_TEXT_SIZE + 3) + 3;
+}
+
+static inline char* FormatValue(float value, bool json, char* cursor)
+{
+	if (json && !std::isfinite(value))
+	{
+		std::memcpy(cursor, "null", 4);
+
+		return cursor + 4;
+	}
+
+	return std::to_chars(cursor, cursor + FLOAT_TEXT_SIZE, value).ptr;
+}
+
+static char* FormatRecord(const float* values, uint_t width, uint_t groupSize, bool json, char* cursor)
+{
+	bool nested = json && groupSize > 0 && groupSize < width;
+
+	if (json)
+	{
+		*cursor++ = '[';
+	}
+
+	for (uint_t k = 0; k < width; k++)
+	{
+		if (k > 0)
+		{
+			*cursor++ = ',';
+		}
+
+		if (nested && k % groupSize == 0)
+		{
+			*cursor++ = '[';
+		}
+
+		cursor = FormatValue(values[k], json, cursor);
+
+		if (nested && ((k + 1) % groupSize == 0 || k + 1 == width))
+		{
+			*cursor++ = ']';
+		}
+	}
+
+	if (json)
+	{
+		*cursor++ = ']';
+	}
+
+	*cursor++ = '\n';
+
+	return cursor;
+}
+
+size_t math3d::GetFormattedSizeBound(uint_t count, uint_t width)
+{
+	return (size_t)count * GetRecordSizeBound(width);
+}
+
+//
+// Every chunk is formatted at its worst case offset, then the chunks are packed towards the
+// front in order. A chunk only ever moves left, over chunks that have already moved.
+//
+size_t math3d::FormatFloatRecords(const float* first, size_t recordStride, uint_t count, uint_t width, uint_t groupSize, TextFormat format,
+	char* buffer, size_t capacity)
+{
+	if (count == 0 || width == 0)
+	{
+		return 0;
+	}
+
+	size_t recordBound = GetRecordSizeBound(width);
+	size_t bound = (size_t)count * recordBound;
+	uint_t chunkCount = (count + FORMAT_GRAIN - 1) / FORMAT_GRAIN;
+	std::vector<size_t> sizes(chunkCount);
+	std::vector<char> scratch;
+	char* staging = buffer;
+	const char* base = (const char*)first;
+	bool json = format == TEXT_JSON_LINES;
+
+	if (capacity < bound)
+	{
+		scratch.resize(bound);
+		staging = scratch.data();
+	}
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t chunkBegin, uint_t chunkEnd)
+	{
+		for (uint_t c = chunkBegin; c < chunkEnd; c++)
+		{
+			uint_t begin = c * FORMAT_GRAIN;
+			uint_t end = count - begin > FORMAT_GRAIN ? begin + FORMAT_GRAIN : count;
+			char* start = staging + (size_t)begin * recordBound;
+			char* cursor = start;
+
+			for (uint_t i = begin; i < end; i++)
+			{
+				cursor = FormatRecord((const float*)(base + (size_t)i * recordStride), width, groupSize, json, cursor);
+			}
+
+			sizes[c] = (size_t)(cursor - start);
+		}
+	});
+
+	size_t total = 0;
+
+	for (size_t size : sizes)
+	{
+		total += size;
+	}
+
+	if (total > capacity)
+	{
+		return total;
+	}
+
+	size_t offset = 0;
+
+	for (uint_t c = 0; c < chunkCount; c++)
+	{
+		std::memmove(buffer + offset, staging + (size_t)c * FORMAT_GRAIN * recordBound, sizes[c]);
+		offset += sizes[c];
+	}
+
+	return total;
+}
+
+static inline bool IsSeparator(char c)
+{
+	return c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '[' || c == ']';
+}
+
+static inline bool IsBlank(const char* begin, const char* end)
+{
+	for (const char* p = begin; p < end; p++)
+	{
+		if (*p != ' ' && *p != '\t' && *p != '\r')
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Parses one number, from_chars does not take a leading '+' */
+static inline bool ParseValue(const char* begin, const char* end, float& value)
+{
+	if (end - begin == 4 && std::memcmp(begin, "null", 4) == 0)
+	{
+		value = std::numeric_limits<float>::quiet_NaN();
+
+		return true;
+	}
+
+	if (begin < end && *begin == '+')
+	{
+		begin++;
+	}
+
+	std::from_chars_result result = std::from_chars(begin, end, value);
+
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+/* Validates the line even when values is null, so records past the capacity are still checked */
+static bool ParseRecord(const char* begin, const char* end, uint_t width, float* values)
+{
+	const char* p = begin;
+	uint_t k = 0;
+
+	while (true)
+	{
+		while (p < end && IsSeparator(*p))
+		{
+			p++;
+		}
+
+		if (p == end)
+		{
+			break;
+		}
+
+		const char* token = p;
+
+		while (p < end && !IsSeparator(*p))
+		{
+			p++;
+		}
+
+		float value;
+
+		if (k == width || !ParseValue(token, p, value))
+		{
+			return false;
+		}
+
+		if (values != nullptr)
+		{
+			values[k] = value;
+		}
+
+		k++;
+	}
+
+	return k == width;
+}
+
+static inline const char* FindLineEnd(const char* begin, const char* end)
+{
+	const char* newline = (const char*)std::memchr(begin, '\n', (size_t)(end - begin));
+
+	return newline != nullptr ? newline : end;
+}
+
+//
+// The text is cut every PARSE_GRAIN bytes, moved forward to the next line start. A first pass
+// counts the records of each chunk so the second pass knows where each chunk writes.
+//
+uint_t math3d::ParseFloatRecords(const char* text, size_t length, uint_t width, float* first, size_t recordStride, uint_t capacity)
+{
+	if (length == 0 || width == 0)
+	{
+		return 0;
+	}
+
+	const char* end = text + length;
+	uint_t chunkCount = (uint_t)((length + PARSE_GRAIN - 1) / PARSE_GRAIN);
+	std::vector<const char*> bounds(chunkCount + 1);
+	std::vector<uint_t> firstRecords(chunkCount + 1, 0);
+	std::atomic<bool> failed(false);
+	char* base = (char*)first;
+
+	bounds[0] = text;
+	bounds[chunkCount] = end;
+
+	for (uint_t c = 1; c < chunkCount; c++)
+	{
+		const char* cut = text + (size_t)c * PARSE_GRAIN;
+
+		if (cut < bounds[c - 1])
+		{
+			cut = bounds[c - 1];
+		}
+
+		const char* lineEnd = FindLineEnd(cut, end);
+
+		bounds[c] = lineEnd < end ? lineEnd + 1 : end;
+	}
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t chunkBegin, uint_t chunkEnd)
+	{
+		for (uint_t c = chunkBegin; c < chunkEnd; c++)
+		{
+			uint_t records = 0;
+
+			for (const char* line = bounds[c]; line < bounds[c + 1];)
+			{
+				const char* lineEnd = FindLineEnd(line, bounds[c + 1]);
+
+				records += IsBlank(line, lineEnd) ? 0 : 1;
+				line = lineEnd + 1;
+			}
+
+			firstRecords[c + 1] = records;
+		}
+	});
+
+	for (uint_t c = 0; c < chunkCount; c++)
+	{
+		firstRecords[c + 1] += firstRecords[c];
+	}
+
+	ParallelFor(0, chunkCount, 1, [&](uint_t chunkBegin, uint_t chunkEnd)
+	{
+		for (uint_t c = chunkBegin; c < chunkEnd; c++)
+		{
+			uint_t record = firstRecords[c];
+
+			for (const char* line = bounds[c]; line < bounds[c + 1];)
+			{
+				const char* lineEnd = FindLineEnd(line, bounds[c + 1]);
+
+				if (!IsBlank(line, lineEnd))
+				{
+					float* values = record < capacity ? (float*)(base + (size_t)record * recordStride) : nullptr;
+
+					if (!ParseRecord(line, lineEnd, width, values))
+					{
+						failed.store(true, std::memory_order_relaxed);
+
+						return;
+					}
+
+					record++;
+				}
+
+				line = lineEnd + 1;
+			}
+		}
+	});
+
+	if (failed.load())
+	{
+		throw TextInvalidFormat();
+	}
+
+	return firstRecords[chunkCount];
+}
+
+size_t math3d::FormatQuaternions(const Quaternion* quaternions, uint_t count, TextFormat format, char* buffer, size_t capacity)
+{
+	return FormatFloatRecords((const float*)quaternions, sizeof(Quaternion), count, 4, 0, format, buffer, capacity);
+}
+
+uint_t math3d::ParseQuaternions(const char* text, size_t length, Quaternion* quaternions, uint_t capacity)
+{
+	return ParseFloatRecords(text, length, 4, (float*)quaternions, sizeof(Quaternion), capacity);
+}
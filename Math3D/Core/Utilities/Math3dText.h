@@ -0,0 +1,78 @@
+#pragma once
+#include "math3dhelpers.h"
+#include "quaternion.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace math3d
+{
+	enum TextFormat
+	{
+		/* One record per line, values separated by ',' */
+		TEXT_CSV,
+		/* One JSON array per line, matrices as nested row arrays, non finite values as null */
+		TEXT_JSON_LINES
+	};
+
+	/* Worst case formatted size in bytes of count records of width values */
+	size_t GetFormattedSizeBound(uint_t count, uint_t width);
+
+	//
+	// Bulk text output of count records of width floats, record i starting recordStride bytes after
+	// record i - 1. Values use std::to_chars shortest round trip form, so parsing gives back the
+	// exact floats, with no locale lookups and no stream flushes. groupSize values per nested JSON
+	// array (matrix rows), 0 for flat records. Chunks of records are formatted in parallel.
+	// Returns the formatted size. Nothing is written when it exceeds capacity, the caller can grow
+	// the buffer and call again. A buffer of GetFormattedSizeBound bytes is formatted in place,
+	// smaller buffers go through a scratch buffer of that size.
+	//
+	size_t FormatFloatRecords(const float* first, size_t recordStride, uint_t count, uint_t width, uint_t groupSize, TextFormat format,
+		char* buffer, size_t capacity);
+
+	//
+	// Parses CSV or JSON lines records of width floats, either format is accepted: '[', ']', ',',
+	// spaces and tabs all separate values, blank lines are skipped and null reads as NaN. Writes the
+	// first capacity records recordStride bytes apart and returns the number of records in the
+	// text. Lines are split in chunks parsed in parallel with std::from_chars. Throws
+	// TextInvalidFormat when a line does not hold exactly width numbers. Floats written by
+	// FormatFloatRecords parse back bit exact.
+	//
+	uint_t ParseFloatRecords(const char* text, size_t length, uint_t width, float* first, size_t recordStride, uint_t capacity);
+
+	template <typename T, uint_t S>
+	inline size_t FormatVectors(const Vector<T, S>* vectors, uint_t count, TextFormat format, char* buffer, size_t capacity)
+	{
+		static_assert(std::is_same<T, float>::value, "Text records are float only");
+
+		return FormatFloatRecords(count > 0 ? vectors->GetData() : nullptr, sizeof(Vector<T, S>), count, S, 0, format, buffer, capacity);
+	}
+
+	template <typename T, uintm_t R, uintm_t C>
+	inline size_t FormatMatrices(const Matrix<T, R, C>* matrices, uint_t count, TextFormat format, char* buffer, size_t capacity)
+	{
+		static_assert(std::is_same<T, float>::value, "Text records are float only");
+
+		return FormatFloatRecords(count > 0 ? matrices->GetData() : nullptr, sizeof(Matrix<T, R, C>), count, R * C, C, format, buffer, capacity);
+	}
+
+	/* Records are w, x, y, z */
+	size_t FormatQuaternions(const Quaternion* quaternions, uint_t count, TextFormat format, char* buffer, size_t capacity);
+
+	template <typename T, uint_t S>
+	inline uint_t ParseVectors(const char* text, size_t length, Vector<T, S>* vectors, uint_t capacity)
+	{
+		static_assert(std::is_same<T, float>::value, "Text records are float only");
+
+		return ParseFloatRecords(text, length, S, capacity > 0 ? vectors->GetData() : nullptr, sizeof(Vector<T, S>), capacity);
+	}
+
+	template <typename T, uintm_t R, uintm_t C>
+	inline uint_t ParseMatrices(const char* text, size_t length, Matrix<T, R, C>* matrices, uint_t capacity)
+	{
+		static_assert(std::is_same<T, float>::value, "Text records are float only");
+
+		return ParseFloatRecords(text, length, R * C, capacity > 0 ? matrices->GetData() : nullptr, sizeof(Matrix<T, R, C>), capacity);
+	}
+
+	uint_t ParseQuaternions(const char* text, size_t length, Quaternion* quaternions, uint_t capacity);
+}
@@ -76,6 +76,26 @@ namespace math3d
 		return val > 0.0 ? val : -val;
 	}
 
+	inline float Min(float valA, float valB)
+	{
+		return valA < valB ? valA : valB;
+	}
+
+	inline double Min(double valA, double valB)
+	{
+		return valA < valB ? valA : valB;
+	}
+
+	inline float Max(float valA, float valB)
+	{
+		return valA > valB ? valA : valB;
+	}
+
+	inline double Max(double valA, double valB)
+	{
+		return valA > valB ? valA : valB;
+	}
+
 	inline bool IsNearlyEqual(float valA, float valB)
 	{
 		return Abs(valA - valB) < FLT_EPSILON;
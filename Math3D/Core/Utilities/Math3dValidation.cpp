@@ -0,0 +1,297 @@
+#include "math3dvalidation.h"
+#include "math3dsort.h"
+#include "math3dexceptions.h"
+#include "quaternion.h"
+#include "math3dutil.h"
+#include <cmath>
+#include <iomanip>
+
+using namespace math3d;
+
+static const long double VALIDATION_PI = 3.141592653589793238462643383279502884L;
+
+ValidationHarness::ValidationHarness(uint_t sampleCount, uint_t repetitions, unsigned int seed)
+	: sampleCount(sampleCount), repetitions(repetitions > 0 ? repetitions : 1), random(seed) {}
+
+void ValidationHarness::GenerateUniform(std::vector<float>& inputs, uint_t width, uint_t count, float minimum, float maximum)
+{
+	std::uniform_real_distribution<float> distribution(minimum, maximum);
+
+	inputs.resize(width * count);
+
+	for (uint_t i = 0; i < width * count; i++)
+	{
+		inputs[i] = distribution(this->random);
+	}
+}
+
+/* Inverse of FloatToSortKey */
+static float SortKeyToFloat(uint_t key)
+{
+	uint_t bits = key ^ ((key >> 31) != 0 ? 0x80000000u : 0xFFFFFFFFu);
+	float value;
+
+	std::memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+bool ValidationHarness::GenerateRange(std::vector<float>& inputs, float minimum, float maximum)
+{
+	// Sort keys enumerate the floats of the range in order, -0 and +0 both included
+	uint_t first = FloatToSortKey(minimum);
+	uint_t last = FloatToSortKey(maximum);
+	uintc_t available = (uintc_t)last - first + 1;
+
+	if (first <= last && available <= this->sampleCount)
+	{
+		inputs.resize((size_t)available);
+
+		for (uint_t i = 0; i < (uint_t)available; i++)
+		{
+			inputs[i] = SortKeyToFloat(first + i);
+		}
+
+		return true;
+	}
+
+	this->GenerateUniform(inputs, 1, this->sampleCount, minimum, maximum);
+
+	return false;
+}
+
+double math3d::GetUlpError(float value, long double reference)
+{
+	if (std::isnan(value) || std::isnan(reference))
+	{
+		return std::isnan(value) && std::isnan(reference) ? 0.0 : DBL_MAX;
+	}
+
+	if (std::isinf(value) || std::isinf(reference))
+	{
+		return (long double)value == reference ? 0.0 : DBL_MAX;
+	}
+
+	long double magnitude = std::fabs(reference);
+	long double spacing = std::ldexp(1.0L, -149);
+
+	// Floats in [2^(e-1), 2^e) are 2^(e-24) apart, denormals share the smallest spacing
+	if (magnitude >= (long double)FLT_MIN)
+	{
+		int exponent;
+
+		std::frexp(magnitude, &exponent);
+		spacing = std::ldexp(1.0L, exponent - 24);
+	}
+
+	return (double)(std::fabs((long double)value - reference) / spacing);
+}
+
+const ValidationReport& ValidationHarness::Record(const char* name, const std::vector<float>& inputs, uint_t inputWidth, const std::vector<float>& outputs,
+	const std::vector<long double>& expected, uint_t outputWidth, double fastSeconds, double referenceSeconds, bool exhaustive, const ValidationBudget& budget)
+{
+	ValidationReport report;
+	uint_t count = (uint_t)(inputs.size() / inputWidth);
+	uint_t worst = 0;
+	double sumUlp = 0.0;
+	double sumAbsolute = 0.0;
+
+	report.name = name;
+	report.samples = count;
+	report.exhaustive = exhaustive;
+	report.maxUlp = 0.0;
+	report.maxAbsolute = 0.0;
+
+	for (uint_t i = 0; i < count * outputWidth; i++)
+	{
+		double ulp = GetUlpError(outputs[i], expected[i]);
+		double absolute = std::isnan(outputs[i]) || std::isnan(expected[i]) ? DBL_MAX : (double)std::fabs((long double)outputs[i] - expected[i]);
+
+		// Mean of the finite errors only, a single mismatch already fails through the maximum
+		sumUlp += ulp < DBL_MAX ? ulp : 0.0;
+		sumAbsolute += absolute < DBL_MAX ? absolute : 0.0;
+
+		if (ulp > report.maxUlp)
+		{
+			report.maxUlp = ulp;
+			worst = i / outputWidth;
+		}
+
+		report.maxAbsolute = absolute > report.maxAbsolute ? absolute : report.maxAbsolute;
+	}
+
+	double values = count * outputWidth > 0 ? (double)(count * outputWidth) : 1.0;
+
+	report.meanUlp = sumUlp / values;
+	report.meanAbsolute = sumAbsolute / values;
+
+	if (count > 0)
+	{
+		report.worstInput.assign(inputs.begin() + worst * inputWidth, inputs.begin() + (worst + 1) * inputWidth);
+	}
+
+	report.fastRate = fastSeconds > 0.0 ? count / fastSeconds : 0.0;
+	report.referenceRate = referenceSeconds > 0.0 ? count / referenceSeconds : 0.0;
+	report.budget = budget;
+	report.passed = report.maxUlp <= budget.maxUlp && report.maxAbsolute <= budget.maxAbsolute;
+
+	this->reports.push_back(report);
+
+	return this->reports.back();
+}
+
+bool ValidationHarness::Passed() const
+{
+	for (const ValidationReport& report : this->reports)
+	{
+		if (!report.passed)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ValidationHarness::RequirePassed() const
+{
+	if (!this->Passed())
+	{
+		throw ValidationBudgetExceeded();
+	}
+}
+
+static void PrintBudget(std::ostream& out, double value)
+{
+	if (value >= DBL_MAX)
+	{
+		out << std::setw(10) << '-';
+	}
+	else
+	{
+		out << std::setw(10) << value;
+	}
+}
+
+void ValidationHarness::Print(std::ostream& out) const
+{
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::left << std::setw(24) << "kernel" << std::right << std::setw(10) << "samples" << std::setw(6) << "mode"
+		<< std::setw(13) << "max ulp" << std::setw(11) << "mean ulp" << std::setw(10) << "ulp cap"
+		<< std::setw(10) << "max abs" << std::setw(10) << "mean abs" << std::setw(10) << "abs cap"
+		<< std::setw(10) << "fast M/s" << std::setw(10) << "ref M/s" << std::setw(9) << "speedup" << "  result\n";
+
+	for (const ValidationReport& report : this->reports)
+	{
+		out << std::left << std::setw(24) << report.name << std::right << std::setw(10) << report.samples << std::setw(6) << (report.exhaustive ? "all" : "rand");
+		out << std::fixed << std::setprecision(2);
+		out << std::setw(13) << report.maxUlp << std::setw(11) << report.meanUlp;
+		PrintBudget(out, report.budget.maxUlp);
+		out << std::scientific << std::setprecision(2);
+		out << std::setw(10) << report.maxAbsolute << std::setw(10) << report.meanAbsolute;
+		PrintBudget(out, report.budget.maxAbsolute);
+		out << std::fixed << std::setprecision(1);
+		out << std::setw(10) << report.fastRate * 1e-6 << std::setw(10) << report.referenceRate * 1e-6;
+		out << std::setw(8) << (report.referenceRate > 0.0 ? report.fastRate / report.referenceRate : 0.0) << 'x';
+		out << (report.passed ? "  ok" : "  FAILED");
+
+		if (!report.passed)
+		{
+			out << " worst input";
+
+			for (float value : report.worstInput)
+			{
+				out << ' ' << std::setprecision(9) << std::defaultfloat << value;
+			}
+		}
+
+		out << '\n';
+		out.flags(flags);
+	}
+
+	out.precision(precision);
+}
+
+void ValidationHarness::Clear()
+{
+	this->reports.clear();
+}
+
+bool math3d::ValidateCoreKernels(ValidationHarness& harness)
+{
+	ValidationBudget trigonometry = { DBL_MAX, 2e-6 };
+	ValidationBudget normalize = { 4.0, 1e-6 };
+
+	// Degrees are converted in float first, so the error follows the angle and not the result
+	harness.RunRange("sin (degrees)", -360.0f, 360.0f, [](const float* in, float* out, uint_t count)
+	{
+		for (uint_t i = 0; i < count; i++)
+		{
+			out[i] = math3d::sin(in[i]);
+		}
+	}, [](const float* in, long double* out)
+	{
+		*out = std::sin((long double)*in * VALIDATION_PI / 180.0L);
+	}, trigonometry);
+
+	harness.RunRange("cos (degrees)", -360.0f, 360.0f, [](const float* in, float* out, uint_t count)
+	{
+		for (uint_t i = 0; i < count; i++)
+		{
+			out[i] = math3d::cos(in[i]);
+		}
+	}, [](const float* in, long double* out)
+	{
+		*out = std::cos((long double)*in * VALIDATION_PI / 180.0L);
+	}, trigonometry);
+
+	std::vector<float> inputs;
+
+	harness.GenerateUniform(inputs, 3, harness.GetSampleCount(), -100.0f, 100.0f);
+	harness.Run("Vector3::Normalize", inputs, 3, 3, [](const float* in, float* out, uint_t count)
+	{
+		for (uint_t i = 0; i < count; i++)
+		{
+			Vector3 normalized = Vector3::Normalize(Vector3(in + i * 3));
+
+			out[i * 3] = normalized.GetData()[0];
+			out[i * 3 + 1] = normalized.GetData()[1];
+			out[i * 3 + 2] = normalized.GetData()[2];
+		}
+	}, [](const float* in, long double* out)
+	{
+		long double length = std::sqrt((long double)in[0] * in[0] + (long double)in[1] * in[1] + (long double)in[2] * in[2]);
+
+		for (uint_t k = 0; k < 3; k++)
+		{
+			out[k] = in[k] / length;
+		}
+	}, normalize);
+
+	harness.GenerateUniform(inputs, 4, harness.GetSampleCount(), -10.0f, 10.0f);
+	harness.Run("Quaternion::Normalize", inputs, 4, 4, [](const float* in, float* out, uint_t count)
+	{
+		for (uint_t i = 0; i < count; i++)
+		{
+			Quaternion quat(in[i * 4], in[i * 4 + 1], in[i * 4 + 2], in[i * 4 + 3]);
+
+			quat.Normalize();
+			out[i * 4] = (float)quat.GetW();
+			out[i * 4 + 1] = (float)quat.GetX();
+			out[i * 4 + 2] = (float)quat.GetY();
+			out[i * 4 + 3] = (float)quat.GetZ();
+		}
+	}, [](const float* in, long double* out)
+	{
+		long double length = std::sqrt((long double)in[0] * in[0] + (long double)in[1] * in[1] + (long double)in[2] * in[2] + (long double)in[3] * in[3]);
+
+		for (uint_t k = 0; k < 4; k++)
+		{
+			out[k] = in[k] / length;
+		}
+	}, normalize);
+
+	return harness.Passed();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "math3dhelpers.h"
+#include <cfloat>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace math3d
+{
+	/* Largest error a kernel may show, use DBL_MAX to leave a measure unchecked */
+	struct ValidationBudget
+	{
+		double maxUlp;
+		double maxAbsolute;
+	};
+
+	struct ValidationReport
+	{
+		std::string name;
+		uint_t samples;
+		/* Every float of the input range was evaluated instead of a random sample */
+		bool exhaustive;
+		double maxUlp;
+		double meanUlp;
+		double maxAbsolute;
+		double meanAbsolute;
+		/* Inputs of the sample with the largest ulp error */
+		std::vector<float> worstInput;
+		/* Evaluations per second, best of the repetitions for the fast kernel */
+		double fastRate;
+		double referenceRate;
+		ValidationBudget budget;
+		bool passed;
+	};
+
+	//
+	// Runs fast float kernels side by side with a long double reference and records the error
+	// (ulp of the float nearest the reference, and absolute) next to the throughput of both.
+	// Kernels are batched: fast(inputs, outputs, count) evaluates count samples of inputWidth
+	// floats into outputWidth floats each, reference(input, output) evaluates one sample.
+	// A report fails when either error measure exceeds its budget.
+	//
+	class ValidationHarness
+	{
+	private:
+		uint_t sampleCount;
+		uint_t repetitions;
+		std::mt19937 random;
+		std::vector<ValidationReport> reports;
+
+		const ValidationReport& Record(const char* name, const std::vector<float>& inputs, uint_t inputWidth, const std::vector<float>& outputs,
+			const std::vector<long double>& expected, uint_t outputWidth, double fastSeconds, double referenceSeconds, bool exhaustive, const ValidationBudget& budget);
+
+	public:
+		ValidationHarness(uint_t sampleCount = 1 << 20, uint_t repetitions = 5, unsigned int seed = 1);
+		ValidationHarness(const ValidationHarness& harness) = default;
+		~ValidationHarness() = default;
+
+		/* count samples of width floats, uniform in [minimum, maximum] */
+		void GenerateUniform(std::vector<float>& inputs, uint_t width, uint_t count, float minimum, float maximum);
+		//
+		// Every float in [minimum, maximum] when there are at most sampleCount of them,
+		// otherwise sampleCount uniform samples. Returns true for the exhaustive case.
+		//
+		bool GenerateRange(std::vector<float>& inputs, float minimum, float maximum);
+
+		template <typename Fast, typename Reference>
+		const ValidationReport& Run(const char* name, const std::vector<float>& inputs, uint_t inputWidth, uint_t outputWidth, Fast fast, Reference reference,
+			const ValidationBudget& budget, bool exhaustive = false)
+		{
+			uint_t count = (uint_t)(inputs.size() / inputWidth);
+			std::vector<float> outputs(count * outputWidth);
+			std::vector<long double> expected(count * outputWidth);
+			double fastSeconds = DBL_MAX;
+
+			for (uint_t r = 0; r < this->repetitions; r++)
+			{
+				auto start = std::chrono::steady_clock::now();
+
+				fast(inputs.data(), outputs.data(), count);
+
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				fastSeconds = seconds < fastSeconds ? seconds : fastSeconds;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (uint_t i = 0; i < count; i++)
+			{
+				reference(inputs.data() + i * inputWidth, expected.data() + i * outputWidth);
+			}
+
+			double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			return this->Record(name, inputs, inputWidth, outputs, expected, outputWidth, fastSeconds, referenceSeconds, exhaustive, budget);
+		}
+
+		/* Scalar function over a float range, exhaustive when the range is small enough (see GenerateRange) */
+		template <typename Fast, typename Reference>
+		const ValidationReport& RunRange(const char* name, float minimum, float maximum, Fast fast, Reference reference, const ValidationBudget& budget)
+		{
+			std::vector<float> inputs;
+			bool exhaustive = this->GenerateRange(inputs, minimum, maximum);
+
+			return this->Run(name, inputs, 1, 1, fast, reference, budget, exhaustive);
+		}
+
+		/* True when no recorded report exceeded its budget */
+		bool Passed() const;
+		/* Throws ValidationBudgetExceeded when a report failed */
+		void RequirePassed() const;
+		/* One aligned row per report: errors, budget, throughput of both sides and the speedup */
+		void Print(std::ostream& out) const;
+		void Clear();
+
+		ValidationHarness& operator=(const ValidationHarness& harness) = default;
+
+		inline const std::vector<ValidationReport>& GetReports() const
+		{
+			return this->reports;
+		}
+
+		inline uint_t GetSampleCount() const
+		{
+			return this->sampleCount;
+		}
+	};
+
+	/* Distance between value and reference in units of the float spacing at the reference */
+	double GetUlpError(float value, long double reference);
+
+	//
+	// Library kernels with float fast paths: sin/cos (degrees, exhaustive over [-360, 360] when the
+	// sample count allows), Vector3 and Quaternion normalization. Returns harness.Passed().
+	//
+	bool ValidateCoreKernels(ValidationHarness& harness);
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "math3dinstrumentation.h"
 #include <iostream>
 
 namespace math3d
@@ -6,7 +7,10 @@ namespace math3d
 	class MathException : public std::exception
 	{
 	public:
-		MathException() {}
+		MathException()
+		{
+			MATH3D_INSTRUMENT_EVENT(COUNTER_EXCEPTIONS_THROWN);
+		}
 		virtual const char* what() const noexcept override
 		{
 			return "Math library generic exception";
@@ -72,4 +76,124 @@ namespace math3d
 			return "Invalid vector indexing";
 		}
 	};
+
+	class MeshInvalidIndex : public MathException
+	{
+	public:
+		MeshInvalidIndex() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Invalid mesh vertex index";
+		}
+	};
+
+	class CurveInvalidControlPoints : public MathException
+	{
+	public:
+		CurveInvalidControlPoints() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Invalid curve control point count";
+		}
+	};
+
+	class CurveNoArcLengthTable : public MathException
+	{
+	public:
+		CurveNoArcLengthTable() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Curve arc length table has not been built";
+		}
+	};
+
+	class AnimationInvalidTrack : public MathException
+	{
+	public:
+		AnimationInvalidTrack() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Invalid animation track";
+		}
+	};
+
+	class AnimationPoseMismatch : public MathException
+	{
+	public:
+		AnimationPoseMismatch() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Animation poses have different track layouts";
+		}
+	};
+
+	class ValidationBudgetExceeded : public MathException
+	{
+	public:
+		ValidationBudgetExceeded() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Kernel error exceeds its validation budget";
+		}
+	};
+
+	class FileOpenFailed : public MathException
+	{
+	public:
+		FileOpenFailed() {}
+		virtual const char* what() const noexcept override
+		{
+			return "File could not be opened or mapped";
+		}
+	};
+
+	class PointCloudInvalidFormat : public MathException
+	{
+	public:
+		PointCloudInvalidFormat() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Unsupported or malformed point cloud file";
+		}
+	};
+
+	class PointCloudMissingProperty : public MathException
+	{
+	public:
+		PointCloudMissingProperty() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Point cloud vertex property not found";
+		}
+	};
+
+	class TextInvalidFormat : public MathException
+	{
+	public:
+		TextInvalidFormat() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Malformed numeric text record";
+		}
+	};
+
+	class ConvexHullDegenerate : public MathException
+	{
+	public:
+		ConvexHullDegenerate() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Convex hull needs four non coplanar points";
+		}
+	};
+
+	class StreamInvalidWidth : public MathException
+	{
+	public:
+		StreamInvalidWidth() {}
+		virtual const char* what() const noexcept override
+		{
+			return "Stream element width too small for the stage kernel";
+		}
+	};
 }
@@ -1,7 +1,36 @@
 #pragma once
 #include "vector.h"
 #include "matrix.h"
+#include "matrixchain.h"
+#include "dynamicmatrix.h"
+#include "sparsematrix.h"
 #include "quaternion.h"
+#include "affine.h"
+#include "curve.h"
+#include "animation.h"
 #include "math3dutil.h"
 #include "math3dhelpers.h"
-#include "sdf.h"
\ No newline at end of file
+#include "math3dparallel.h"
+#include "math3dsort.h"
+#include "math3dmorton.h"
+#include "math3dtext.h"
+#include "math3dvalidation.h"
+#include "math3dbenchmark.h"
+#include "math3dpointcloud.h"
+#include "math3dstream.h"
+#include "geometry.h"
+#include "compressed.h"
+#include "sdf.h"
+#include "intersection.h"
+#include "bvh.h"
+#include "spatialhash.h"
+#include "kdtree.h"
+#include "gjk.h"
+#include "sweepandprune.h"
+#include "predicates.h"
+#include "meshnormals.h"
+#include "convexhull.h"
+#include "conjugategradient.h"
+#include "eigen.h"
+#include "svd.h"
+#include "integration.h"
\ No newline at end of file